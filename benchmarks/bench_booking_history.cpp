@@ -0,0 +1,74 @@
+#include <QtTest/QtTest>
+#include "core/BookingHistory.h"
+
+/**
+ * @brief Benchmarks reporting queries on a large booking history
+ */
+class BenchBookingHistory : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {
+        // One million bookings over a month, 50 customers, 12 halls, 40 movies
+        for (int i = 0; i < ROWS; ++i) {
+            m_history.append(i + 1, i % 12 + 1, i % 40 + 1, quint32(i % 50),
+                             {i % 20, (i + 1) % 20}, 2400, i * 2);
+        }
+    }
+
+    /**
+     * @brief Seats sold per movie (occupancy report)
+     */
+    void benchTotalsByMovie() {
+        QMap<qint64, BookingHistory::Totals> totals;
+        QBENCHMARK {
+            totals = m_history.totalsBy(BookingHistory::Dimension::Movie);
+        }
+        QCOMPARE(totals.size(), 40);
+    }
+
+    /**
+     * @brief Revenue per hall for one day
+     */
+    void benchRevenueByTheaterForOneDay() {
+        QMap<qint64, BookingHistory::Totals> totals;
+        QBENCHMARK {
+            totals = m_history.totalsBy(BookingHistory::Dimension::Theater, 0, 86400);
+        }
+        QCOMPARE(totals.size(), 12);
+    }
+
+    /**
+     * @brief Bookings per hour
+     */
+    void benchTotalsByHour() {
+        QMap<qint64, BookingHistory::Totals> totals;
+        QBENCHMARK {
+            totals = m_history.totalsBy(BookingHistory::Dimension::TimeBucket);
+        }
+        QVERIFY(!totals.isEmpty());
+    }
+
+    /**
+     * @brief A booking stored right after a report snapshot
+     *
+     * The snapshot shares every chunk, so the append copies no rows
+     * and costs the same whatever the history size.
+     */
+    void benchAppendAfterSnapshot() {
+        int snapshotRows = 0;
+        QBENCHMARK {
+            const BookingHistory snapshot = m_history;
+            m_history.append(m_history.size() + 1, 1, 1, 0, {0}, 2400, 0);
+            snapshotRows = snapshot.size();
+        }
+        QCOMPARE(m_history.size(), snapshotRows + 1);
+    }
+
+private:
+    static constexpr int ROWS = 1000000;
+    BookingHistory m_history;
+};
+
+QTEST_MAIN(BenchBookingHistory)
+#include "bench_booking_history.moc"
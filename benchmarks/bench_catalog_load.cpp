@@ -0,0 +1,54 @@
+#include <QtTest/QtTest>
+#include <QThreadPool>
+#include "core/BookingService.h"
+
+/**
+ * @brief Benchmarks building and publishing a large catalog
+ */
+class BenchCatalogLoad : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {
+        // 2,000 showings: 100 movies in 20 halls of 250 seats
+        for (int id = 1; id <= 100; ++id) {
+            m_catalog.movies.append({id, QString("Movie %1").arg(id), 120, "Drama"});
+        }
+        for (int id = 1; id <= 20; ++id) {
+            m_catalog.theaters.append({id, QString("Hall %1").arg(id), 250});
+            for (int movie = 1; movie <= 100; ++movie) {
+                m_catalog.showings.append({id, movie});
+            }
+        }
+        m_defaultThreads = QThreadPool::globalInstance()->maxThreadCount();
+    }
+
+    /**
+     * @brief Loads the catalog with seat maps built on one thread
+     */
+    void benchLoadSingleThread() {
+        QThreadPool::globalInstance()->setMaxThreadCount(1);
+        BookingService service;
+        QBENCHMARK {
+            QVERIFY(service.loadCatalog(m_catalog));
+        }
+        QThreadPool::globalInstance()->setMaxThreadCount(m_defaultThreads);
+    }
+
+    /**
+     * @brief Loads the catalog with seat maps built on every core
+     */
+    void benchLoadParallel() {
+        BookingService service;
+        QBENCHMARK {
+            QVERIFY(service.loadCatalog(m_catalog));
+        }
+    }
+
+private:
+    CatalogData m_catalog;
+    int m_defaultThreads = 1;
+};
+
+QTEST_MAIN(BenchCatalogLoad)
+#include "bench_catalog_load.moc"
@@ -0,0 +1,83 @@
+#include <QtTest/QtTest>
+#include "core/CustomerRegistry.h"
+
+/**
+ * @brief Benchmarks customer matching and reports interning memory savings
+ */
+class BenchCustomerInterning : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {
+        // One million bookings spread over 10,000 customers
+        m_names.reserve(BOOKINGS);
+        m_handles.reserve(BOOKINGS);
+        for (int i = 0; i < BOOKINGS; ++i) {
+            QString name = QString("customer-%1@example.com").arg(i % CUSTOMERS);
+            m_handles.append(m_registry.intern(name));
+            m_names.append(name);    // Separately allocated, as before interning
+        }
+    }
+
+    /**
+     * @brief Finds one customer's bookings by string compare
+     */
+    void benchMatchByString() {
+        const QString wanted = "customer-4242@example.com";
+        int matches = 0;
+        QBENCHMARK {
+            matches = 0;
+            for (const QString& name : m_names) {
+                if (name == wanted) {
+                    ++matches;
+                }
+            }
+        }
+        QCOMPARE(matches, BOOKINGS / CUSTOMERS);
+    }
+
+    /**
+     * @brief Finds one customer's bookings by handle compare
+     */
+    void benchMatchByHandle() {
+        const quint32 wanted = m_registry.find("customer-4242@example.com");
+        int matches = 0;
+        QBENCHMARK {
+            matches = 0;
+            for (quint32 handle : m_handles) {
+                if (handle == wanted) {
+                    ++matches;
+                }
+            }
+        }
+        QCOMPARE(matches, BOOKINGS / CUSTOMERS);
+    }
+
+    /**
+     * @brief Prints the memory saved per million bookings
+     */
+    void reportMemorySaved() {
+        qint64 perBookingStrings = 0;
+        for (const QString& name : m_names) {
+            perBookingStrings += qint64(sizeof(QString)) + name.capacity() * qint64(sizeof(QChar));
+        }
+        const qint64 interned = m_registry.memoryUsage()
+                                + BOOKINGS * qint64(sizeof(quint32));
+
+        qDebug().nospace() << "Customer IDs per " << BOOKINGS << " bookings: "
+                           << perBookingStrings << " bytes as strings, "
+                           << interned << " bytes interned, "
+                           << (perBookingStrings - interned) << " bytes saved";
+        QVERIFY(interned < perBookingStrings);
+    }
+
+private:
+    static constexpr int BOOKINGS = 1000000;
+    static constexpr int CUSTOMERS = 10000;
+    CustomerRegistry m_registry;
+    QVector<QString> m_names;
+    QVector<quint32> m_handles;
+};
+
+QTEST_MAIN(BenchCustomerInterning)
+#include "bench_customer_interning.moc"
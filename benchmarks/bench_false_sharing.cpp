@@ -0,0 +1,138 @@
+#include <QtTest/QtTest>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include <functional>
+#include <memory>
+#include "core/BookingService.h"
+
+namespace {
+
+constexpr int SHOWINGS = 8;
+constexpr int COMMITS_PER_THREAD = 200000;
+
+/**
+ * @brief Per-showing hot state as it was laid out before: lock and
+ * counter side by side, neighbouring showings packed together
+ */
+struct PackedShowing {
+    QMutex mutex;
+    quint64 version = 0;
+    QAtomicInt availableCount;
+};
+
+/**
+ * @brief The same state split into cache-line groups, as in ShowingSeats
+ */
+struct alignas(NumaMemory::CACHE_LINE_SIZE) PaddedShowing {
+    alignas(NumaMemory::CACHE_LINE_SIZE) QMutex mutex;
+    quint64 version = 0;
+    alignas(NumaMemory::CACHE_LINE_SIZE) QAtomicInt availableCount;
+};
+
+/**
+ * @brief One writer per showing commits while one reader per showing
+ * polls its free-seat count, the way prechecks do
+ */
+template <typename Showing>
+void hammer(Showing* showings)
+{
+    QAtomicInt stop;
+    std::vector<std::unique_ptr<QThread>> threads;
+
+    for (int i = 0; i < SHOWINGS; ++i) {
+        Showing& showing = showings[i];
+        threads.emplace_back(QThread::create([&showing]() {
+            for (int n = 0; n < COMMITS_PER_THREAD; ++n) {
+                QMutexLocker locker(&showing.mutex);
+                ++showing.version;
+                showing.availableCount.fetchAndAddOrdered(-1);
+            }
+        }));
+        threads.emplace_back(QThread::create([&showing, &stop]() {
+            int sum = 0;
+            while (!stop.loadAcquire()) {
+                sum += showing.availableCount.loadAcquire();
+            }
+            Q_UNUSED(sum);
+        }));
+    }
+
+    for (auto& thread : threads) {
+        thread->start();
+    }
+    // Writers are the even entries
+    for (std::size_t i = 0; i < threads.size(); i += 2) {
+        threads[i]->wait();
+    }
+    stop.storeRelease(1);
+    for (auto& thread : threads) {
+        thread->wait();
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Benchmarks per-showing state under concurrent commits and prechecks
+ */
+class BenchFalseSharing : public QObject {
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief Showings packed into one array, fields side by side
+     */
+    void benchPackedShowings() {
+        PackedShowing showings[SHOWINGS];
+        QBENCHMARK {
+            hammer(showings);
+        }
+    }
+
+    /**
+     * @brief Showings and their hot fields on separate cache lines
+     */
+    void benchPaddedShowings() {
+        PaddedShowing showings[SHOWINGS];
+        QBENCHMARK {
+            hammer(showings);
+        }
+    }
+
+    /**
+     * @brief Reservations through the service, one thread per showing
+     */
+    void benchServiceOneThreadPerShowing() {
+        CatalogData catalog;
+        catalog.movies.append({1, "Movie", 120, "Drama"});
+        for (int id = 1; id <= SHOWINGS; ++id) {
+            catalog.theaters.append({id, QString("Hall %1").arg(id), 2000});
+            catalog.showings.append({id, 1});
+        }
+
+        QBENCHMARK {
+            BookingService service;
+            QVERIFY(service.loadCatalog(catalog));
+
+            std::vector<std::unique_ptr<QThread>> threads;
+            for (int id = 1; id <= SHOWINGS; ++id) {
+                threads.emplace_back(QThread::create([&service, id]() {
+                    for (int seat = 1; seat <= 2000; ++seat) {
+                        service.reserveSeats(id, 1, {QString("A%1").arg(seat)}, "bench");
+                    }
+                }));
+            }
+            for (auto& thread : threads) {
+                thread->start();
+            }
+            for (auto& thread : threads) {
+                thread->wait();
+            }
+        }
+    }
+};
+
+QTEST_MAIN(BenchFalseSharing)
+#include "bench_false_sharing.moc"
@@ -0,0 +1,76 @@
+#include <QtTest/QtTest>
+#include <QtConcurrent/QtConcurrent>
+#include <atomic>
+#include "core/BookingService.h"
+
+/**
+ * @brief Benchmarks single bookings while party bookings run elsewhere
+ *
+ * Compares the cost of single-seat bookings on an idle service with the
+ * same bookings while another thread keeps reserving 60-seat parties
+ * across three halls of other movies. With per-showing locks the
+ * two numbers should stay close.
+ */
+class BenchGroupBooking : public QObject {
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief Single bookings with no other activity
+     */
+    void benchSingleBookingsIdle() {
+        runSingleBookings(false);
+    }
+
+    /**
+     * @brief Single bookings while party bookings hammer other showings
+     */
+    void benchSingleBookingsDuringPartyBookings() {
+        runSingleBookings(true);
+    }
+
+private:
+    /**
+     * @brief Books every seat of movie 1 in all halls, one seat per call
+     * @param withParties Run 60-seat party bookings on movies 2-4 meanwhile
+     */
+    void runSingleBookings(bool withParties) {
+        QBENCHMARK {
+            BookingService service;
+            std::atomic<bool> stop{false};
+
+            QFuture<void> parties;
+            if (withParties) {
+                parties = QtConcurrent::run([&service, &stop]() {
+                    QStringList seatIds;
+                    for (int i = 1; i <= Theater::TOTAL_SEATS; ++i) {
+                        seatIds.append(QString("A%1").arg(i));
+                    }
+                    // Movies 2-4 fill up after one round; later rounds still
+                    // lock and validate all three halls before failing
+                    for (int round = 0; !stop.load(); ++round) {
+                        int movieId = 2 + round % 3;
+                        service.reserveGroup({{1, movieId, seatIds},
+                                              {2, movieId, seatIds},
+                                              {3, movieId, seatIds}}, "Corporate");
+                    }
+                });
+            }
+
+            for (int theaterId = 1; theaterId <= 3; ++theaterId) {
+                for (int i = 1; i <= Theater::TOTAL_SEATS; ++i) {
+                    service.reserveSeats(theaterId, 1, {QString("A%1").arg(i)},
+                                         QString("Customer%1").arg(i));
+                }
+            }
+
+            stop.store(true);
+            if (withParties) {
+                parties.waitForFinished();
+            }
+        }
+    }
+};
+
+QTEST_MAIN(BenchGroupBooking)
+#include "bench_group_booking.moc"
@@ -0,0 +1,87 @@
+#include <QtTest/QtTest>
+#include "core/BookingService.h"
+
+/**
+ * @brief Benchmarks indexed movie queries against a linear scan
+ */
+class BenchMovieSearch : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {
+        // 10,000 titles in 10 genres, 80 to 199 minutes long
+        static const char* genres[] = {"Drama", "Comedy", "Sci-Fi", "Horror", "Action",
+                                       "Romance", "Thriller", "Animation", "Documentary",
+                                       "Fantasy"};
+        CatalogData catalog;
+        for (int id = 1; id <= 10000; ++id) {
+            catalog.movies.append({id, QString("Title %1 Part %2").arg(id * 7919 % 10007).arg(id % 9),
+                                   80 + id % 120, genres[id % 10]});
+        }
+        catalog.theaters.append({1, "Hall 1", 20});
+        catalog.showings.append({1, 1});
+
+        QString error;
+        QVERIFY2(m_service.loadCatalog(catalog, &error), qPrintable(error));
+    }
+
+    /**
+     * @brief Typeahead: up to 10 titles for a short prefix
+     */
+    void benchTitlePrefix() {
+        QBENCHMARK {
+            QCOMPARE(m_service.findMoviesByTitlePrefix("title 42", 10).size(), 10);
+        }
+    }
+
+    /**
+     * @brief The same typeahead as a scan over getMovies()
+     */
+    void benchTitlePrefixScan() {
+        QBENCHMARK {
+            QVector<Movie*> matches;
+            for (Movie* movie : m_service.getMovies()) {
+                if (movie->getTitle().startsWith("title 42", Qt::CaseInsensitive)) {
+                    matches.append(movie);
+                    if (matches.size() == 10) {
+                        break;
+                    }
+                }
+            }
+            QCOMPARE(matches.size(), 10);
+        }
+    }
+
+    /**
+     * @brief All movies of one genre (a tenth of the catalog)
+     */
+    void benchGenre() {
+        QBENCHMARK {
+            QCOMPARE(m_service.findMoviesByGenre("horror").size(), 1000);
+        }
+    }
+
+    /**
+     * @brief Movies between 90 and 95 minutes
+     */
+    void benchDuration() {
+        QBENCHMARK {
+            QVERIFY(!m_service.findMoviesByDuration(90, 95).isEmpty());
+        }
+    }
+
+    /**
+     * @brief Lookup by ID
+     */
+    void benchGetMovie() {
+        QBENCHMARK {
+            QVERIFY(m_service.getMovie(5000));
+        }
+    }
+
+private:
+    BookingService m_service;
+};
+
+QTEST_MAIN(BenchMovieSearch)
+#include "bench_movie_search.moc"
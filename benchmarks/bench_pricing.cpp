@@ -0,0 +1,42 @@
+#include <QtTest/QtTest>
+#include "core/BookingService.h"
+
+/**
+ * @brief Benchmarks pricing a whole seat map for a listing page
+ */
+class BenchPricing : public QObject {
+    Q_OBJECT
+
+private slots:
+    /**
+     * @brief Prices a 400-seat hall straight from the compiled table
+     */
+    void benchPriceAllLargeHall() {
+        PricingEngine pricing = PricingEngine::defaultPricing();
+        QVector<int> prices;
+
+        QBENCHMARK {
+            prices = pricing.priceAll(400, 65, 20);
+        }
+
+        QCOMPARE(prices.size(), 400);
+    }
+
+    /**
+     * @brief Prices a showing through the service, including the catalog lookup
+     */
+    void benchGetSeatPrices() {
+        BookingService service;
+        QVERIFY(service.reserveSeats(1, 1, {"A1", "A2", "A3"}, "Customer"));
+        QVector<int> prices;
+
+        QBENCHMARK {
+            prices = service.getSeatPrices(1, 1);
+        }
+
+        QCOMPARE(prices.size(), Theater::TOTAL_SEATS);
+    }
+};
+
+QTEST_MAIN(BenchPricing)
+#include "bench_pricing.moc"
@@ -0,0 +1,57 @@
+#include <QtTest/QtTest>
+#include "core/RateLimiter.h"
+
+/**
+ * @brief Benchmarks the per-request cost of rate limits and seat quotas
+ */
+class BenchRateLimiter : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {
+        m_customers.reserve(CUSTOMERS);
+        for (int i = 0; i < CUSTOMERS; ++i) {
+            m_customers.append(QString("customer-%1@example.com").arg(i));
+        }
+    }
+
+    /**
+     * @brief Admits requests with every limit off
+     */
+    void benchAdmitLimitsOff() {
+        RateLimiter limiter;
+        runRequests(limiter);
+    }
+
+    /**
+     * @brief Admits requests from many customers, all within their limits
+     */
+    void benchAdmitWithinLimits() {
+        RateLimiter limiter;
+        limiter.setLimits({1000000, 0, 1000000, 0, 1000000});
+        runRequests(limiter);
+    }
+
+private:
+    static constexpr int CUSTOMERS = 10000;
+    static constexpr int REQUESTS = 100000;
+    QVector<QString> m_customers;
+
+    void runRequests(RateLimiter& limiter) {
+        int allowed = 0;
+        QBENCHMARK {
+            allowed = 0;
+            for (int i = 0; i < REQUESTS; ++i) {
+                const RateLimiter::Decision decision =
+                    limiter.admit(m_customers[i % CUSTOMERS], 1 + i % 3, 1 + i % 4, 1);
+                if (decision.status == RateLimiter::Status::Allowed) {
+                    ++allowed;
+                }
+            }
+        }
+        QCOMPARE(allowed, REQUESTS);
+    }
+};
+
+QTEST_MAIN(BenchRateLimiter)
+#include "bench_rate_limiter.moc"
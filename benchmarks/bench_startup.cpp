@@ -0,0 +1,68 @@
+#include <QtTest/QtTest>
+#include <QThreadPool>
+#include "core/BookingService.h"
+
+#include <memory>
+
+/**
+ * @brief Benchmarks cold startup of a large catalog by worker count
+ *
+ * Every row loads 10,000 showings of 400 seats into a fresh service,
+ * so no showing is reused; compare the rows to see how seat map and
+ * seat construction scale with cores.
+ */
+class BenchStartup : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase() {
+        // 10,000 showings: 100 movies in 100 halls of 400 seats
+        for (int id = 1; id <= 100; ++id) {
+            m_catalog.movies.append({id, QString("Movie %1").arg(id), 120, "Drama"});
+            m_catalog.theaters.append({id, QString("Hall %1").arg(id), 400});
+        }
+        for (int theater = 1; theater <= 100; ++theater) {
+            for (int movie = 1; movie <= 100; ++movie) {
+                m_catalog.showings.append({theater, movie});
+            }
+        }
+        m_defaultThreads = QThreadPool::globalInstance()->maxThreadCount();
+    }
+
+    void cleanupTestCase() {
+        QThreadPool::globalInstance()->setMaxThreadCount(m_defaultThreads);
+    }
+
+    void benchStartup_data() {
+        QTest::addColumn<int>("threads");
+        for (int threads = 1; threads < m_defaultThreads; threads *= 2) {
+            QTest::addRow("%d threads", threads) << threads;
+        }
+        QTest::addRow("%d threads", m_defaultThreads) << m_defaultThreads;
+    }
+
+    /**
+     * @brief Builds and publishes every showing with a given pool size
+     */
+    void benchStartup() {
+        QFETCH(int, threads);
+        QThreadPool::globalInstance()->setMaxThreadCount(threads);
+
+        // Only the load is timed, not tearing 4 million seats down again
+        auto service = std::make_unique<BookingService>();
+        QBENCHMARK_ONCE {
+            QVERIFY(service->loadCatalog(m_catalog));
+        }
+        QCOMPARE(service->getCatalogStatus().showingCount, int(m_catalog.showings.size()));
+        service.reset();
+
+        QThreadPool::globalInstance()->setMaxThreadCount(m_defaultThreads);
+    }
+
+private:
+    CatalogData m_catalog;
+    int m_defaultThreads = 1;
+};
+
+QTEST_MAIN(BenchStartup)
+#include "bench_startup.moc"
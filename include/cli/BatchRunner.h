@@ -0,0 +1,127 @@
+#pragma once
+
+#include "core/BookingService.h"
+#include <QByteArray>
+#include <QIODevice>
+
+/**
+ * @brief Runs scripted commands against the booking service
+ *
+ * Reads one command per line, either as words or as a JSON object
+ * (NDJSON); the two forms may be mixed. Blank lines and lines starting
+ * with '#' are skipped.
+ * @code
+ * movies
+ * theaters 1
+ * seats 1 1
+ * reserve 1 1 A1,A2 Jane Doe
+ * bookings Jane Doe
+ * waitlist 1 1 4 John Roe
+ * cancel 1
+ * load catalog.json
+ * {"command": "reserve", "theaterId": 1, "movieId": 1, "seats": ["A3"],
+ *  "customer": "Jane Doe", "key": "order-17"}
+ * {"command": "cancel", "bookingId": 1}
+ * @endcode
+ * Each command produces one JSON line carrying the input line number,
+ * "ok", and either the command's data or "code" and "error". A waitlist
+ * party booked by a command (a cancellation, or a waitlist entry that
+ * fits at once) is announced by an extra line after the command's
+ * result: {"event":"waitlistPromoted","waitlistId":...,"bookingId":...,
+ * "customer":...}. Output is
+ * buffered and written in large chunks, so long scripts are bound by
+ * the service rather than the terminal.
+ */
+class BatchRunner {
+public:
+    /**
+     * @brief Totals of one run
+     */
+    struct Summary {
+        int commands = 0;           ///< Commands executed (skipped lines not counted)
+        int failed = 0;             ///< Commands that did not succeed
+    };
+
+    /**
+     * @brief Constructs a runner
+     * @param service Service the commands run against
+     */
+    explicit BatchRunner(BookingService& service);
+
+    /**
+     * @brief Stops listening for waitlist promotions
+     */
+    ~BatchRunner();
+
+    // Prevent copying (holds a signal connection)
+    BatchRunner(const BatchRunner&) = delete;
+    BatchRunner& operator=(const BatchRunner&) = delete;
+
+    /**
+     * @brief Runs every command from input until it ends
+     * @param input Readable command stream
+     * @param output Receives one result line per command
+     * @return Totals
+     */
+    Summary run(QIODevice& input, QIODevice& output);
+
+private:
+    /// Output is handed to the device once this much has accumulated
+    static constexpr int OUTPUT_CHUNK_SIZE = 64 * 1024;
+
+    /**
+     * @brief One parsed command, from either input form
+     */
+    struct Command {
+        QString name;               ///< movies, theaters, seats, reserve, bookings, waitlist, cancel or load
+        int theaterId = 0;          ///< Showing hall
+        int movieId = 0;            ///< Showing movie
+        QStringList seatIds;        ///< Seats to reserve
+        int seatCount = 0;          ///< Party size for waitlist
+        int bookingId = 0;          ///< Booking to cancel
+        QString customer;           ///< Customer name
+        QString idempotencyKey;     ///< Optional reserve key (JSON only)
+        QString path;               ///< Catalog file for load
+    };
+
+    BookingService& m_service;      ///< Service the commands run against
+    QByteArray m_output;            ///< Results not yet written
+    QByteArray m_events;            ///< Event lines of the running command
+    QMetaObject::Connection m_promotions; ///< Feeds m_events from waitlistPromoted()
+
+    /**
+     * @brief Parses a words line
+     * @param line Line without the newline
+     * @param command Receives the command
+     * @param error Receives the reason if the line is malformed
+     * @return true if the line is a well-formed command
+     */
+    static bool parseWords(const QString& line, Command& command, QString& error);
+
+    /**
+     * @brief Parses a JSON object line
+     * @param line Line without the newline
+     * @param command Receives the command
+     * @param error Receives the reason if the line is malformed
+     * @return true if the line is a well-formed command
+     */
+    static bool parseJson(const QByteArray& line, Command& command, QString& error);
+
+    /**
+     * @brief Runs one command and appends its result line
+     * @param command Command to run
+     * @param lineNumber Input line, echoed in the result
+     * @return true if the command succeeded
+     */
+    bool execute(const Command& command, int lineNumber);
+
+    /**
+     * @brief Appends a failure result line
+     * @param lineNumber Input line
+     * @param command Command name, may be empty
+     * @param code Failure code
+     * @param error Failure text
+     */
+    void appendFailure(int lineNumber, const QString& command, const char* code,
+                       const QString& error);
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QtGlobal>
+
+/**
+ * @brief Virtual waiting room for a single showing
+ *
+ * Callers draw a numbered token and are admitted strictly in token
+ * order, at most maxActive() at a time. The queue is bounded: once
+ * capacity() callers are waiting, new callers are turned away instead
+ * of piling up. When the showing sells out, queued and new callers are
+ * rejected immediately; the sold-out check is a single atomic load.
+ *
+ * @note Thread-safe. Never hold another lock of the booking service
+ * while waiting in the queue.
+ */
+class AdmissionQueue {
+public:
+    /// Default number of callers admitted to a showing at once
+    static constexpr int DEFAULT_MAX_ACTIVE = 1;
+
+    /// Default number of callers allowed to wait for a showing
+    static constexpr int DEFAULT_CAPACITY = 1024;
+
+    /**
+     * @brief Outcome of an admission attempt
+     */
+    enum class Status {
+        Admitted,   ///< Caller may proceed and must call leave() afterwards
+        QueueFull,  ///< Waiting room is full; try again later
+        SoldOut     ///< Showing is sold out; no point in waiting
+    };
+
+    /**
+     * @brief Snapshot of the waiting room as seen by a new caller
+     */
+    struct Position {
+        Status status;              ///< What a caller arriving now would get
+        int ahead;                  ///< Callers waiting or being served ahead
+        qint64 estimatedWaitMs;     ///< Estimated wait before admission
+    };
+
+    /**
+     * @brief Constructs an empty waiting room
+     * @param maxActive Maximum callers admitted at once
+     * @param capacity Maximum callers waiting at once
+     */
+    explicit AdmissionQueue(int maxActive = DEFAULT_MAX_ACTIVE,
+                            int capacity = DEFAULT_CAPACITY);
+
+    /**
+     * @brief Waits for this caller's turn
+     *
+     * Blocks until every caller that arrived earlier has been admitted
+     * and a slot is free, or until the showing sells out.
+     *
+     * @param position Receives the caller's position on arrival
+     * @return Admitted, or why the caller was turned away
+     */
+    Status enter(Position& position);
+
+    /**
+     * @brief Frees the slot taken by a successful enter()
+     * @param serviceTimeUs Time the caller spent while admitted, in microseconds
+     */
+    void leave(qint64 serviceTimeUs);
+
+    /**
+     * @brief Reports what a caller arriving now would face
+     * @return Current position and estimated wait
+     */
+    Position position() const;
+
+    /**
+     * @brief Marks the showing sold out (or available again)
+     *
+     * Setting sold out wakes every waiting caller so it can give up.
+     *
+     * @param soldOut New sold-out state
+     */
+    void setSoldOut(bool soldOut);
+
+    /**
+     * @brief Checks the sold-out flag without locking
+     * @return true if the showing is sold out
+     */
+    bool isSoldOut() const { return m_soldOut.loadAcquire() != 0; }
+
+    /**
+     * @brief Changes how many callers are admitted at once
+     * @param maxActive New limit (at least 1)
+     */
+    void setMaxActive(int maxActive);
+
+    /**
+     * @brief Gets how many callers are admitted at once
+     * @return Admission limit
+     */
+    int maxActive() const;
+
+    /**
+     * @brief Gets the waiting room capacity
+     * @return Maximum callers waiting at once
+     */
+    int capacity() const { return m_capacity; }
+
+private:
+    /**
+     * @brief Estimates the wait for a caller with the given callers ahead
+     * @note Caller must hold m_mutex
+     */
+    qint64 estimateWaitMs(int ahead) const;
+
+    mutable QMutex m_mutex;     ///< Guards all members except m_soldOut
+    QWaitCondition m_turn;      ///< Signalled whenever the head may advance
+    QAtomicInt m_soldOut;       ///< Lock-free sold-out flag
+    int m_maxActive;            ///< Callers admitted at once
+    const int m_capacity;       ///< Maximum callers waiting
+    quint64 m_nextToken;        ///< Token handed to the next arrival
+    quint64 m_nextAdmit;        ///< Lowest token not yet admitted
+    int m_active;               ///< Callers currently admitted
+    qint64 m_avgServiceUs;      ///< Moving average of admitted service time (µs)
+};
@@ -0,0 +1,206 @@
+#pragma once
+
+#include "core/CustomerRegistry.h"
+
+#include <QMap>
+#include <QSharedData>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+#include <limits>
+
+/**
+ * @brief Append-only columnar store of committed bookings for reporting
+ *
+ * Each booking attribute lives in its own contiguous column. Customers
+ * are stored as CustomerRegistry handles and resolved through the
+ * registry, seats as numeric indices in a single flat column and times
+ * as epoch seconds. Aggregate queries scan
+ * only the columns they need in tight loops over plain integers.
+ *
+ * Columns are stored in fixed-size chunks that copies share, each copy
+ * keeping its own row count. Taking a snapshot copies one pointer per
+ * chunk; the owner then keeps appending into its tail chunk in place
+ * (rows are never moved, and a snapshot reads none past its count),
+ * and cancelling a row copies only that row's chunk while it is
+ * shared. A snapshot can be queried without holding the owner's lock.
+ *
+ * Cancelled bookings keep their row but are flagged and left out of
+ * every aggregate.
+ *
+ * @note Not thread-safe; the owning BookingService guards access.
+ */
+class BookingHistory {
+public:
+    /**
+     * @brief Creates an empty history
+     * @param customers Registry the stored customer handles belong to; must
+     *        outlive the history and every copy of it
+     */
+    explicit BookingHistory(const CustomerRegistry* customers = nullptr)
+        : m_customers(customers) {}
+
+    /**
+     * @brief Takes a snapshot sharing every chunk
+     *
+     * The copy does not own the tail chunk: appending to it copies
+     * that chunk first, so the original can keep filling it.
+     */
+    BookingHistory(const BookingHistory& other);
+    BookingHistory& operator=(const BookingHistory& other);
+    BookingHistory(BookingHistory&&) = default;
+    BookingHistory& operator=(BookingHistory&&) = default;
+
+    /**
+     * @brief Attribute to group aggregates by
+     */
+    enum class Dimension {
+        Movie,      ///< Key is the movie ID
+        Theater,    ///< Key is the theater ID
+        TimeBucket, ///< Key is the bucket start in epoch seconds
+        Customer    ///< Key is the customer handle, see customerName()
+    };
+
+    /**
+     * @brief Aggregated figures for one group
+     */
+    struct Totals {
+        int bookings = 0;           ///< Number of bookings
+        qint64 seats = 0;           ///< Number of seats sold
+        qint64 revenue = 0;         ///< Revenue in cents
+    };
+
+    /**
+     * @brief Appends a committed booking
+     * @param bookingId Booking ID
+     * @param theaterId Theater ID
+     * @param movieId Movie ID
+     * @param customerHandle Customer handle from the history's registry
+     * @param seatIndices Zero-based seat indices
+     * @param totalPrice Price of all seats in cents
+     * @param bookedAt Booking time in epoch seconds
+     */
+    void append(int bookingId, int theaterId, int movieId, quint32 customerHandle,
+                const QVector<int>& seatIndices, int totalPrice, qint64 bookedAt);
+
+    /**
+     * @brief Gets the number of bookings stored
+     * @return Row count
+     */
+    int size() const { return m_bookingIds.size(); }
+
+    /**
+     * @brief Flags a stored booking as cancelled
+     * @param row Row index (0 <= row < size())
+     */
+    void cancel(int row) { m_cancelled.set(row, 1); }
+
+    /**
+     * @brief Tells whether a stored booking was cancelled
+     * @param row Row index (0 <= row < size())
+     * @return true if cancel() was called for the row
+     */
+    bool isCancelled(int row) const { return m_cancelled[row] != 0; }
+
+    /**
+     * @brief Aggregates live bookings in a time range by one dimension
+     * @param dimension Attribute to group by
+     * @param from First epoch second included
+     * @param to First epoch second excluded
+     * @param bucketSeconds Bucket width for Dimension::TimeBucket
+     * @return Totals per group key, ascending
+     */
+    QMap<qint64, Totals> totalsBy(Dimension dimension,
+                                  qint64 from = 0,
+                                  qint64 to = std::numeric_limits<qint64>::max(),
+                                  qint64 bucketSeconds = 3600) const;
+
+    /**
+     * @brief Resolves a Dimension::Customer key through the registry
+     * @param customerKey Key returned by totalsBy()
+     * @return Customer identifier, empty without a registry
+     */
+    QString customerName(qint64 customerKey) const
+    {
+        return m_customers ? m_customers->name(quint32(customerKey)) : QString();
+    }
+
+    /**
+     * @brief Gets the seats of one stored booking
+     * @param row Row index (0 <= row < size())
+     * @return Zero-based seat indices
+     */
+    QVector<int> seatIndices(int row) const;
+
+private:
+    /// Rows (or seat entries) per column chunk
+    static constexpr int CHUNK_ROWS = 4096;
+
+    /**
+     * @brief Append-only column stored in fixed-size, shared chunks
+     */
+    template <typename T>
+    class Column {
+    public:
+        int size() const { return m_size; }
+
+        const T& operator[](int i) const
+        {
+            return m_chunks[i / CHUNK_ROWS]->values[i % CHUNK_ROWS];
+        }
+
+        /**
+         * @brief Gets the values of one chunk
+         * @param chunk Chunk index; its first value is row chunk * CHUNK_ROWS
+         */
+        const T* chunk(int chunk) const { return m_chunks[chunk]->values; }
+
+        /**
+         * @brief Appends a value
+         * @param value Value of the new row
+         * @param ownsTail false if the tail chunk may be shared with the history it was copied from
+         */
+        void append(T value, bool ownsTail)
+        {
+            const int offset = m_size % CHUNK_ROWS;
+            if (offset == 0) {
+                m_chunks.append(QExplicitlySharedDataPointer<Chunk>(new Chunk));
+            } else if (!ownsTail) {
+                m_chunks.last().detach();
+            }
+            m_chunks.last()->values[offset] = value;
+            ++m_size;
+        }
+
+        /**
+         * @brief Changes a stored value, copying its chunk first if shared
+         */
+        void set(int i, T value)
+        {
+            QExplicitlySharedDataPointer<Chunk>& chunk = m_chunks[i / CHUNK_ROWS];
+            chunk.detach();
+            chunk->values[i % CHUNK_ROWS] = value;
+        }
+
+    private:
+        struct Chunk : QSharedData {
+            T values[CHUNK_ROWS] = {};
+        };
+
+        QVector<QExplicitlySharedDataPointer<Chunk>> m_chunks;
+        int m_size = 0;
+    };
+
+    Column<qint32> m_bookingIds;        ///< Booking ID per row
+    Column<qint32> m_theaterIds;        ///< Theater ID per row
+    Column<qint32> m_movieIds;          ///< Movie ID per row
+    Column<quint32> m_customerHandles;  ///< Customer handle per row
+    Column<qint32> m_seatCounts;        ///< Seats per row
+    Column<qint32> m_totalPrices;       ///< Revenue per row in cents
+    Column<qint64> m_bookedAt;          ///< Epoch seconds per row
+    Column<quint8> m_cancelled;         ///< 1 for cancelled rows
+    Column<qint32> m_seatOffsets;       ///< Start of each row in m_seatIndices
+    Column<quint16> m_seatIndices;      ///< Seat indices of all rows, concatenated
+    const CustomerRegistry* m_customers; ///< Resolves customer handles (not owned)
+    bool m_ownsTail = true;             ///< false for a copy until it appends
+};
@@ -4,14 +4,33 @@
 #include "models/Theater.h"
 #include "models/Seat.h"
 #include "models/Booking.h"
+#include "core/SeatChangeLog.h"
+#include "core/AdmissionQueue.h"
+#include "core/SeatMap.h"
+#include "core/PricingEngine.h"
+#include "core/ReservationResult.h"
+#include "core/BookingHistory.h"
+#include "core/CustomerRegistry.h"
+#include "core/SharedInventory.h"
+#include "core/ReplicationStream.h"
+#include "core/IdempotencyTable.h"
+#include "core/RateLimiter.h"
+#include "core/CatalogLoader.h"
+#include "core/NumaMemory.h"
+#include "core/SeatChartTemplate.h"
 
 #include <QObject>
 #include <QVector>
 #include <QMap>
+#include <QAtomicInteger>
+#include <QSharedPointer>
 #include <QMutex>
 #include <QReadWriteLock>
 #include <QThread>
 #include <QDateTime>
+#include <functional>
+#include <memory>
+#include <utility>
 
 /**
  * @brief Thread-safe booking service for cinema reservations
@@ -32,6 +51,8 @@
 class BookingService : public QObject {
     Q_OBJECT
 
+    struct Catalog;
+
 public:
     /**
      * @brief Simple booking data structure (non-QObject)
@@ -41,13 +62,184 @@ public:
      */
     struct BookingData {
         int id;                     ///< Booking ID
-        QString customerId;         ///< Customer identifier
+        QString customerId;         ///< Customer identifier (shares the interned string)
+        quint32 customerHandle;     ///< Interned customer handle
         int movieId;                ///< Movie ID
         int theaterId;              ///< Theater ID
+        quint64 showingLineage = 0; ///< Lineage of the showing the seats were taken in
         QStringList seatIds;        ///< Seat IDs
+        QVector<int> seatPrices;    ///< Price per seat in cents, fixed at booking time
+        int totalPrice;             ///< Sum of seatPrices in cents
         QDateTime bookingTime;      ///< Booking timestamp
+        bool cancelled = false;     ///< Set by cancelBooking(); the record is kept
+        RateLimiter::QuotaHold quotaHold; ///< Seats counted against the customer's quota
+    };
+
+    /**
+     * @brief A party waiting for seats in a showing, see joinWaitlist()
+     */
+    struct WaitlistEntry {
+        int id;                     ///< Waitlist ID, unique per service
+        QString customerId;         ///< Customer identifier
+        int seatCount;              ///< Seats wanted, all in this showing
+        QDateTime joinedAt;         ///< When the entry was queued
+        RateLimiter::QuotaHold quotaHold; ///< Seats counted against the customer's quota
+    };
+
+    /**
+     * @brief State of a single seat as reported by a seat map delta
+     */
+    struct SeatChange {
+        int seatIndex;              ///< Zero-based seat index within the showing
+        bool available;             ///< Seat availability at the reported version
+    };
+
+    /**
+     * @brief Incremental seat map update for a showing
+     *
+     * Returned by getSeatChangesSince(). When the client is too far
+     * behind the bounded change log, @c isFullSnapshot is set and
+     * @c changes lists every seat of the showing.
+     */
+    struct SeatChangeSet {
+        quint64 version;            ///< Showing version the changes bring the client to
+        bool isFullSnapshot;        ///< true if changes holds every seat
+        QVector<SeatChange> changes; ///< Changed seats, ascending by index
+    };
+
+    /**
+     * @brief A booking joined with the catalog, as returned by getBookingDetails()
+     */
+    struct BookingDetails {
+        int id;                     ///< Booking ID
+        int movieId;                ///< Movie ID
+        QString movieTitle;         ///< Movie title, empty if no longer in the catalog
+        int theaterId;              ///< Theater ID
+        QString theaterName;        ///< Hall name, empty if no longer in the catalog
+        QStringList seatIds;        ///< Seat labels
+        QVector<int> seatPrices;    ///< Price per seat in cents
+        int totalPrice;             ///< Sum of seatPrices in cents
+        QDateTime bookingTime;      ///< Booking timestamp
+    };
+
+    /**
+     * @brief Seats requested in one showing as part of a group booking
+     */
+    struct ShowingRequest {
+        int theaterId;              ///< Theater identifier
+        int movieId;                ///< Movie identifier
+        QStringList seatIds;        ///< Seat IDs to reserve in this showing
+    };
+
+    /**
+     * @brief Replication role of a service instance
+     */
+    enum class ReplicationRole {
+        Primary,                    ///< Accepts reservations (default)
+        Replica                     ///< Read-only copy fed by a primary
+    };
+
+    /**
+     * @brief Replication state as returned by getReplicationStatus()
+     */
+    struct ReplicationStatus {
+        ReplicationRole role;       ///< Current role
+        quint64 appliedSequence;    ///< Bookings and cancellations in the local log
+        quint64 primarySequence;    ///< Primary log head (as last heard, on a replica)
+        qint64 lagMs;               ///< Commit-to-apply delay of the last replicated booking
+        bool connected;             ///< Replica: stream to the primary is open
+        int replicaCount;           ///< Primary: connected replicas
+    };
+
+    /**
+     * @brief Catalog version state as returned by getCatalogStatus()
+     */
+    struct CatalogStatus {
+        quint64 version;            ///< Published catalog version (1 = first load)
+        int liveVersions;           ///< Versions still referenced, including the current one
+        int showingCount;           ///< Showings in the current version
+    };
+
+    /**
+     * @brief Rendered seat chart as returned by getSeatChart()
+     */
+    struct SeatChart {
+        quint64 version;            ///< Showing version the chart reflects
+        int freeCount;              ///< Free seats at that version
+        QByteArray data;            ///< Ready-to-send chart, empty if the showing does not exist
+    };
+
+    /**
+     * @brief One page of a paged listing
+     * 
+     * Pass nextCursor back to get the following page; start with 0.
+     */
+    template <typename T>
+    struct Page {
+        QVector<T> items;           ///< At most the requested number of items
+        int nextCursor = -1;        ///< Cursor of the next page, -1 after the last
+        QSharedPointer<const Catalog> pin; ///< Keeps pointer items valid (see PinnedList), null otherwise
+    };
+
+    /**
+     * @brief Catalog object pointers that stay valid while the list is held
+     * 
+     * Holds the catalog version the pointers were read from, so a
+     * concurrent reload cannot free the movies, theaters or seats (of a
+     * dropped showing) while the caller still uses them. Copies share
+     * the pin. Do not keep the pointers past the last copy, nor past the
+     * service.
+     */
+    template <typename T>
+    class PinnedList {
+    public:
+        PinnedList() = default;
+        PinnedList(QVector<T*> items, QSharedPointer<const Catalog> pin)
+            : m_items(std::move(items)), m_pin(std::move(pin)) {}
+
+        const QVector<T*>& items() const { return m_items; }
+        int size() const { return int(m_items.size()); }
+        bool isEmpty() const { return m_items.isEmpty(); }
+        T* operator[](int i) const { return m_items[i]; }
+        T* first() const { return m_items.first(); }
+        T* last() const { return m_items.last(); }
+        typename QVector<T*>::const_iterator begin() const { return m_items.cbegin(); }
+        typename QVector<T*>::const_iterator end() const { return m_items.cend(); }
+
+    private:
+        QVector<T*> m_items;
+        QSharedPointer<const Catalog> m_pin;
+    };
+
+    /**
+     * @brief One catalog object pointer, valid while the reference is held
+     * 
+     * Pins its catalog version like PinnedList; null if nothing was found.
+     */
+    template <typename T>
+    class PinnedRef {
+    public:
+        PinnedRef() = default;
+        PinnedRef(T* object, QSharedPointer<const Catalog> pin)
+            : m_object(object)
+            , m_pin(object ? std::move(pin) : QSharedPointer<const Catalog>()) {}
+
+        T* get() const { return m_object; }
+        T* operator->() const { return m_object; }
+        T& operator*() const { return *m_object; }
+        explicit operator bool() const { return m_object != nullptr; }
+
+    private:
+        T* m_object = nullptr;
+        QSharedPointer<const Catalog> m_pin;
     };
 
+    /// Streaming visitors return false to stop early; a pointer is valid during its call only
+    using MovieVisitor = std::function<bool(Movie*)>;
+    using TheaterVisitor = std::function<bool(Theater*)>;
+    using SeatVisitor = std::function<bool(Seat*)>;
+    using BookingVisitor = std::function<bool(const BookingData&)>;
+
     /**
      * @brief Constructs the booking service and initializes sample data
      * @param parent Parent QObject for memory management
@@ -65,24 +257,172 @@ public:
     
     /**
      * @brief Gets all available movies (thread-safe)
-     * @return Vector of movie pointers (caller must not delete)
+     * @return Movie pointers (caller must not delete), valid while the list is held
      */
-    QVector<Movie*> getMovies() const;
+    PinnedList<Movie> getMovies() const;
     
     /**
      * @brief Gets theaters showing a specific movie (thread-safe)
      * @param movieId Movie identifier
-     * @return Vector of theater pointers (caller must not delete)
+     * @return Theater pointers (caller must not delete), valid while the list is held
      */
-    QVector<Theater*> getTheaters(int movieId) const;
+    PinnedList<Theater> getTheaters(int movieId) const;
     
     /**
      * @brief Gets available seats for a movie in a theater (thread-safe)
      * @param theaterId Theater identifier
      * @param movieId Movie identifier
-     * @return Vector of available seat pointers (caller must not delete)
+     * @return Available seat pointers (caller must not delete), valid while the list
+     *         is held, even if a reload drops the showing meanwhile
      */
-    QVector<Seat*> getAvailableSeats(int theaterId, int movieId) const;
+    PinnedList<Seat> getAvailableSeats(int theaterId, int movieId) const;
+    
+    /**
+     * @brief Gets one page of movies, in catalog order (thread-safe)
+     * 
+     * The cursor is a catalog position; a page read after a catalog
+     * reload continues in the new catalog.
+     * 
+     * @param cursor 0 for the first page, else the previous nextCursor
+     * @param limit Maximum movies per page
+     * @return Page of movie pointers (caller must not delete), valid while the page is held
+     */
+    Page<Movie*> getMoviesPage(int cursor, int limit) const;
+    
+    /**
+     * @brief Gets one page of the theaters showing a movie (thread-safe)
+     * @param movieId Movie identifier
+     * @param cursor 0 for the first page, else the previous nextCursor
+     * @param limit Maximum theaters per page
+     * @return Page of theater pointers (caller must not delete), valid while the page is held
+     */
+    Page<Theater*> getTheatersPage(int movieId, int cursor, int limit) const;
+    
+    /**
+     * @brief Gets one page of available seats (thread-safe)
+     * 
+     * The cursor is a seat index, so seats taken between pages never
+     * shift later pages.
+     * 
+     * @param theaterId Theater identifier
+     * @param movieId Movie identifier
+     * @param cursor 0 for the first page, else the previous nextCursor
+     * @param limit Maximum seats per page
+     * @return Page of available seat pointers (caller must not delete), valid while the
+     *         page is held
+     */
+    Page<Seat*> getAvailableSeatsPage(int theaterId, int movieId, int cursor, int limit) const;
+    
+    /**
+     * @brief Visits every movie of one catalog version (thread-safe)
+     * @param visitor Called per movie; may call back into the service
+     * @return Number of movies visited
+     */
+    int forEachMovie(const MovieVisitor& visitor) const;
+    
+    /**
+     * @brief Visits the theaters showing a movie, from one catalog version (thread-safe)
+     * @param movieId Movie identifier
+     * @param visitor Called per theater; may call back into the service
+     * @return Number of theaters visited
+     */
+    int forEachTheater(int movieId, const TheaterVisitor& visitor) const;
+    
+    /**
+     * @brief Visits the available seats of a showing (thread-safe)
+     * 
+     * Seats are read in fixed-size chunks into a stack buffer, so no
+     * list is built. The showing is locked only while a chunk is read;
+     * the visitor runs unlocked and may call back into the service.
+     * 
+     * @param theaterId Theater identifier
+     * @param movieId Movie identifier
+     * @param visitor Called per seat, ascending by index
+     * @return Number of seats visited
+     */
+    int forEachAvailableSeat(int theaterId, int movieId, const SeatVisitor& visitor) const;
+    
+    /**
+     * @brief Finds a movie by ID in O(1) (thread-safe)
+     * @param movieId Movie identifier
+     * @return Movie pointer (caller must not delete), valid while the reference is
+     *         held; null if unknown
+     */
+    PinnedRef<Movie> getMovie(int movieId) const;
+    
+    /**
+     * @brief Finds the movies of a genre (thread-safe)
+     * @param genre Genre, compared case-insensitively
+     * @return Movie pointers in catalog order (caller must not delete), valid while
+     *         the list is held
+     */
+    PinnedList<Movie> findMoviesByGenre(const QString& genre) const;
+    
+    /**
+     * @brief Finds the movies whose title starts with a prefix (thread-safe)
+     * 
+     * A binary search in the title index plus one step per match, so it
+     * suits typeahead on large catalogs.
+     * 
+     * @param prefix Title prefix, compared case-insensitively; empty matches all
+     * @param limit Maximum movies, -1 for all
+     * @return Movie pointers in title order (caller must not delete), valid while
+     *         the list is held
+     */
+    PinnedList<Movie> findMoviesByTitlePrefix(const QString& prefix, int limit = -1) const;
+    
+    /**
+     * @brief Finds the movies within a duration range (thread-safe)
+     * @param minMinutes Shortest duration, inclusive
+     * @param maxMinutes Longest duration, inclusive
+     * @return Movie pointers, shortest first (caller must not delete), valid while
+     *         the list is held
+     */
+    PinnedList<Movie> findMoviesByDuration(int minMinutes, int maxMinutes) const;
+    
+    /**
+     * @brief Gets a showing's seat chart, ready to send (thread-safe)
+     * 
+     * Each showing caches its rendered charts. A request copies nothing
+     * if the showing has not changed (the returned buffer is shared);
+     * otherwise only the cells of seats changed since the cached version
+     * are patched, falling back to the hall layout's blank chart when
+     * the change log does not reach back far enough. With a shared
+     * inventory attached the chart is patched from the blank one on
+     * every call, since other processes' bookings are not logged here.
+     * 
+     * @param theaterId Theater identifier
+     * @param movieId Movie identifier
+     * @param format Text or JSON (see SeatChartTemplate)
+     * @return Chart and the version it reflects
+     */
+    SeatChart getSeatChart(int theaterId, int movieId, SeatChartTemplate::Format format) const;
+    
+    /**
+     * @brief Gets the current seat map version of a showing (thread-safe)
+     * 
+     * The version starts at 0 and increases every time seats of the
+     * showing change.
+     * 
+     * @param theaterId Theater identifier
+     * @param movieId Movie identifier
+     * @return Current version, or 0 if the showing does not exist
+     */
+    quint64 getSeatMapVersion(int theaterId, int movieId) const;
+    
+    /**
+     * @brief Gets the seats that changed since a known version (thread-safe)
+     * 
+     * Lets clients refresh a seat map incrementally. If @p version is
+     * older than the showing's change log reaches back (or newer than
+     * the current version), a full snapshot is returned instead.
+     * 
+     * @param theaterId Theater identifier
+     * @param movieId Movie identifier
+     * @param version Seat map version the client already has
+     * @return Changed seats and the version they bring the client to
+     */
+    SeatChangeSet getSeatChangesSince(int theaterId, int movieId, quint64 version) const;
     
     /**
      * @brief Reserves seats atomically (thread-safe)
@@ -90,15 +430,187 @@ public:
      * This method ensures that multiple concurrent requests cannot
      * reserve the same seats, preventing overbooking.
      * 
+     * Callers pass through the showing's waiting room and are served
+     * in arrival order. Requests for a sold-out showing (or for more
+     * seats than are left) fail immediately without waiting or locking
+     * the showing.
+     * 
      * @param theaterId Theater identifier
      * @param movieId Movie identifier
      * @param seatIds List of seat IDs to reserve
      * @param customerName Customer name/identifier
-     * @return true if reservation successful, false otherwise
+     * @return Outcome; converts to true if the seats were reserved
      */
-    bool reserveSeats(int theaterId, int movieId,
-                     const QStringList& seatIds,
-                     const QString& customerName);
+    ReservationResult reserveSeats(int theaterId, int movieId,
+                                   const QStringList& seatIds,
+                                   const QString& customerName);
+    
+    /**
+     * @brief Reserves seats at most once per idempotency key (thread-safe)
+     * 
+     * A retry carrying the key of a request that already succeeded
+     * returns true without reserving anything again (and without
+     * emitting signals); the original booking is reported through
+     * bookingId. If that booking has been cancelled since, the retry
+     * fails with BookingCancelled instead, so the client does not
+     * believe it still holds the seats. The key is checked before any
+     * showing lock is taken. Failed requests do not consume their key.
+     * Reusing a key for different seats, showing or customer fails.
+     * 
+     * @param theaterId Theater identifier
+     * @param movieId Movie identifier
+     * @param seatIds List of seat IDs to reserve
+     * @param customerName Customer name/identifier
+     * @param idempotencyKey Client-chosen request key; empty disables deduplication
+     * @param bookingId Receives the booking ID on success (the cancelled one
+     *        for BookingCancelled), may be nullptr
+     * @return Outcome; Ok if reserved now or by an earlier request with this key
+     */
+    ReservationResult reserveSeats(int theaterId, int movieId,
+                                   const QStringList& seatIds,
+                                   const QString& customerName,
+                                   const QString& idempotencyKey,
+                                   int* bookingId = nullptr);
+    
+    /**
+     * @brief Reserves seats across several showings all-or-nothing (thread-safe)
+     * 
+     * Intended for party bookings that span halls. The involved showings
+     * are locked in ascending (theaterId, movieId) order so concurrent
+     * group bookings cannot deadlock. A prepare phase validates every
+     * seat of every showing; only if all of them are available does the
+     * commit phase reserve them, creating one booking per showing.
+     * Unrelated showings stay bookable throughout.
+     * 
+     * Requests naming the same showing more than once are merged.
+     * 
+     * @param requests Seats to reserve, grouped by showing
+     * @param customerName Customer name/identifier
+     * @return Outcome (bookingId is the first booking); on failure it
+     *         names the showing that could not be served
+     */
+    ReservationResult reserveGroup(const QVector<ShowingRequest>& requests,
+                                   const QString& customerName);
+    
+    /**
+     * @brief Cancels a booking and gives its seats back (thread-safe)
+     * 
+     * The seats are offered to the showing's waitlist in the same
+     * critical section, so a waiting party is booked before any other
+     * caller can take them. The booking's record stays in the log and
+     * the history, flagged as cancelled; it no longer appears in the
+     * customer's bookings or in report totals.
+     * 
+     * @param bookingId Booking to cancel
+     * @param error Receives the failure reason, may be nullptr
+     * @return false if the booking does not exist, is already cancelled,
+     *         or this service is a replica
+     */
+    bool cancelBooking(int bookingId, QString* error = nullptr);
+    
+    /**
+     * @brief Queues a party for seats in a showing (thread-safe)
+     * 
+     * Whenever seats of the showing are released, the waitlist is served
+     * in joining order under the showing's lock: each entry that fits is
+     * booked at once (adjacent seats preferred, using the smallest gap
+     * that holds the party), and an entry that does not fit lets smaller
+     * parties behind it go first. Promotions are announced through
+     * waitlistPromoted(), so clients need not poll. An entry that fits
+     * when it joins is booked immediately.
+     * 
+     * The seats count against the customer's quota (see setRateLimits())
+     * while the entry waits.
+     * 
+     * @param theaterId Theater identifier
+     * @param movieId Movie identifier
+     * @param seatCount Seats wanted
+     * @param customerName Customer name/identifier
+     * @param error Receives the failure reason, may be nullptr
+     * @return Waitlist ID, or 0 on failure
+     */
+    int joinWaitlist(int theaterId, int movieId, int seatCount, const QString& customerName,
+                     QString* error = nullptr);
+    
+    /**
+     * @brief Removes a waiting party (thread-safe)
+     * @param theaterId Theater identifier
+     * @param movieId Movie identifier
+     * @param waitlistId ID returned by joinWaitlist()
+     * @return false if the entry is not waiting (anymore)
+     */
+    bool leaveWaitlist(int theaterId, int movieId, int waitlistId);
+    
+    /**
+     * @brief Gets the parties waiting for a showing (thread-safe)
+     * @param theaterId Theater identifier
+     * @param movieId Movie identifier
+     * @return Entries in joining order
+     */
+    QVector<WaitlistEntry> getWaitlist(int theaterId, int movieId) const;
+    
+    /**
+     * @brief Sets per-customer and per-showing request limits (thread-safe)
+     * 
+     * Reservations are checked before any catalog lookup or lock: each
+     * request spends a token from its customer's and its showing's
+     * bucket, and a customer may hold at most maxSeatsPerCustomer seats
+     * in one showing (group reservations are checked per showing).
+     * Rejected requests fail with RateLimited or QuotaExceeded.
+     * Replayed idempotent retries are not counted. All limits are off
+     * by default.
+     * 
+     * @param limits New limits; zero turns a limit off
+     */
+    void setRateLimits(const RateLimiter::Limits& limits);
+    
+    /**
+     * @brief Gets the request limits (thread-safe)
+     * @return Current limits
+     */
+    RateLimiter::Limits getRateLimits() const;
+    
+    /**
+     * @brief Reports the waiting room of a showing (thread-safe)
+     * 
+     * Tells a caller arriving now how many callers are ahead of it and
+     * roughly how long it would wait, or that the showing is sold out.
+     * 
+     * @param theaterId Theater identifier
+     * @param movieId Movie identifier
+     * @return Waiting room position; SoldOut if the showing does not exist
+     */
+    AdmissionQueue::Position getAdmissionPosition(int theaterId, int movieId) const;
+    
+    /**
+     * @brief Sets how many callers may book a showing at once (thread-safe)
+     * @param theaterId Theater identifier
+     * @param movieId Movie identifier
+     * @param maxActive Callers admitted at once (at least 1)
+     * @return false if the showing does not exist
+     */
+    bool setAdmissionLimit(int theaterId, int movieId, int maxActive);
+    
+    /**
+     * @brief Prices every seat of a showing at its current occupancy (thread-safe)
+     * 
+     * Intended for listing pages; uses the compiled price table and does
+     * not lock the showing. Reserved seats are priced too.
+     * 
+     * @param theaterId Theater identifier
+     * @param movieId Movie identifier
+     * @return Price in cents per seat index, empty if the showing does not exist
+     */
+    QVector<int> getSeatPrices(int theaterId, int movieId) const;
+    
+    /**
+     * @brief Replaces the pricing used for new bookings (thread-safe)
+     * 
+     * Existing bookings keep the prices they were booked at.
+     * 
+     * @param pricing New pricing engine
+     */
+    void setPricing(const PricingEngine& pricing);
     
     /**
      * @brief Gets all bookings for a customer (thread-safe)
@@ -119,6 +631,154 @@ public:
      */
     QVector<BookingData> getBookingData(const QString& customerName) const;
     
+    /**
+     * @brief Gets one page of a customer's bookings, oldest first (thread-safe)
+     *
+     * The cursor names the next booking's row rather than a position, so
+     * bookings cancelled between pages shift nothing.
+     *
+     * @param customerName Customer name/identifier
+     * @param cursor 0 for the first page, else the previous nextCursor
+     * @param limit Maximum bookings per page
+     * @return Page of booking data
+     */
+    Page<BookingData> getBookingDataPage(const QString& customerName, int cursor,
+                                         int limit) const;
+    
+    /**
+     * @brief Visits a customer's bookings, oldest first (thread-safe)
+     * 
+     * Bookings are copied in fixed-size chunks into a stack buffer (the
+     * copies share their strings), so the booking lock is held only
+     * per chunk; the visitor runs unlocked and may call back into the
+     * service. Bookings made while visiting may be included.
+     * 
+     * @param customerName Customer name/identifier
+     * @param visitor Called per booking
+     * @return Number of bookings visited
+     */
+    int forEachBooking(const QString& customerName, const BookingVisitor& visitor) const;
+    
+    /**
+     * @brief Gets a customer's bookings with movie and hall names (thread-safe)
+     * 
+     * Resolves every booking against one catalog version through its
+     * ID indexes, in a single pass over the customer's bookings.
+     * 
+     * @param customerName Customer name/identifier
+     * @return Bookings in booking order
+     */
+    QVector<BookingDetails> getBookingDetails(const QString& customerName) const;
+    
+    /**
+     * @brief Gets a snapshot of the booking history for reporting (thread-safe)
+     * 
+     * The snapshot shares the history's column chunks and keeps its own
+     * row count, so taking it copies one pointer per few thousand
+     * bookings, and later bookings append past it without copying; run
+     * aggregate queries on it without blocking reservations.
+     * 
+     * @return Columnar booking history
+     */
+    BookingHistory getBookingHistory() const;
+    
+    /**
+     * @brief Shares seat state with other booking processes on this host
+     * 
+     * Creates or attaches to the named shared-memory inventory. From then
+     * on, availability and claims go through the shared segment, so
+     * several processes reserve against one inventory, and booking IDs
+     * are unique across them. Call once, before serving requests; every
+     * process must load the same catalog.
+     * 
+     * @param name Shared-memory segment name
+     * @param error Receives the failure reason, may be nullptr
+     * @return true if attached
+     */
+    bool attachSharedInventory(const QString& name, QString* error = nullptr);
+    
+    /**
+     * @brief Streams committed bookings and cancellations to replicas
+     * 
+     * Listens on a Unix domain socket. Replicas receive the log from the
+     * point they ask for (bookings and cancellations made before this
+     * call included), then every new entry as it commits. Only the newest
+     * ReplicationPublisher::DEFAULT_RETAINED_FRAMES entries are kept; a
+     * replica needing older ones is disconnected.
+     * 
+     * @param socketPath Socket path to listen on
+     * @param error Receives the failure reason, may be nullptr
+     * @return true if listening
+     */
+    bool startReplication(const QString& socketPath, QString* error = nullptr);
+    
+    /**
+     * @brief Turns this service into a read-only replica of a primary
+     * 
+     * Reservations fail from then on; availability and booking queries
+     * are served from the replicated log. Call on a fresh service with
+     * the same catalog as the primary.
+     * 
+     * @param socketPath Socket path the primary listens on
+     * @param error Receives the failure reason, may be nullptr
+     * @return true if connected
+     */
+    bool replicateFrom(const QString& socketPath, QString* error = nullptr);
+    
+    /**
+     * @brief Stops replicating and starts accepting reservations
+     * 
+     * Bookings the old primary committed but had not yet sent are lost;
+     * check getReplicationStatus() first when that matters.
+     * 
+     * @return false if this service is not a replica
+     */
+    bool promoteToPrimary();
+    
+    /**
+     * @brief Gets the replication role, log position and lag
+     * @return Current replication status
+     */
+    ReplicationStatus getReplicationStatus() const;
+    
+    /**
+     * @brief Replaces the catalog (movies, theaters, showings) while serving
+     * 
+     * Publishes a new catalog version; reservations keep running
+     * throughout. Showings that survive in a hall of the same size keep
+     * their seat state as is. A showing whose hall changed size gets a
+     * new seat map with its booked seats carried over; the reload fails
+     * if a booked seat does not exist in the new layout. New showings
+     * are built in parallel without holding any lock.
+     * 
+     * Reservations that picked a showing from the old version are
+     * retried against the new one if the showing was replaced; they fail
+     * if it was dropped. An old version is freed once its last reader,
+     * including every PinnedList, PinnedRef and Page it returned, is
+     * done; the objects only it listed (seats of replaced showings,
+     * dropped movies and theaters) are then deleted by the event loop.
+     * Unchanged movies and theaters keep their objects.
+     * 
+     * @param catalog Catalog to publish
+     * @param error Receives the failure reason, may be nullptr
+     * @return true if the catalog is valid and was published
+     */
+    bool loadCatalog(const CatalogData& catalog, QString* error = nullptr);
+    
+    /**
+     * @brief Reads a catalog file (see CatalogLoader) and publishes it
+     * @param path Path to a .json or .csv catalog
+     * @param error Receives the failure reason, may be nullptr
+     * @return true if the file was loaded and published
+     */
+    bool loadCatalogFile(const QString& path, QString* error = nullptr);
+    
+    /**
+     * @brief Gets the catalog version and how many versions are still alive
+     * @return Current catalog status
+     */
+    CatalogStatus getCatalogStatus() const;
+    
     /**
      * @brief Initializes sample data for testing purposes
      * 
@@ -126,6 +786,41 @@ public:
      * Called automatically during construction.
      */
     void initializeSampleData();
+    
+    /// Called at an interleaving point with the point's name (see setInterleaveHook())
+    using InterleaveHook = void (*)(void* context, const char* point);
+    
+    /**
+     * @brief Installs a hook called at fixed points of the booking pipeline
+     * 
+     * The points (e.g. "reserve.prechecked") lie between lock regions:
+     * no lock or waiting-room slot is held when the hook runs, so a test
+     * scheduler may park the calling thread there and run another one
+     * (see BookingSimulator). Not for production use; install before
+     * any concurrent call.
+     * 
+     * @param hook Hook, or nullptr to remove it
+     * @param context Passed to the hook unchanged
+     */
+    void setInterleaveHook(InterleaveHook hook, void* context);
+    
+    /**
+     * @brief Checks that the service's state is consistent (thread-safe)
+     * 
+     * Locks every showing and the booking records, then verifies that
+     * the seat map, taken bits, seat objects and free counter of each
+     * showing agree; that no seat is sold twice and every showing's
+     * taken seats are exactly the seats of its bookings; and that the
+     * per-customer index and the booking history cover every booking
+     * once. Cancelled bookings must hold no seats and be left out of the
+     * index. Bookings of other processes (shared inventory) are not
+     * visible here, so the seat-to-booking match is skipped when one is
+     * attached.
+     * 
+     * @param error Receives the first violation found (optional)
+     * @return true if every invariant holds
+     */
+    bool verifyInvariants(QString* error = nullptr) const;
 
 signals:
     /**
@@ -144,27 +839,282 @@ signals:
     
     /**
      * @brief Emitted when a reservation attempt fails
+     * 
+     * The text is only rendered while something is connected; callers
+     * that need the details should use the returned ReservationResult.
+     * 
      * @param reason Reason for failure
      */
     void reservationFailed(const QString& reason);
+    
+    /**
+     * @brief Emitted when a cancellation gives seats back
+     * 
+     * Emitted before the waitlistPromoted() signals of parties that
+     * received some of the seats.
+     * 
+     * @param theaterId Theater identifier
+     * @param movieId Movie identifier
+     * @param seatIds Released seat IDs
+     */
+    void seatsReleased(int theaterId, int movieId, const QStringList& seatIds);
+    
+    /**
+     * @brief Emitted when a waiting party has been booked
+     * 
+     * Follows the seatsReserved() and bookingCreated() signals of the
+     * new booking.
+     * 
+     * @param waitlistId ID returned by joinWaitlist()
+     * @param bookingId Booking made for the party
+     * @param customerName Customer name/identifier
+     */
+    void waitlistPromoted(int waitlistId, int bookingId, const QString& customerName);
 
 private:
+    /// Catalogs with fewer showings are built on the calling thread
+    static constexpr int PARALLEL_BUILD_THRESHOLD = 64;
+    
+    /// Items read per lock hold by the forEach visitors
+    static constexpr int STREAM_CHUNK_SIZE = 64;
+    
+    /**
+     * @brief Memory for the showings one catalog load builds on one NUMA node
+     *
+     * loadCatalog() sizes one block per node up front and the parallel
+     * builders carve each showing, its taken bits and its seat map out of
+     * it, so a load makes one allocation per node instead of three per
+     * showing. Every showing keeps a reference; the block is freed with
+     * the last of them, so a showing reused by later loads keeps its
+     * original block alive.
+     */
+    struct ShowingBlock {
+        /**
+         * @brief Allocates a block (bound to a node when one is given)
+         * @param size Bytes needed
+         * @param node NUMA node, -1 for no binding
+         */
+        ShowingBlock(std::size_t size, int node);
+        ~ShowingBlock();
+        Q_DISABLE_COPY(ShowingBlock)
+
+        char* memory;               ///< Cache-line aligned, page aligned when bound
+        const int numaNode;         ///< Node passed to NumaMemory
+    };
+
+    /**
+     * @brief Seat map and change tracking of one theater-movie showing
+     *
+     * Split into cache-line groups so that neither showings nor the hot
+     * fields of one showing share a line: read-mostly metadata, the lock
+     * with the state it guards, the free-seat counter that prechecks read
+     * without the lock, and the waiting room. Created by buildShowing()
+     * in a ShowingBlock, optionally on a given NUMA node.
+     */
+    struct alignas(NumaMemory::CACHE_LINE_SIZE) ShowingSeats {
+        /// One cache line of taken bits
+        struct alignas(NumaMemory::CACHE_LINE_SIZE) TakenBitsLine {
+            QAtomicInteger<quint64> words[NumaMemory::CACHE_LINE_SIZE / sizeof(quint64)];
+        };
+        static constexpr int SEATS_PER_LINE = int(sizeof(TakenBitsLine) * 8);
+
+        /**
+         * @brief Constructs an empty showing (does not allocate)
+         * @param capacity Number of seats
+         * @param block Block the showing is placed in
+         * @param bits Taken bit lines for capacity seats, right behind the showing
+         */
+        ShowingSeats(int capacity, QSharedPointer<ShowingBlock> block, void* bits);
+        ~ShowingSeats();
+        Q_DISABLE_COPY(ShowingSeats)
+
+        /**
+         * @brief Gets the block space a showing of a hall size takes
+         * @param capacity Number of seats
+         * @return Bytes for the showing, its taken bits and its seat map, in whole lines
+         */
+        static std::size_t footprint(int capacity);
+
+        /**
+         * @brief Tells whether a seat's taken bit is set (no lock needed)
+         * @param seatIndex Seat index
+         * @return true while the seat is reserved
+         */
+        bool isTakenBitSet(int seatIndex) const
+        {
+            const quint64 word = takenBits[seatIndex / SEATS_PER_LINE]
+                                     .words[seatIndex % SEATS_PER_LINE / 64].loadAcquire();
+            return word & (quint64(1) << (seatIndex % 64));
+        }
+
+        /**
+         * @brief Sets a seat's taken bit
+         * @param seatIndex Seat index
+         */
+        void setTakenBit(int seatIndex)
+        {
+            takenBits[seatIndex / SEATS_PER_LINE].words[seatIndex % SEATS_PER_LINE / 64]
+                .fetchAndOrRelease(quint64(1) << (seatIndex % 64));
+        }
+
+        /**
+         * @brief Clears a seat's taken bit
+         * @param seatIndex Seat index
+         */
+        void clearTakenBit(int seatIndex)
+        {
+            takenBits[seatIndex / SEATS_PER_LINE].words[seatIndex % SEATS_PER_LINE / 64]
+                .fetchAndAndRelease(~(quint64(1) << (seatIndex % 64)));
+        }
+
+        // Read-mostly: written when built or attached
+        QVector<Seat*> seats;       ///< Seats in index order
+        std::unique_ptr<QObject> seatOwner; ///< Parent of the seats, moved to the service thread with them and deleted there
+        SeatMapPtr seatMap;         ///< Authoritative taken state, sized to the hall, in the showing's block
+        TakenBitsLine* takenBits;   ///< One bit per seat, set while reserved (own lines)
+        const int numaNode;         ///< Node the showing's memory is bound to, -1 if none
+        quint64 lineage = 0;        ///< Shared by a showing and the successors its seats were carried over to
+        QSharedPointer<ShowingBlock> block; ///< Memory the showing, its bits and seat map live in
+        SharedInventory* shared = nullptr; ///< Cross-process inventory, if attached
+        int sharedSlot = -1;        ///< This showing's slot in the shared inventory
+
+        // Lock and the state it guards
+        alignas(NumaMemory::CACHE_LINE_SIZE) mutable QMutex mutex; ///< Guards the seat map of this showing only
+        quint64 version = 0;        ///< Bumped on every committed seat change
+        bool retired = false;       ///< Replaced or dropped by a catalog reload
+        SeatChangeLog changes;      ///< Recent seat changes for incremental refresh
+        QSharedPointer<const SeatChartTemplate> chartTemplate; ///< Hall layout's blank chart, set on first use
+        QByteArray charts[2];       ///< Rendered charts by SeatChartTemplate::Format, null until first use
+        quint64 chartVersions[2] = {}; ///< Showing version each chart reflects
+        QVector<WaitlistEntry> waitlist; ///< Parties waiting for seats, in joining order
+
+        // Written by every commit, read by every precheck
+        alignas(NumaMemory::CACHE_LINE_SIZE) QAtomicInt availableCount; ///< Free seats, readable without the mutex
+
+        // Has its own lock and counters
+        alignas(NumaMemory::CACHE_LINE_SIZE) AdmissionQueue admission; ///< Waiting room for reserveSeats()
+    };
+    
     /**
      * @brief Internal structure to manage seats per movie in a theater
      */
     struct TheaterSeats {
-        QMap<int, QVector<Seat*>> movieSeats; ///< movieId -> seats
+        QMap<int, QSharedPointer<ShowingSeats>> movieSeats; ///< movieId -> showing seats
     };
     
-    mutable QReadWriteLock m_readWriteLock;     ///< Read-write lock for optimized access
-    mutable QMutex m_reservationMutex;          ///< Mutex for critical reservation operations
+    /**
+     * @brief O(1) map from catalog IDs to positions in a catalog array
+     * 
+     * A dense array over the ID range when IDs are compact (the usual
+     * case), a hash when they are sparse.
+     */
+    struct IdIndex {
+        /**
+         * @brief Indexes IDs by their position
+         * @param ids IDs in array order
+         */
+        void build(const QVector<int>& ids);
+        
+        /**
+         * @brief Finds the position of an ID
+         * @param id ID to look up
+         * @return Position, or -1 if the ID is unknown
+         */
+        int indexOf(int id) const;
+        
+        qint64 base = 0;            ///< Smallest ID (dense form)
+        QVector<int> dense;         ///< ID - base -> position, -1 for gaps
+        QHash<int, int> sparse;     ///< ID -> position when IDs are spread out
+    };
     
-    QVector<Movie*> m_movies;                   ///< Movie objects (managed by Qt parent)
-    QVector<Theater*> m_theaters;               ///< Theater objects (managed by Qt parent)
-    QMap<int, TheaterSeats> m_theaterSeats;     ///< theaterId -> TheaterSeats
+    /**
+     * @brief Secondary indexes over a catalog's movies
+     * 
+     * Built once per catalog version and never modified, like the rest
+     * of the version. Entries are positions in the movie array, so a
+     * query returns the catalog's own Movie pointers.
+     */
+    struct MovieSearchIndex {
+        /**
+         * @brief Indexes movies by genre, title and duration
+         * @param movies Movies in catalog order
+         */
+        void build(const QVector<Movie*>& movies);
+        
+        QHash<QString, QVector<int>> byGenre;   ///< Case-folded genre -> positions, in catalog order
+        QVector<QPair<QString, int>> byTitle;   ///< (case-folded title, position), sorted
+        QVector<QPair<int, int>> byDuration;    ///< (duration, position), sorted
+    };
+    
+    /**
+     * @brief One published version of the catalog
+     * 
+     * Never modified once published (showings have their own locks).
+     * Readers take a reference through currentCatalog() and use it
+     * without any catalog lock; a version is freed when its last reader
+     * lets go.
+     */
+    struct Catalog {
+        explicit Catalog(QAtomicInt& liveCount);
+        ~Catalog();
+        
+        /**
+         * @brief Finds the seats of a showing
+         * @param theaterId Theater identifier
+         * @param movieId Movie identifier
+         * @return Showing seats, or null if the showing does not exist
+         */
+        QSharedPointer<ShowingSeats> findShowing(int theaterId, int movieId) const;
+        
+        quint64 version = 0;                    ///< 1 for the first catalog, +1 per reload
+        QVector<Movie*> movies;                 ///< Movie objects (children of the service)
+        QVector<Theater*> theaters;             ///< Theater objects (children of the service)
+        IdIndex movieIndex;                     ///< Movie ID -> position in movies
+        IdIndex theaterIndex;                   ///< Theater ID -> position in theaters
+        MovieSearchIndex movieSearch;           ///< Genre, title and duration -> positions in movies
+        QMap<int, TheaterSeats> theaterSeats;   ///< theaterId -> TheaterSeats
+        QVector<QSharedPointer<QObject>> objectRefs; ///< Movies then theaters, shared by every version listing them
+        QAtomicInt& liveCount;                  ///< Service-wide count of live versions
+    };
+    
+    // Lock order: m_catalogReloadMutex -> showing mutexes (ascending
+    // theaterId, movieId) -> m_bookingMutex. m_readWriteLock is held only
+    // to copy or swap the catalog and pricing handles, never while taking
+    // another lock. Admission queues are waited on with no lock held;
+    // their internal mutex and the customer registry lock are always
+    // taken last. A shared inventory's showing mutex is taken after the
+    // local showing mutex and released last. The replication publisher's
+    // mutex is taken under m_bookingMutex. m_chartTemplateMutex is taken
+    // under a showing mutex and nothing is taken under it.
+    mutable QReadWriteLock m_readWriteLock;     ///< Guards the catalog and pricing handles
+    mutable QMutex m_bookingMutex;              ///< Guards booking records and the ID counter
+    QMutex m_catalogReloadMutex;                ///< Serializes catalog reloads and inventory attachment
+    mutable QMutex m_chartTemplateMutex;        ///< Guards m_chartTemplates
+    
+    QAtomicInt m_liveCatalogs;                  ///< Catalog versions not yet freed
+    QSharedPointer<const Catalog> m_catalog;    ///< Current catalog version (guarded by m_readWriteLock)
     QVector<Booking*> m_bookings;               ///< Booking objects (managed by Qt parent)
     QVector<BookingData> m_bookingData;         ///< Plain booking data (thread-safe)
+    BookingHistory m_history{&m_customers};     ///< Columnar copy of bookings for reports
+    CustomerRegistry m_customers;               ///< Customer ID intern table (own lock)
+    QHash<quint32, QVector<int>> m_bookingRowsByCustomer; ///< Customer handle -> live m_bookingData rows
+    QVector<QPair<quint64, int>> m_cancelledRows; ///< Log sequence and m_bookingData row per cancellation
+    std::unique_ptr<SharedInventory> m_sharedInventory; ///< Cross-process inventory, null unless attached
+    QSharedPointer<const PricingEngine> m_pricing; ///< Current pricing (guarded by m_readWriteLock)
     int m_nextBookingId;                        ///< Counter for booking IDs
+    quint64 m_nextShowingLineage = 1;           ///< Next lineage for a new showing (guarded by m_catalogReloadMutex)
+    QAtomicInt m_lastWaitlistId;                ///< Last waitlist ID handed out
+    IdempotencyTable m_idempotency;             ///< Outcomes of keyed reservations (own locks)
+    RateLimiter m_rateLimiter;                  ///< Request limits and seat quotas (own locks)
+    InterleaveHook m_interleaveHook = nullptr;  ///< Test scheduler hook, see setInterleaveHook()
+    void* m_interleaveContext = nullptr;        ///< Context passed to m_interleaveHook
+    QAtomicInt m_isReplica;                     ///< Non-zero while replicating from a primary
+    QAtomicInteger<qint64> m_replicationLagMs;  ///< Lag of the last applied booking
+    mutable QHash<int, QSharedPointer<const SeatChartTemplate>> m_chartTemplates; ///< Capacity -> blank chart
+    
+    // Declared last so their threads stop before anything they touch is destroyed
+    std::unique_ptr<ReplicationPublisher> m_replicationPublisher; ///< Guarded by m_bookingMutex
+    std::unique_ptr<ReplicationSubscriber> m_replicationSubscriber; ///< Guarded by m_bookingMutex
     
     /**
      * @brief Creates a unique key for theater-movie combination
@@ -175,9 +1125,279 @@ private:
     QString makeKey(int theaterId, int movieId) const;
     
     /**
-     * @brief Initializes seat layout for a specific theater-movie combination
+     * @brief Builds the empty seat state of one showing (any thread)
+     *
+     * Touches nothing shared: the showing is placed at its own offset of
+     * the load's block, and the seats are created as children of the
+     * showing's own seatOwner on the calling thread and handed to
+     * @p owner in one moveToThread(), so parallel builders do not meet
+     * on the owner thread's lock once per seat.
+     *
+     * @param capacity Number of seats in the theater
+     * @param block Block sized by ShowingSeats::footprint() for every showing placed in it
+     * @param offset Start of this showing's footprint in the block
+     * @param owner Thread the seat objects are moved to
+     * @return New showing; it owns its seats
+     */
+    static QSharedPointer<ShowingSeats> buildShowing(int capacity,
+                                                     const QSharedPointer<ShowingBlock>& block,
+                                                     std::size_t offset, QThread* owner);
+    
+    /**
+     * @brief Gets the blank chart of a hall layout, rendering it on first use
+     * @param layout Seat map of the hall
+     * @return Template shared by every hall of this layout
+     */
+    QSharedPointer<const SeatChartTemplate> chartTemplate(const SeatMap& layout) const;
+    
+    /**
+     * @brief Calls the interleave hook, if one is installed
+     * @param point Name of the point
+     * @note Caller must hold no lock
+     */
+    void interleave(const char* point) const
+    {
+        if (Q_UNLIKELY(m_interleaveHook)) {
+            m_interleaveHook(m_interleaveContext, point);
+        }
+    }
+    
+    /**
+     * @brief Takes a reference to the current catalog version
+     * @return Current catalog; stays valid for as long as it is held
+     */
+    QSharedPointer<const Catalog> currentCatalog() const;
+    
+    /**
+     * @brief Copies the booked seats of a replaced showing into its successor
+     * @param from Showing being replaced (its mutex must be held)
+     * @param to New, unpublished showing
+     * @return false if a booked seat does not exist in the new layout
+     */
+    static bool carryOverSeats(const ShowingSeats& from, ShowingSeats& to);
+    
+    /**
+     * @brief Reservation path shared by both reserveSeats() overloads
      * @param theaterId Theater identifier
      * @param movieId Movie identifier
+     * @param seatIds List of seat IDs to reserve
+     * @param customerName Customer name/identifier
+     * @return Outcome, with the booking ID on success
+     */
+    ReservationResult reserve(int theaterId, int movieId, const QStringList& seatIds,
+                              const QString& customerName);
+    
+    /**
+     * @brief Books seats in one showing for a request that passed the rate limits
+     * @param theaterId Theater identifier
+     * @param movieId Movie identifier
+     * @param seatIds List of seat IDs to reserve
+     * @param customerName Customer name/identifier
+     * @param quotaHold Seats the request counted against the customer's quota
+     * @return Outcome, with the booking ID on success
+     */
+    ReservationResult bookShowing(int theaterId, int movieId, const QStringList& seatIds,
+                                  const QString& customerName,
+                                  const RateLimiter::QuotaHold& quotaHold);
+    
+    /**
+     * @brief Checks one showing's part of a request against the rate limits
+     * 
+     * On success the seats count against the customer's quota until
+     * m_rateLimiter.release() gives @p hold back.
+     * 
+     * @param customerName Customer name/identifier
+     * @param theaterId Theater identifier
+     * @param movieId Movie identifier
+     * @param seatCount Seats requested in the showing
+     * @param result Receives RateLimited or QuotaExceeded on failure
+     * @param hold Receives the seats counted against the quota
+     * @return true if the request may go ahead
+     */
+    bool admitRequest(const QString& customerName, int theaterId, int movieId, int seatCount,
+                      ReservationResult& result, RateLimiter::QuotaHold& hold);
+    
+    /**
+     * @brief Emits reservationFailed() for a failed result, if anyone listens
+     * @param result Failed outcome
+     * @param seatIds Seat IDs of the request, to name unknown seats
+     */
+    void reportFailure(const ReservationResult& result, const QStringList& seatIds);
+    
+    /**
+     * @brief Rejects requests that cannot succeed, without any lock
+     * 
+     * Checks the free-seat counter and the per-seat taken bits. Passing
+     * does not guarantee success; prepareSeats() decides under the mutex.
+     * 
+     * @param showing Showing to reserve in
+     * @param seatIds Requested seat IDs
+     * @param result Receives the failure
+     * @return false if the request is certain to fail
+     */
+    bool precheckSeats(const ShowingSeats& showing, const QStringList& seatIds,
+                       ReservationResult& result) const;
+    
+    /**
+     * @brief Prepare phase: resolves and validates requested seats
+     * @param showing Showing to reserve in (its mutex must be held)
+     * @param seatIds Requested seat IDs
+     * @param seatIndices Receives the resolved seat indices
+     * @param result Receives the failure
+     * @return true if every seat exists, is available and requested once
+     */
+    bool prepareSeats(const ShowingSeats& showing, const QStringList& seatIds,
+                      QVector<int>& seatIndices, ReservationResult& result) const;
+    
+    /**
+     * @brief Computes a showing's occupancy without locking it
+     * @param showing Showing to inspect
+     * @return Reserved seats in percent of capacity
+     */
+    static int occupancyPercent(const ShowingSeats& showing);
+    
+    /**
+     * @brief Prices prepared seats at the showing's current occupancy
+     * @param pricing Pricing engine to use
+     * @param showing Showing the seats belong to
+     * @param seatIndices Seat indices returned by prepareSeats()
+     * @return Price in cents per requested seat
+     */
+    QVector<int> priceSeats(const PricingEngine& pricing, const ShowingSeats& showing,
+                            const QVector<int>& seatIndices) const;
+    
+    /**
+     * @brief Claims prepared seats in the shared inventory, if attached
+     * 
+     * On success the shared showing stays locked until finishSharedClaim().
+     * 
+     * @param showing Showing to reserve in (its mutex must be held)
+     * @param seatIndices Seat indices returned by prepareSeats()
+     * @param result Receives the failure
+     * @return true if no inventory is attached or every seat was claimed
+     */
+    bool claimSharedSeats(ShowingSeats& showing, const QVector<int>& seatIndices,
+                          ReservationResult& result);
+    
+    /**
+     * @brief Commits or aborts a claim made by claimSharedSeats()
+     * @param showing Showing passed to claimSharedSeats()
+     * @param commit true to keep the seats, false to release them
+     */
+    void finishSharedClaim(ShowingSeats& showing, bool commit);
+    
+    /**
+     * @brief Commit phase: marks prepared seats reserved and bumps the version
+     * @param showing Showing to reserve in (its mutex must be held)
+     * @param seatIndices Seat indices returned by prepareSeats()
+     */
+    void commitSeats(ShowingSeats& showing, const QVector<int>& seatIndices);
+    
+    /**
+     * @brief Stores a committed booking
+     * @param theaterId Theater identifier
+     * @param movieId Movie identifier
+     * @param showingLineage Lineage of the showing the seats were taken in
+     * @param seatIds Reserved seat IDs
+     * @param seatIndices Reserved seat indices, in seatIds order
+     * @param customerName Customer name/identifier
+     * @param seatPrices Price per seat in cents
+     * @param quotaHold Seats the request counted against the customer's quota
+     * @return Booking QObject, or nullptr when called off the service thread
+     * @note Caller must hold m_bookingMutex
+     */
+    Booking* recordBooking(int theaterId, int movieId, quint64 showingLineage,
+                           const QStringList& seatIds, const QVector<int>& seatIndices,
+                           const QString& customerName, const QVector<int>& seatPrices,
+                           const RateLimiter::QuotaHold& quotaHold);
+    
+    /**
+     * @brief Finds a booking's row in m_bookingData
+     * @param bookingId Booking ID
+     * @return Row, or -1 if there is no such booking
+     * @note Caller must hold m_bookingMutex
+     */
+    int bookingRow(int bookingId) const;
+    
+    /**
+     * @brief Cancellation path shared by cancelBooking() and replicas
+     * @param bookingId Booking to cancel
+     * @param error Receives the failure reason, may be nullptr
+     * @return false if the booking does not exist or is already cancelled
+     */
+    bool cancel(int bookingId, QString* error);
+    
+    /**
+     * @brief Flags a booking cancelled in the log, indexes and replication stream
+     * @param row Row of the booking in m_bookingData
+     * @note Caller must hold m_bookingMutex
+     */
+    void markCancelled(int row);
+    
+    /**
+     * @brief Frees seats of a showing and bumps the version
+     * @param showing Showing the seats belong to (its mutex must be held)
+     * @param seatIndices Seats to free; seats that are not taken are skipped
+     */
+    void releaseSeats(ShowingSeats& showing, const QVector<int>& seatIndices);
+    
+    /**
+     * @brief A waiting party booked by promoteWaitlist(), to be announced
+     */
+    struct Promotion {
+        int waitlistId;             ///< Served waitlist entry
+        int bookingId;              ///< Booking made for it
+        QString customerId;         ///< Customer identifier
+        int theaterId;              ///< Theater identifier
+        int movieId;                ///< Movie identifier
+        QStringList seatIds;        ///< Seats booked
+        Booking* booking;           ///< Booking QObject, nullptr off the service thread
+    };
+    
+    /**
+     * @brief Books every waiting party of a showing that now fits
+     * @param theaterId Theater identifier
+     * @param movieId Movie identifier
+     * @param showing Showing to serve (its mutex must be held)
+     * @param pricing Pricing engine to use
+     * @return Parties booked, in joining order; emit them with emitPromotions()
+     */
+    QVector<Promotion> promoteWaitlist(int theaterId, int movieId, ShowingSeats& showing,
+                                       const PricingEngine& pricing);
+    
+    /**
+     * @brief Chooses free seats for a waiting party
+     * 
+     * Prefers the smallest run of adjacent free seats that holds the
+     * party, leaving larger runs for larger parties; falls back to the
+     * lowest free seats.
+     * 
+     * @param showing Showing to choose in (its mutex must be held)
+     * @param seatCount Seats wanted
+     * @return Seat indices, empty if fewer seats are free
+     */
+    static QVector<int> pickWaitlistSeats(const ShowingSeats& showing, int seatCount);
+    
+    /**
+     * @brief Emits the signals of waitlist promotions
+     * @param promotions Returned by promoteWaitlist()
+     * @note Caller must hold no lock
+     */
+    void emitPromotions(const QVector<Promotion>& promotions);
+    
+    /**
+     * @brief Appends a booking to the log, indexes and replication stream
+     * @param bookingData Booking with id, customer, showing, seats, prices
+     *        and time set; customer handle and total are filled in
+     * @param seatIndices Reserved seat indices, in seatIds order
+     * @note Caller must hold m_bookingMutex
+     */
+    void storeBooking(BookingData& bookingData, const QVector<int>& seatIndices);
+    
+    /**
+     * @brief Applies a booking or cancellation received from the primary (replica thread)
+     * @param record Replicated record
+     * @return false if the replica diverged and cannot apply it; nothing is stored then
      */
-    void initializeSeats(int theaterId, int movieId);
+    bool applyReplicatedBooking(const ReplicationRecord& record);
 };
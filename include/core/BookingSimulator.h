@@ -0,0 +1,250 @@
+#pragma once
+
+#include <QAtomicInteger>
+#include <QMutex>
+#include <QRandomGenerator>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QWaitCondition>
+#include <QtGlobal>
+
+class BookingService;
+class QThread;
+
+/**
+ * @brief Deterministic, seeded concurrency simulation of BookingService
+ *
+ * Thousands of virtual clients issue reservations, keyed retries, group
+ * bookings, cancellations, waitlist entries, seat and booking queries
+ * and catalog reloads against one service. The clients are multiplexed
+ * onto a few real threads (lanes), but only one lane runs at a time: it
+ * holds a baton, and at every
+ * interleaving point of the service (see
+ * BookingService::setInterleaveHook()) a seeded random generator decides
+ * whether to hand the baton to another lane. The schedule, and so every
+ * outcome, is a function of the seed alone: a failing seed replays
+ * exactly.
+ *
+ * After each step (every checkEvery steps) the simulator runs
+ * BookingService::verifyInvariants(). It also keeps its own model of
+ * the sold seats and fails on any seat sold twice, on a sold seat
+ * reported available, on a client seeing the wrong number of bookings,
+ * or on a keyed retry that books again. Waitlist promotions are fed
+ * into the model from the service's signals. When most seats are sold
+ * it drains the operations in flight, compares the quiescent service
+ * with the model seat by seat (and checks that no waiting party would
+ * fit), and starts over on a fresh service (an epoch).
+ *
+ * @note Not thread-safe; call run() from one thread.
+ */
+class BookingSimulator {
+public:
+    /**
+     * @brief Simulation settings
+     */
+    struct Options {
+        quint32 seed = 1;           ///< Schedule and workload seed
+        int operations = 10000;     ///< Client operations to run
+        int clients = 2000;         ///< Virtual clients
+        int lanes = 4;              ///< Threads the clients run on
+        int theaters = 3;           ///< Halls per catalog
+        int movies = 4;             ///< Movies per catalog, each shown in every hall
+        int capacity = 20;          ///< Seats per hall (reloads vary it by -2..+4)
+        double switchChance = 0.25; ///< Chance of switching lanes at each step
+        int checkEvery = 1;         ///< Steps between invariant checks, 0 for epochs only
+        int stallTimeoutMs = 10000; ///< Time without progress that counts as a deadlock
+    };
+
+    /**
+     * @brief Outcome of run()
+     */
+    struct Report {
+        bool ok = false;            ///< Every check passed
+        QString error;              ///< First failure
+        quint32 seed = 0;           ///< Seed that produced this run
+        int operations = 0;         ///< Client operations completed
+        quint64 steps = 0;          ///< Interleaving points passed
+        quint64 switches = 0;       ///< Baton handovers
+        int bookings = 0;           ///< Bookings made
+        int epochs = 0;             ///< Fresh services started
+        quint64 failedStep = 0;     ///< Step at which the failure was found
+        QStringList trail;          ///< Last steps before the failure ("step lane point")
+        quint64 digest = 0;         ///< Hash of the schedule and outcomes; equal for equal seeds
+        qint64 elapsedMs = 0;       ///< Wall time
+
+        /**
+         * @brief Renders the report for a log
+         * @return One line, plus the trail on failure
+         */
+        QString describe() const;
+    };
+
+    /**
+     * @brief Prepares a simulation
+     * @param options Settings (clamped to sane minimums)
+     */
+    explicit BookingSimulator(const Options& options);
+
+    ~BookingSimulator();
+
+    // Prevent copying (owns threads and a service)
+    BookingSimulator(const BookingSimulator&) = delete;
+    BookingSimulator& operator=(const BookingSimulator&) = delete;
+
+    /**
+     * @brief Runs the simulation to completion or to the first failure
+     *
+     * If no step is taken for stallTimeoutMs the run is reported as a
+     * deadlock and the stuck lanes are abandoned; the process should
+     * not start another simulation after that.
+     *
+     * @return Report
+     */
+    Report run();
+
+private:
+    /// Steps kept for the failure trail
+    static constexpr int TRAIL_LENGTH = 32;
+
+    struct Showing {
+        int theaterId;
+        int movieId;
+    };
+
+    struct Held {
+        int bookingId;
+        Showing showing;
+        QStringList seatIds;
+    };
+
+    struct ClientState {
+        int bookings = 0;           ///< Bookings the service should report
+        QVector<Held> held;         ///< Those bookings, for cancellation
+        int keySerial = 0;          ///< Idempotency keys used
+        QString lastKey;            ///< Most recent key
+        Showing lastShowing{0, 0};  ///< Request sent with lastKey
+        QStringList lastSeats;      ///< Request sent with lastKey
+        int lastBookingId = 0;      ///< Booking made under lastKey, 0 if not consumed
+        bool lastCancelled = false; ///< lastBookingId has been cancelled
+    };
+
+    struct TrailEntry {
+        quint64 step;
+        int lane;
+        const char* point;
+    };
+
+    static void onInterleave(void* context, const char* point);
+
+    /**
+     * @brief Body of one lane thread
+     */
+    void runLane(int lane);
+
+    /**
+     * @brief Counts a step, checks invariants and maybe hands the baton on
+     * @return false once the run has stopped; the lane must then touch
+     *         no simulation state
+     */
+    bool step(int lane, const char* point);
+
+    /**
+     * @brief Hands the baton to @p target and waits for it to come back
+     * @return false once the run has stopped
+     */
+    bool passTo(int target, int lane);
+
+    /**
+     * @brief Removes a lane that has no more work and hands the baton on
+     */
+    void retire(int lane);
+
+    /**
+     * @brief Records the first failure and releases every lane
+     * @return false, for chaining
+     */
+    bool fail(const QString& error);
+
+    bool stopped() const { return m_stopped.loadAcquire() != 0; }
+
+    // Operations; each returns false once the run has stopped
+    bool runOperation(int client);
+    bool reserve(int client);
+    bool reserveKeyed(int client);
+    bool reserveGroup(int client);
+    bool cancelBooking(int client);
+    bool joinWaitlist();
+    bool checkAvailableSeats();
+    bool checkBookingDetails(int client);
+    bool reloadCatalog();
+
+    /**
+     * @brief Adds a successful booking to the model
+     * @param client Client that booked, -1 for a waitlist promotion
+     * @return false (after fail()) if a seat was already sold
+     */
+    bool recordBooking(int client, const Showing& showing, const QStringList& seatIds,
+                       int bookingId);
+
+    /**
+     * @brief Adds a waitlist promotion announced by the service to the model
+     */
+    void recordPromotion(int bookingId);
+
+    /**
+     * @brief Replaces the service with a fresh one and resets the model
+     */
+    bool startEpoch();
+
+    /**
+     * @brief Compares the quiescent service with the model
+     */
+    bool closeEpoch();
+
+    bool epochFull() const;
+    Showing pickShowing();
+    QStringList pickSeats(const Showing& showing, int count);
+    int pickClient();
+    int showingIndex(const Showing& showing) const;
+    void mix(quint64 value);
+    void mix(const char* text);
+
+    Options m_options;
+    QVector<QString> m_clientNames;
+    QVector<QString> m_seatIds;     ///< "A1" up to the largest hall
+
+    // Scheduler state, guarded by m_mutex
+    QMutex m_mutex;
+    QWaitCondition m_batonMoved;    ///< Lanes wait for their turn
+    QWaitCondition m_stateChanged;  ///< run() waits for the end of the run
+    int m_current = 0;              ///< Lane holding the baton
+    bool m_finished = false;        ///< Every lane retired
+    QAtomicInteger<int> m_stopped;  ///< Failure or deadlock: lanes run free and exit
+    QAtomicInteger<quint64> m_steps; ///< Progress counter, also read by the watchdog
+
+    // Simulation state, touched only by the baton holder
+    QRandomGenerator m_random;
+    QVector<QThread*> m_lanes;
+    QVector<bool> m_laneAlive;
+    QVector<bool> m_laneBusy;       ///< Lane is inside a client operation
+    int m_aliveLanes = 0;
+    QVector<bool> m_clientBusy;
+    QVector<ClientState> m_clients;
+    QVector<int> m_capacities;      ///< Current capacity per theater
+    QVector<QVector<bool>> m_sold;  ///< Sold seats per showing
+    QVector<int> m_releases;        ///< Cancellations per showing
+    int m_soldTotal = 0;
+    int m_promotedBookings = 0;     ///< Waitlist bookings in this epoch
+    int m_cancelledBookings = 0;    ///< Cancellations in this epoch
+    int m_waitlistSerial = 0;       ///< Waitlist customers created
+    Showing m_lastReserved{0, 0};   ///< Showing of the last seatsReserved()
+    QStringList m_lastReservedSeats; ///< Seats of the last seatsReserved()
+    int m_started = 0;              ///< Operations begun
+    int m_inFlight = 0;             ///< Operations begun and not finished
+    int m_epochOperations = 0;      ///< Operations begun in this epoch
+    bool m_draining = false;        ///< Epoch full: start nothing until quiescent
+    BookingService* m_service = nullptr;
+    TrailEntry m_trail[TRAIL_LENGTH] = {};
+    Report m_report;
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Plain description of a catalog: movies, halls and showings
+ *
+ * Produced by CatalogLoader and consumed by BookingService::loadCatalog().
+ * A hall's layout is its seat count; seats are named "A1" to "A<capacity>".
+ */
+struct CatalogData {
+    /**
+     * @brief One movie
+     */
+    struct MovieEntry {
+        int id;                     ///< Unique movie ID
+        QString title;              ///< Movie title
+        int duration;               ///< Duration in minutes
+        QString genre;              ///< Genre
+    };
+
+    /**
+     * @brief One hall and its layout
+     */
+    struct TheaterEntry {
+        int id;                     ///< Unique theater ID
+        QString name;               ///< Hall name
+        int capacity;               ///< Number of seats
+        int numaNode = -1;          ///< NUMA node for the hall's showings, -1 for no preference
+    };
+
+    /**
+     * @brief One movie scheduled in one hall
+     */
+    struct ShowingEntry {
+        int theaterId;              ///< Hall showing the movie
+        int movieId;                ///< Movie being shown
+    };
+
+    /// Largest supported hall (seat indices are stored in 16 bits)
+    static constexpr int MAX_CAPACITY = 65535;
+
+    QVector<MovieEntry> movies;
+    QVector<TheaterEntry> theaters;
+    QVector<ShowingEntry> showings;
+
+    /**
+     * @brief Checks IDs are unique and showings refer to known entries
+     * @param error Receives the first problem found, may be nullptr
+     * @return true if the catalog can be loaded
+     */
+    bool validate(QString* error = nullptr) const;
+};
+
+/**
+ * @brief Reads catalogs from JSON or CSV files
+ *
+ * JSON: an object with "movies" ({id, title, duration, genre}),
+ * "theaters" ({id, name, capacity, optional numaNode}) and "showings"
+ * ({theaterId, movieId}) arrays.
+ *
+ * CSV: one record per line, the first field naming the record type:
+ * @code
+ * movie,1,"Dune: Part Two",166,Sci-Fi
+ * theater,1,IMAX Hall,120
+ * theater,2,VIP Hall,40,1
+ * showing,1,1
+ * @endcode
+ * A fifth theater field pins the hall's showings to that NUMA node.
+ * Fields may be double-quoted; blank lines and lines starting with '#'
+ * are ignored.
+ */
+class CatalogLoader {
+public:
+    /**
+     * @brief Loads and validates a catalog file (format chosen by suffix)
+     * @param path Path to a .json or .csv file
+     * @param catalog Receives the catalog
+     * @param error Receives the failure reason, may be nullptr
+     * @return true if the file was read and is valid
+     */
+    static bool loadFile(const QString& path, CatalogData& catalog, QString* error = nullptr);
+
+    /**
+     * @brief Parses a JSON catalog
+     * @param data File contents
+     * @param catalog Receives the catalog
+     * @param error Receives the failure reason, may be nullptr
+     * @return true if the document is well-formed
+     */
+    static bool parseJson(const QByteArray& data, CatalogData& catalog, QString* error = nullptr);
+
+    /**
+     * @brief Parses a CSV catalog
+     * @param data File contents
+     * @param catalog Receives the catalog
+     * @param error Receives the failure reason, may be nullptr
+     * @return true if every line is well-formed
+     */
+    static bool parseCsv(const QByteArray& data, CatalogData& catalog, QString* error = nullptr);
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @brief Thread-safe intern table of customer identifiers
+ *
+ * Maps every distinct customer identifier to a dense 32-bit handle
+ * (0, 1, 2, ...). Bookings and indexes store the handle, so matching a
+ * customer is an integer compare, and every copy of the identifier
+ * handed out shares the single interned string.
+ *
+ * Lookups of known customers only take a shared read lock; the write
+ * lock is taken the first time a customer is seen.
+ */
+class CustomerRegistry {
+public:
+    /// Handle returned for customers that were never interned
+    static constexpr quint32 INVALID_HANDLE = 0xFFFFFFFFu;
+
+    /**
+     * @brief Gets the handle of a customer, interning it if new
+     * @param customerId Customer identifier
+     * @return Dense handle
+     */
+    quint32 intern(const QString& customerId);
+
+    /**
+     * @brief Looks up a customer without interning it
+     * @param customerId Customer identifier
+     * @return Handle, or INVALID_HANDLE if the customer is unknown
+     */
+    quint32 find(const QString& customerId) const;
+
+    /**
+     * @brief Resolves a handle to the interned identifier
+     * @param handle Handle returned by intern()
+     * @return Shared copy of the identifier, or an empty string
+     */
+    QString name(quint32 handle) const;
+
+    /**
+     * @brief Gets the number of interned customers
+     * @return Handle count
+     */
+    int size() const;
+
+    /**
+     * @brief Estimates the heap memory held by the table
+     * @return Bytes used by interned strings and index structures
+     */
+    qint64 memoryUsage() const;
+
+private:
+    mutable QReadWriteLock m_lock;          ///< Guards both members
+    QHash<QString, quint32> m_handles;      ///< Identifier -> handle
+    QVector<QString> m_names;               ///< Handle -> identifier
+};
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QQueue>
+#include <QString>
+#include <QWaitCondition>
+#include <QtGlobal>
+
+/**
+ * @brief Bounded, time-expiring table of idempotency keys
+ *
+ * Remembers the outcome of requests that carried an idempotency key, so
+ * a retried request gets the original result instead of running again.
+ * Each key is bound to a fingerprint of the request it first arrived
+ * with; reusing a key for a different request is reported as a mismatch.
+ *
+ * Only successful outcomes are kept. A failed attempt releases its key,
+ * so a retry after e.g. a full waiting room runs again.
+ *
+ * The table is split into independently locked shards. Entries expire
+ * after ttlMs(); when a shard is full its oldest entry is evicted.
+ *
+ * @note Thread-safe.
+ */
+class IdempotencyTable {
+public:
+    /// Default number of keys remembered
+    static constexpr int DEFAULT_CAPACITY = 65536;
+
+    /// Default time a key is remembered
+    static constexpr qint64 DEFAULT_TTL_MS = 10 * 60 * 1000;
+
+    /// Number of independently locked shards
+    static constexpr int SHARD_COUNT = 16;
+
+    /**
+     * @brief Outcome of begin()
+     */
+    enum class Status {
+        Started,    ///< New key: run the request, then call finish() or abandon()
+        Replayed,   ///< Key already succeeded; bookingId holds the original result
+        Mismatch    ///< Key was first used for a different request
+    };
+
+    /**
+     * @brief Constructs an empty table
+     * @param capacity Maximum keys remembered (split across shards)
+     * @param ttlMs Time after which a key is forgotten
+     */
+    explicit IdempotencyTable(int capacity = DEFAULT_CAPACITY, qint64 ttlMs = DEFAULT_TTL_MS);
+
+    // Prevent copying (owns locks)
+    IdempotencyTable(const IdempotencyTable&) = delete;
+    IdempotencyTable& operator=(const IdempotencyTable&) = delete;
+
+    /**
+     * @brief Looks up a key, claiming it if unknown
+     *
+     * If the same key is still being processed by another caller, waits
+     * for that caller to finish or abandon it.
+     *
+     * @param key Idempotency key supplied by the client
+     * @param fingerprint Digest of the request parameters
+     * @param bookingId Receives the original booking ID when replayed
+     * @return What the caller should do
+     */
+    Status begin(const QString& key, const QByteArray& fingerprint, int& bookingId);
+
+    /**
+     * @brief Records the successful outcome of a started key
+     * @param key Key passed to begin()
+     * @param bookingId Booking created by the request
+     */
+    void finish(const QString& key, int bookingId);
+
+    /**
+     * @brief Releases a started key after the request failed
+     * @param key Key passed to begin()
+     */
+    void abandon(const QString& key);
+
+    /**
+     * @brief Counts remembered keys, including ones in progress
+     * @return Keys in the table
+     */
+    int size() const;
+
+    /**
+     * @brief Gets the time keys are remembered
+     * @return Expiry in milliseconds
+     */
+    qint64 ttlMs() const { return m_ttlMs; }
+
+private:
+    struct Entry {
+        QByteArray fingerprint;     ///< Request the key was first used for
+        int bookingId = 0;          ///< Original result, once done
+        bool done = false;          ///< false while the first attempt runs
+        qint64 expiresAtMs = 0;     ///< Expiry, set when done
+        quint64 serial = 0;         ///< Matches the entry's slot in Shard::order
+    };
+
+    /**
+     * @brief Queue position of an entry
+     *
+     * A key that is abandoned or expires and is then begun again gets a
+     * new slot; its old slot no longer matches the entry's serial and is
+     * skipped.
+     */
+    struct Slot {
+        QString key;
+        quint64 serial = 0;
+    };
+
+    struct Shard {
+        mutable QMutex mutex;
+        QWaitCondition settled;     ///< Signalled by finish() and abandon()
+        QHash<QString, Entry> entries;
+        QQueue<Slot> order;         ///< Entries in insertion order, for eviction
+        quint64 nextSerial = 0;
+    };
+
+    /**
+     * @brief Picks the shard of a key
+     */
+    Shard& shardFor(const QString& key);
+
+    /**
+     * @brief Drops expired keys and makes room for one more
+     * @note Caller must hold the shard mutex
+     */
+    void makeRoom(Shard& shard, qint64 nowMs);
+
+    Shard m_shards[SHARD_COUNT];
+    int m_shardCapacity;            ///< Keys per shard
+    qint64 m_ttlMs;
+    QElapsedTimer m_clock;          ///< Monotonic time base for expiry
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <QByteArray>
+#include <QStringView>
+
+/**
+ * @brief Appends text as a JSON string literal
+ *
+ * Quotes, backslashes and control characters are escaped; everything
+ * else is copied as UTF-8.
+ *
+ * @param out Buffer to append to
+ * @param text Text to quote
+ */
+void appendJsonString(QByteArray& out, QStringView text);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <QString>
+#include <cstddef>
+
+/**
+ * @brief Cache-line-aligned and NUMA-node-bound allocations
+ *
+ * Per-showing state is allocated through here so that no two showings
+ * share a cache line. A block requested for a node is rounded up to
+ * whole pages and bound to that node (Linux mbind); elsewhere, or when
+ * the kernel refuses, the block is still allocated and simply follows
+ * the default (first-touch) placement.
+ */
+class NumaMemory {
+public:
+    /// Line size assumed for padding (x86-64 and most ARM cores)
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+    /**
+     * @brief Number of NUMA nodes on this machine
+     * @return Node count, 1 if the system does not report any
+     */
+    static int nodeCount();
+
+    /**
+     * @brief Allocates an aligned block, optionally bound to a NUMA node
+     * @param size Bytes needed
+     * @param alignment Alignment (a power of two)
+     * @param node Node to bind to, -1 for no binding
+     * @param error Receives the reason if binding failed, may be nullptr
+     * @return Uninitialized block; never null (throws std::bad_alloc)
+     *
+     * Binding failures are not fatal: the block is returned unbound.
+     */
+    static void* allocate(std::size_t size, std::size_t alignment, int node,
+                          QString* error = nullptr);
+
+    /**
+     * @brief Frees a block from allocate()
+     * @param memory Block, may be nullptr
+     * @param alignment Alignment passed to allocate()
+     * @param node Node passed to allocate()
+     */
+    static void release(void* memory, std::size_t alignment, int node);
+
+private:
+    /**
+     * @brief Alignment actually used for a request
+     */
+    static std::size_t effectiveAlignment(std::size_t alignment, int node);
+};
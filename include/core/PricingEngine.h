@@ -0,0 +1,127 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @brief Seat pricing by seat class, occupancy and time of day
+ *
+ * Seat classes and adjustment rules are compiled once, at construction,
+ * into a flat table indexed by (seat class, occupancy band, hour). The
+ * bands start at the rules' occupancy thresholds, so every occupancy
+ * percentage is priced exactly as the rules say. Pricing a seat is then
+ * a table lookup; no rule is evaluated on the reservation path.
+ *
+ * Seat classes are defined relative to the hall's capacity, so one
+ * engine prices halls of any size.
+ *
+ * Prices are integer amounts in cents.
+ *
+ * @note Immutable after construction and therefore thread-safe.
+ */
+class PricingEngine {
+public:
+    /**
+     * @brief Seat class covering a contiguous share of a hall's seats
+     *
+     * A seat belongs to the last class whose @c fromPercent is not after
+     * it, so classes must be listed in ascending @c fromPercent order.
+     */
+    struct SeatClass {
+        QString name;               ///< Display name, e.g. "Premium"
+        int fromPercent;            ///< Where the class starts, in percent of the seats (0 for the first)
+        int basePrice;              ///< Base price in cents
+    };
+
+    /**
+     * @brief Percentage adjustment applied when all conditions match
+     *
+     * Matching rules are applied in order, each multiplying the price.
+     */
+    struct Rule {
+        int seatClass = -1;         ///< Index into the seat classes, -1 for any
+        int minOccupancy = 0;       ///< Minimum occupancy in percent (0-100)
+        int fromHour = 0;           ///< First hour of day the rule applies (0-23)
+        int toHour = 24;            ///< Hour of day the rule stops applying (1-24)
+        int adjustPercent = 0;      ///< +25 raises the price by 25%, -10 lowers it by 10%
+    };
+
+    /**
+     * @brief Compiles seat classes and rules into the price table
+     * @param seatClasses Seat classes in ascending fromPercent order (at least one)
+     * @param rules Adjustment rules
+     */
+    PricingEngine(const QVector<SeatClass>& seatClasses, const QVector<Rule>& rules);
+
+    /**
+     * @brief Creates the default pricing used by BookingService
+     *
+     * Standard seats, premium seats in the last 30% of the hall, a
+     * surcharge for evening showings and surcharges as showings fill up.
+     *
+     * @return Default pricing engine
+     */
+    static PricingEngine defaultPricing();
+
+    /**
+     * @brief Gets the price of one seat
+     * @param seatIndex Zero-based seat index
+     * @param capacity Number of seats in the hall
+     * @param occupancyPercent Occupancy of the showing in percent (0-100)
+     * @param hour Hour of day (0-23)
+     * @return Price in cents
+     */
+    int priceOf(int seatIndex, int capacity, int occupancyPercent, int hour) const
+    {
+        return m_table[tableIndex(seatClassOf(seatIndex, capacity), occupancyPercent, hour)];
+    }
+
+    /**
+     * @brief Prices every seat of a hall in one pass
+     * @param capacity Number of seats
+     * @param occupancyPercent Occupancy of the showing in percent (0-100)
+     * @param hour Hour of day (0-23)
+     * @return Price in cents per seat index
+     */
+    QVector<int> priceAll(int capacity, int occupancyPercent, int hour) const;
+
+    /**
+     * @brief Gets the seat class of a seat
+     * @param seatIndex Zero-based seat index
+     * @param capacity Number of seats in the hall
+     * @return Index into the seat classes
+     */
+    int seatClassOf(int seatIndex, int capacity) const;
+
+    /**
+     * @brief Gets the configured seat classes
+     * @return Seat classes in ascending fromPercent order
+     */
+    const QVector<SeatClass>& seatClasses() const { return m_seatClasses; }
+
+private:
+    static constexpr int HOURS = 24;
+
+    /**
+     * @brief Tells whether a seat lies in or after a class's share of the hall
+     */
+    static bool startsClass(int seatIndex, int capacity, const SeatClass& seatClass)
+    {
+        return qint64(seatIndex) * 100 >= qint64(seatClass.fromPercent) * capacity;
+    }
+
+    /**
+     * @brief Computes the flat table position of a price
+     */
+    int tableIndex(int seatClass, int occupancyPercent, int hour) const
+    {
+        const int band = m_occupancyBands[qBound(0, occupancyPercent, 100)];
+        return (seatClass * m_bandCount + band) * HOURS + qBound(0, hour, HOURS - 1);
+    }
+
+    QVector<SeatClass> m_seatClasses;   ///< Seat classes, ascending fromPercent
+    QVector<int> m_occupancyBands;      ///< Occupancy percent (0-100) -> band
+    int m_bandCount = 1;                ///< Distinct rule thresholds, plus 0
+    QVector<int> m_table;               ///< Compiled prices [class][band][hour]
+};
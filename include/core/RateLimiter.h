@@ -0,0 +1,215 @@
+#pragma once
+
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+#include <QtGlobal>
+
+/**
+ * @brief Request rate limits and seat quotas for reservations
+ *
+ * Three checks, each optional:
+ * - a token bucket per customer (requests per second, with a burst),
+ * - a token bucket per showing, so one premiere cannot starve the rest,
+ * - a cap on the seats one customer holds in one showing.
+ *
+ * A request spends one token from each bucket whether or not it later
+ * succeeds; its seats count against the quota from admission and are
+ * given back with release() if the request fails. Buckets refill continuously, and a bucket
+ * that has refilled completely is indistinguishable from a new one, so
+ * idle entries are dropped when a shard grows past its capacity.
+ *
+ * The table is split into independently locked shards and a check
+ * takes one shard lock at a time. With every limit off, admit() is a
+ * single atomic load.
+ *
+ * @note Thread-safe.
+ */
+class RateLimiter {
+public:
+    /// Default number of buckets kept before idle ones are swept
+    static constexpr int DEFAULT_CAPACITY = 65536;
+
+    /// Number of independently locked shards
+    static constexpr int SHARD_COUNT = 16;
+
+    /**
+     * @brief Limit settings; zero turns a limit off
+     */
+    struct Limits {
+        double customerRate = 0;    ///< Requests per second per customer
+        int customerBurst = 0;      ///< Requests a customer may make at once (default: one second's worth)
+        double showingRate = 0;     ///< Requests per second per showing
+        int showingBurst = 0;       ///< Requests a showing accepts at once (default: one second's worth)
+        int maxSeatsPerCustomer = 0; ///< Seats one customer may hold in one showing
+    };
+
+    /**
+     * @brief Outcome of admit()
+     */
+    enum class Status {
+        Allowed,                    ///< Go ahead; release() the seats if the request fails
+        CustomerRateLimited,        ///< Customer is over their request rate
+        ShowingRateLimited,         ///< Showing is over its request rate
+        QuotaExceeded               ///< Customer would hold too many seats in the showing
+    };
+
+    /**
+     * @brief Seats an admitted request counts against a quota
+     *
+     * Kept with the booking or waitlist entry and handed back to
+     * release(), so only seats that were actually counted are returned,
+     * and only to the quota that counted them.
+     */
+    struct QuotaHold {
+        int seats = 0;              ///< Seats counted, 0 if no quota was set
+        quint32 epoch = 0;          ///< Quota period that counted them
+    };
+
+    /**
+     * @brief Result of admit()
+     */
+    struct Decision {
+        Status status = Status::Allowed; ///< Outcome
+        qint64 retryAfterMs = 0;    ///< Rate limited: time until a token is available
+        int seatsLeft = -1;         ///< QuotaExceeded: seats the customer may still take
+        QuotaHold hold;             ///< Allowed: seats counted, for release()
+    };
+
+    /**
+     * @brief Constructs a limiter with every limit off
+     * @param capacity Buckets kept before idle ones are swept (split across shards)
+     */
+    explicit RateLimiter(int capacity = DEFAULT_CAPACITY);
+
+    // Prevent copying (owns locks)
+    RateLimiter(const RateLimiter&) = delete;
+    RateLimiter& operator=(const RateLimiter&) = delete;
+
+    /**
+     * @brief Replaces the limits
+     *
+     * Existing buckets keep their tokens (capped at the new burst).
+     * Seat counts are kept only while a quota is set; turning the quota
+     * off starts a new period, and holds from earlier ones are ignored.
+     *
+     * @param limits New limits
+     */
+    void setLimits(const Limits& limits);
+
+    /**
+     * @brief Gets the current limits
+     * @return Limits, with bursts filled in
+     */
+    Limits limits() const;
+
+    /**
+     * @brief Checks a reservation request against the limits
+     *
+     * On Allowed, @p seatCount seats are held against the customer's
+     * quota for the showing, as recorded in Decision::hold.
+     *
+     * @param customer Customer name
+     * @param theaterId Theater of the showing
+     * @param movieId Movie of the showing
+     * @param seatCount Seats requested
+     * @return Decision
+     */
+    Decision admit(const QString& customer, int theaterId, int movieId, int seatCount);
+
+    /**
+     * @brief Returns seats to a customer's quota
+     *
+     * Called when an admitted request fails, or when booked seats are
+     * given back. Seats admitted while no quota was set, or counted by
+     * an earlier quota period, are not returned.
+     *
+     * @param customer Customer name passed to admit()
+     * @param theaterId Theater of the showing
+     * @param movieId Movie of the showing
+     * @param hold Hold from the admit() decision
+     */
+    void release(const QString& customer, int theaterId, int movieId, const QuotaHold& hold);
+
+    /**
+     * @brief Gets the seats counted against a customer's quota
+     * @param customer Customer name
+     * @param theaterId Theater of the showing
+     * @param movieId Movie of the showing
+     * @return Seats held, 0 when no quota is set
+     */
+    int seatsHeld(const QString& customer, int theaterId, int movieId) const;
+
+private:
+    struct Bucket {
+        double tokens = 0;          ///< Tokens left at updatedNs
+        qint64 updatedNs = 0;       ///< Last refill
+    };
+
+    struct QuotaKey {
+        QString customer;
+        int theaterId;
+        int movieId;
+
+        bool operator==(const QuotaKey& other) const
+        {
+            return theaterId == other.theaterId && movieId == other.movieId
+                   && customer == other.customer;
+        }
+
+        friend size_t qHash(const QuotaKey& key, size_t seed = 0)
+        {
+            return qHash(key.customer, seed) ^ (size_t(key.theaterId) * 31 + size_t(key.movieId));
+        }
+    };
+
+    struct Shard {
+        mutable QMutex mutex;
+        Limits limits;              ///< Copy of the limits, read under the shard lock
+        QHash<QString, Bucket> customers;
+        QHash<QPair<int, int>, Bucket> showings;
+        QHash<QuotaKey, int> seats; ///< Seats held per customer and showing
+        quint32 quotaEpoch = 0;     ///< Bumped whenever the seat counts are dropped
+        int sweepAt = 0;            ///< Bucket count that triggers the next sweep
+    };
+
+    /**
+     * @brief Takes one token from a bucket, creating it full if new
+     * @param shard Shard owning the bucket table
+     * @param buckets Bucket table of the shard
+     * @param key Bucket key
+     * @param rate Tokens per second
+     * @param burst Bucket size
+     * @param nowNs Current time
+     * @param retryAfterMs Receives the wait for a token on failure
+     * @return true if a token was taken
+     * @note Caller must hold the shard mutex
+     */
+    template<typename Key>
+    bool takeToken(Shard& shard, QHash<Key, Bucket>& buckets, const Key& key, double rate,
+                   int burst, qint64 nowNs, qint64& retryAfterMs);
+
+    /**
+     * @brief Drops buckets that have refilled completely
+     * @note Caller must hold the shard mutex
+     */
+    void sweep(Shard& shard, qint64 nowNs);
+
+    /**
+     * @brief Picks the shard of a customer's bucket and quotas
+     */
+    static int shardOf(const QString& customer);
+
+    /**
+     * @brief Picks the shard of a showing's bucket
+     */
+    static int shardOf(int theaterId, int movieId);
+
+    Shard m_shards[SHARD_COUNT];
+    int m_shardCapacity;            ///< Buckets per shard before sweeping
+    QAtomicInteger<int> m_enabled;  ///< Non-zero while any limit is set
+    QElapsedTimer m_clock;          ///< Monotonic time base for refills
+};
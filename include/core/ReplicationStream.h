@@ -0,0 +1,269 @@
+#pragma once
+
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QWaitCondition>
+#include <QAtomicInteger>
+#include <QtGlobal>
+#include <functional>
+
+class QThread;
+
+/**
+ * @brief One committed booking or cancellation as shipped from a primary
+ * to its replicas
+ *
+ * Sequence numbers are 1-based positions in the primary's log of bookings
+ * and cancellations, so a replica that has applied N records resumes from
+ * sequence N + 1 on any primary holding the same log, including a
+ * promoted replica.
+ *
+ * A cancellation carries the booking's ID, showing and seats; the other
+ * fields are left empty.
+ */
+struct ReplicationRecord {
+    /**
+     * @brief What the record commits
+     */
+    enum class Kind : quint8 {
+        Booking,        ///< A new booking
+        Cancellation    ///< An earlier booking was cancelled
+    };
+
+    quint64 sequence = 0;       ///< Position in the log (1-based)
+    qint64 committedAtMs = 0;   ///< Primary clock when the record was published
+    int bookingId = 0;
+    int theaterId = 0;
+    int movieId = 0;
+    QString customerId;
+    QStringList seatIds;
+    QVector<int> seatPrices;    ///< Cents per seat, parallel to seatIds
+    qint64 bookedAtMs = 0;      ///< Booking time, ms since epoch
+    Kind kind = Kind::Booking;
+
+    /**
+     * @brief Serializes the record into a frame payload
+     * @return Encoded bytes
+     */
+    QByteArray encode() const;
+
+    /**
+     * @brief Parses a payload produced by encode()
+     * @param payload Encoded bytes
+     * @param record Receives the record
+     * @return true if the payload was complete
+     */
+    static bool decode(const QByteArray& payload, ReplicationRecord& record);
+};
+
+/**
+ * @brief Primary side of booking replication over a Unix domain socket
+ *
+ * Keeps the committed booking log as encoded frames. Every connected
+ * replica gets its own sender thread that streams frames from the
+ * sequence the replica asked for, then follows the log as new records
+ * are published. Idle connections receive heartbeats carrying the log
+ * head so replicas can tell how far behind they are.
+ *
+ * Only the newest frames are kept (see the constructor). A replica that
+ * asks for an older sequence, or falls so far behind that its next frame
+ * was dropped, is disconnected; it has to be re-seeded from a copy of the
+ * primary's state before it can follow the log again.
+ *
+ * @note Unix only; listen() fails on other platforms.
+ */
+class ReplicationPublisher {
+public:
+    /// Idle time after which a replica gets a heartbeat
+    static constexpr int HEARTBEAT_INTERVAL_MS = 100;
+
+    /// Frames kept for replicas by default
+    static constexpr int DEFAULT_RETAINED_FRAMES = 1 << 16;
+
+    /**
+     * @brief Creates a publisher that keeps a bounded log
+     * @param retainedFrames Newest frames kept for replicas to catch up from
+     */
+    explicit ReplicationPublisher(int retainedFrames = DEFAULT_RETAINED_FRAMES);
+
+    /**
+     * @brief Stops serving replicas (see close())
+     */
+    ~ReplicationPublisher();
+
+    // Prevent copying (owns sockets and threads)
+    ReplicationPublisher(const ReplicationPublisher&) = delete;
+    ReplicationPublisher& operator=(const ReplicationPublisher&) = delete;
+
+    /**
+     * @brief Starts accepting replicas on a socket path
+     * @param socketPath Filesystem path of the Unix socket (replaced if stale)
+     * @param error Receives the failure reason, may be nullptr
+     * @return true if listening
+     */
+    bool listen(const QString& socketPath, QString* error = nullptr);
+
+    /**
+     * @brief Appends a committed record to the log and wakes the senders
+     *
+     * Records must be published in log order; the record's sequence is
+     * overwritten with the next position.
+     *
+     * @param record Committed booking
+     * @return Sequence assigned to the record
+     */
+    quint64 publish(ReplicationRecord record);
+
+    /**
+     * @brief Moves the head of an empty log forward
+     *
+     * Used when seeding the log from an existing history whose oldest
+     * records would be dropped anyway: they keep their sequences without
+     * being encoded.
+     *
+     * @param sequence Sequence the next published record should follow
+     * @return false if records were already published
+     */
+    bool skipTo(quint64 sequence);
+
+    /**
+     * @brief Gets the sequence of the newest published record
+     * @return Log head, 0 if empty
+     */
+    quint64 headSequence() const;
+
+    /**
+     * @brief Gets the oldest sequence replicas can still start from
+     * @return First retained sequence, head + 1 if nothing is retained
+     */
+    quint64 oldestSequence() const;
+
+    /**
+     * @brief Counts currently connected replicas
+     * @return Replica connections
+     */
+    int replicaCount() const;
+
+    /**
+     * @brief Counts sender threads that have not been joined yet
+     *
+     * Senders of disconnected replicas are joined by the accept thread
+     * within a poll interval, so this settles at replicaCount().
+     *
+     * @return Live and not yet reaped sender threads
+     */
+    int senderCount() const;
+
+    /**
+     * @brief Disconnects all replicas and stops listening
+     */
+    void close();
+
+private:
+    /**
+     * @brief Accepts replica connections until close()
+     */
+    void acceptLoop();
+
+    /**
+     * @brief Streams the log to one replica until it disconnects or close()
+     */
+    void serveReplica(int socketFd);
+
+    /**
+     * @brief Joins and deletes the senders whose replica went away
+     */
+    void reapSenders();
+
+    mutable QMutex m_mutex;             ///< Guards the members below
+    QWaitCondition m_logGrown;          ///< Signalled by publish() and close()
+    QVector<QByteArray> m_frames;       ///< Retained log, index = sequence - m_firstSequence
+    quint64 m_firstSequence = 1;        ///< Sequence of m_frames[0]
+    int m_retainedFrames;
+    QVector<QThread*> m_senders;        ///< One thread per connected replica
+    QThread* m_acceptThread = nullptr;
+    QString m_socketPath;
+    int m_listenFd = -1;
+    QAtomicInt m_closing;               ///< Set by close(); polled by all threads
+    QAtomicInt m_replicaCount;
+};
+
+/**
+ * @brief Replica side of booking replication
+ *
+ * Connects to a ReplicationPublisher and hands every received record to
+ * a callback on a background thread, in sequence order. A callback that
+ * cannot apply a record returns false; the subscriber then disconnects,
+ * as it does at a gap, since every later record would be misplaced.
+ *
+ * @note Unix only; connectTo() fails on other platforms.
+ */
+class ReplicationSubscriber {
+public:
+    /// Applies one record; returns false if it could not be applied
+    using RecordHandler = std::function<bool(const ReplicationRecord&)>;
+
+    ReplicationSubscriber() = default;
+
+    /**
+     * @brief Disconnects (see disconnect())
+     */
+    ~ReplicationSubscriber();
+
+    // Prevent copying (owns a socket and a thread)
+    ReplicationSubscriber(const ReplicationSubscriber&) = delete;
+    ReplicationSubscriber& operator=(const ReplicationSubscriber&) = delete;
+
+    /**
+     * @brief Connects to a primary and starts receiving records
+     *
+     * Records must arrive without gaps from fromSequence on; the
+     * subscriber disconnects at the first one that does not, and at the
+     * first one the handler rejects.
+     *
+     * @param socketPath Socket path the primary listens on
+     * @param fromSequence First sequence wanted (1 for the whole log)
+     * @param handler Called for each record on the receiver thread
+     * @param error Receives the failure reason, may be nullptr
+     * @return true if connected
+     */
+    bool connectTo(const QString& socketPath, quint64 fromSequence, RecordHandler handler,
+                   QString* error = nullptr);
+
+    /**
+     * @brief Checks whether the stream to the primary is still open
+     * @return true until the primary goes away or disconnect() is called
+     */
+    bool isConnected() const { return m_connected.loadAcquire() != 0; }
+
+    /**
+     * @brief Gets the newest sequence the primary has announced
+     * @return Primary log head as last seen
+     */
+    quint64 primarySequence() const { return m_primarySequence.loadAcquire(); }
+
+    /**
+     * @brief Stops receiving and closes the connection
+     *
+     * Waits for the receiver thread, so the handler is not running
+     * anymore when this returns. Must not be called from the handler.
+     */
+    void disconnect();
+
+private:
+    /**
+     * @brief Reads frames until EOF or disconnect()
+     */
+    void receiveLoop();
+
+    RecordHandler m_handler;
+    quint64 m_nextSequence = 1;         ///< Sequence the next record must carry
+    QThread* m_thread = nullptr;
+    int m_socketFd = -1;
+    QAtomicInt m_connected;
+    QAtomicInt m_stopping;
+    QAtomicInteger<quint64> m_primarySequence;
+};
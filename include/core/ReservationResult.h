@@ -0,0 +1,100 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+#include <type_traits>
+
+/**
+ * @brief Outcome of a reservation attempt
+ *
+ * A fixed-size value: building one never allocates, so failed attempts
+ * (the bulk of calls during a sold-out rush) stay cheap. Callers branch
+ * on code; describe() renders the text only when someone wants to show
+ * or log it.
+ */
+struct ReservationResult {
+    /**
+     * @brief What happened
+     */
+    enum class Code : quint8 {
+        Ok,                         ///< Seats reserved
+        TheaterNotFound,            ///< No such theater
+        ShowingNotFound,            ///< Movie not showing in the theater
+        NoSeatsRequested,           ///< Empty request
+        SeatNotFound,               ///< Seat IDs unknown; seats holds request positions
+        SeatTaken,                  ///< Seats already reserved; seats holds seat indices
+        DuplicateSeat,              ///< Seats requested twice; seats holds seat indices
+        NotEnoughSeats,             ///< Fewer seats left than requested
+        SoldOut,                    ///< No seats left
+        QueueFull,                  ///< Waiting room is full
+        SharedInventoryUnavailable, ///< Shared inventory could not be claimed
+        ReadOnlyReplica,            ///< Service is a replica
+        IdempotencyMismatch,        ///< Key was first used for a different request
+        RateLimited,                ///< Customer or showing is over its request rate
+        QuotaExceeded,              ///< Customer would hold too many seats in the showing
+        BookingCancelled            ///< Key's booking was made but has been cancelled since
+    };
+
+    /// Offending seats kept per result; seatCount may be larger
+    static constexpr int MAX_SEATS = 8;
+
+    Code code = Code::Ok;           ///< Outcome
+    int theaterId = 0;              ///< Showing the outcome refers to
+    int movieId = 0;                ///< Showing the outcome refers to
+    int freeCount = -1;             ///< Free seats when decided, -1 if not looked at
+    int bookingId = 0;              ///< New (or replayed) booking on success; BookingCancelled: the cancelled one
+    int queueAhead = 0;             ///< QueueFull: callers ahead
+    qint64 estimatedWaitMs = 0;     ///< QueueFull, RateLimited: estimated wait
+    int quotaLeft = -1;             ///< QuotaExceeded: seats the customer may still take
+    int seatCount = 0;              ///< Offending seats found
+    quint16 seats[MAX_SEATS] = {};  ///< First offending seats (see Code)
+
+    /**
+     * @brief Tells whether the seats were reserved
+     * @return true for Code::Ok
+     */
+    bool ok() const { return code == Code::Ok; }
+
+    explicit operator bool() const { return ok(); }
+
+    /**
+     * @brief Marks the attempt failed with a code
+     * @param failure Failure code
+     * @return This result, for chaining
+     */
+    ReservationResult& fail(Code failure)
+    {
+        code = failure;
+        return *this;
+    }
+
+    /**
+     * @brief Records an offending seat
+     * @param seat Seat index, or request position for SeatNotFound
+     */
+    void addSeat(int seat)
+    {
+        if (seatCount < MAX_SEATS) {
+            seats[seatCount] = quint16(seat);
+        }
+        ++seatCount;
+    }
+
+    /**
+     * @brief Renders the outcome as text for users and logs
+     * @param requestedSeatIds Seat IDs of the request, to name unknown seats
+     * @return Human-readable description
+     */
+    QString describe(const QStringList& requestedSeatIds = {}) const;
+
+    /**
+     * @brief Names a code for machine-readable output, e.g. "SeatTaken"
+     * @param code Code to name
+     * @return Enumerator name (static string)
+     */
+    static const char* codeName(Code code);
+};
+
+static_assert(std::is_trivially_copyable_v<ReservationResult>,
+              "ReservationResult must stay a plain value");
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @brief Bounded ring buffer of seat changes for a single showing
+ *
+ * Every committed change to a showing's seat map bumps the showing
+ * version and records the affected seat indices here. Clients that
+ * already hold the seat map at some version can then fetch only the
+ * seats that changed since, instead of the whole map.
+ *
+ * The ring keeps at most capacity() entries; once older entries are
+ * overwritten, callers that are too far behind must fall back to a
+ * full snapshot.
+ *
+ * @note Not thread-safe; the owning BookingService guards access.
+ */
+class SeatChangeLog {
+public:
+    /// Default number of seat changes kept per showing
+    static constexpr int DEFAULT_CAPACITY = 64;
+
+    /**
+     * @brief Constructs an empty change log
+     * @param capacity Maximum number of seat changes retained
+     */
+    explicit SeatChangeLog(int capacity = DEFAULT_CAPACITY);
+
+    /**
+     * @brief Records that a seat changed in the given version
+     * @param version Showing version the change belongs to
+     * @param seatIndex Zero-based seat index within the showing
+     */
+    void record(quint64 version, int seatIndex);
+
+    /**
+     * @brief Collects seats changed after a given version
+     *
+     * @param version Version the caller already has
+     * @param seatIndices Receives the changed seat indices (deduplicated, ascending)
+     * @return false if the ring no longer covers @p version and a full
+     *         snapshot is required, true otherwise
+     */
+    bool changesSince(quint64 version, QVector<int>& seatIndices) const;
+
+    /**
+     * @brief Forgets every change, e.g. after the seat layout changed
+     * @param version Showing version from which callers get changes again;
+     *        callers holding an older version need a full snapshot
+     */
+    void reset(quint64 version);
+
+    /**
+     * @brief Gets the ring capacity
+     * @return Maximum number of seat changes retained
+     */
+    int capacity() const { return m_entries.size(); }
+
+private:
+    /**
+     * @brief Single seat change entry
+     */
+    struct Entry {
+        quint64 version;    ///< Showing version of the change
+        int seatIndex;      ///< Changed seat index
+    };
+
+    QVector<Entry> m_entries;   ///< Fixed-size ring storage
+    int m_next;                 ///< Slot the next entry is written to
+    int m_count;                ///< Number of valid entries
+    quint64 m_evictedVersion;   ///< Highest version dropped from the ring
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "core/SeatMap.h"
+#include <QByteArray>
+#include <QVector>
+
+/**
+ * @brief Pre-rendered seat chart of one hall layout, every seat free
+ *
+ * Every seat has a fixed-width cell at a known offset, so a chart for a
+ * showing is a copy of the blank chart with the taken cells patched in
+ * place; nothing is formatted per request.
+ *
+ * Text: seat IDs padded to the widest ID, ten per row; a taken seat's
+ * ID is replaced by dashes.
+ * @code
+ * A1  A2  --  A4  ...
+ * @endcode
+ * JSON: {"capacity":N,"seats":[["A1",1],["A2",1],["A3",0],...]}, where
+ * the second element is 1 if the seat is free.
+ *
+ * Immutable once built, so one template is shared by every showing in
+ * halls of the same layout.
+ */
+class SeatChartTemplate {
+public:
+    /**
+     * @brief Chart encodings
+     */
+    enum class Format {
+        Text,                       ///< Fixed-width rows for terminals
+        Json                        ///< JSON document for web clients
+    };
+
+    /// Seats per text row
+    static constexpr int SEATS_PER_ROW = 10;
+
+    /**
+     * @brief Renders the blank charts of a layout
+     * @param layout Seat map giving the capacity and seat IDs
+     */
+    explicit SeatChartTemplate(const SeatMap& layout);
+
+    /**
+     * @brief Gets the number of seats
+     * @return Capacity of the layout
+     */
+    int capacity() const { return m_textOffsets.size(); }
+
+    /**
+     * @brief Gets the chart with every seat free
+     * @param format Encoding
+     * @return Blank chart
+     */
+    const QByteArray& blank(Format format) const
+    {
+        return format == Format::Text ? m_text : m_json;
+    }
+
+    /**
+     * @brief Patches one seat cell of a chart rendered from this template
+     * @param chart Chart to patch (detached if shared)
+     * @param format Encoding of @p chart
+     * @param seatIndex Seat index
+     * @param taken New state of the seat
+     */
+    void setTaken(QByteArray& chart, Format format, int seatIndex, bool taken) const;
+
+private:
+    QByteArray m_text;              ///< Blank text chart
+    QByteArray m_json;              ///< Blank JSON chart
+    QVector<int> m_textOffsets;     ///< Seat index -> first byte of its ID in m_text
+    QVector<int> m_jsonOffsets;     ///< Seat index -> its free flag in m_json
+};
@@ -0,0 +1,301 @@
+#pragma once
+
+#include <QString>
+#include <QStringView>
+#include <QVector>
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <memory>
+
+/**
+ * @brief Reservation state of every seat in one showing
+ *
+ * Seats are addressed by zero-based index; seat IDs follow the
+ * "A1".."AN" scheme used by BookingService. Common hall sizes get a
+ * FixedSeatMap with compile-time capacity, everything else a
+ * DynamicSeatMap. Use createSeatMap() to get the right one.
+ *
+ * @note Not thread-safe; the owning BookingService guards access.
+ */
+class SeatMap {
+public:
+    virtual ~SeatMap() = default;
+
+    /**
+     * @brief Gets the number of seats
+     * @return Hall capacity
+     */
+    virtual int capacity() const = 0;
+
+    /**
+     * @brief Resolves a seat ID to its index
+     * @param seatId Seat ID such as "A7"
+     * @return Zero-based index, or -1 if the seat does not exist
+     */
+    virtual int indexOf(QStringView seatId) const = 0;
+
+    /**
+     * @brief Gets the seat ID of an index
+     * @param index Zero-based seat index
+     * @return Seat ID such as "A7"
+     */
+    virtual QString seatId(int index) const = 0;
+
+    /**
+     * @brief Checks whether a seat is reserved
+     * @param index Zero-based seat index (must be valid)
+     * @return true if the seat is taken
+     */
+    virtual bool isTaken(int index) const = 0;
+
+    /**
+     * @brief Checks whether any of the given seats is reserved
+     * @param indices Zero-based seat indices (must be valid)
+     * @return true if at least one seat is taken
+     */
+    virtual bool anyTaken(const QVector<int>& indices) const = 0;
+
+    /**
+     * @brief Marks seats reserved
+     * @param indices Zero-based seat indices (must be valid)
+     */
+    virtual void take(const QVector<int>& indices) = 0;
+
+    /**
+     * @brief Marks seats free again
+     * @param indices Zero-based seat indices (must be valid)
+     */
+    virtual void release(const QVector<int>& indices) = 0;
+
+    /**
+     * @brief Counts free seats
+     * @return Number of seats not taken
+     */
+    virtual int freeCount() const = 0;
+
+    /**
+     * @brief Lists free seats
+     * @return Indices of seats not taken, ascending
+     */
+    virtual QVector<int> freeSeats() const = 0;
+
+    /**
+     * @brief Lists free seats from a position into a caller's buffer
+     * @param from First seat index to look at
+     * @param indices Receives ascending free seat indices
+     * @param maxCount Capacity of @p indices
+     * @return Number of indices written; fewer than maxCount means no more free seats
+     */
+    virtual int freeSeatsFrom(int from, int* indices, int maxCount) const = 0;
+
+protected:
+    /**
+     * @brief Parses "A<n>" into n - 1 without allocating
+     * @param seatId Seat ID to parse
+     * @param capacity Number of seats in the hall
+     * @return Zero-based index, or -1 if malformed or out of range
+     */
+    static constexpr int parseSeatId(QStringView seatId, int capacity)
+    {
+        if (seatId.size() < 2 || seatId.size() > 6 || seatId[0] != u'A' || seatId[1] == u'0') {
+            return -1;
+        }
+
+        int number = 0;
+        for (qsizetype i = 1; i < seatId.size(); ++i) {
+            const char16_t c = seatId[i].unicode();
+            if (c < u'0' || c > u'9') {
+                return -1;
+            }
+            number = number * 10 + (c - u'0');
+        }
+
+        return number <= capacity ? number - 1 : -1;
+    }
+};
+
+/**
+ * @brief Seat map for a hall size known at compile time
+ *
+ * Storage is a std::bitset, so the map never allocates, and seat IDs
+ * come from a table generated at compile time.
+ *
+ * @tparam N Number of seats
+ */
+template <int N>
+class FixedSeatMap final : public SeatMap {
+public:
+    static_assert(N > 0 && N < 100000, "seat IDs are limited to A1..A99999");
+
+    int capacity() const override { return N; }
+
+    int indexOf(QStringView seatId) const override { return parseSeatId(seatId, N); }
+
+    QString seatId(int index) const override
+    {
+        return QString::fromLatin1(s_ids[index].data());
+    }
+
+    bool isTaken(int index) const override { return m_taken.test(index); }
+
+    bool anyTaken(const QVector<int>& indices) const override
+    {
+        for (int index : indices) {
+            if (m_taken.test(index)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void take(const QVector<int>& indices) override
+    {
+        for (int index : indices) {
+            m_taken.set(index);
+        }
+    }
+
+    void release(const QVector<int>& indices) override
+    {
+        for (int index : indices) {
+            m_taken.reset(index);
+        }
+    }
+
+    int freeCount() const override { return N - static_cast<int>(m_taken.count()); }
+
+    QVector<int> freeSeats() const override
+    {
+        QVector<int> free;
+        free.reserve(freeCount());
+        for (int i = 0; i < N; ++i) {
+            if (!m_taken.test(i)) {
+                free.append(i);
+            }
+        }
+        return free;
+    }
+
+    int freeSeatsFrom(int from, int* indices, int maxCount) const override
+    {
+        int count = 0;
+        for (int i = qMax(from, 0); i < N && count < maxCount; ++i) {
+            if (!m_taken.test(i)) {
+                indices[count++] = i;
+            }
+        }
+        return count;
+    }
+
+private:
+    /// "A" + up to five digits + terminator
+    using SeatIdText = std::array<char, 7>;
+
+    /**
+     * @brief Builds the "A1".."AN" table at compile time
+     */
+    static constexpr std::array<SeatIdText, N> makeIds()
+    {
+        std::array<SeatIdText, N> ids{};
+        for (int i = 0; i < N; ++i) {
+            char digits[5] = {};
+            int length = 0;
+            for (int number = i + 1; number > 0; number /= 10) {
+                digits[length++] = static_cast<char>('0' + number % 10);
+            }
+            ids[i][0] = 'A';
+            for (int j = 0; j < length; ++j) {
+                ids[i][j + 1] = digits[length - 1 - j];
+            }
+        }
+        return ids;
+    }
+
+    static constexpr std::array<SeatIdText, N> s_ids = makeIds();
+
+    std::bitset<N> m_taken;     ///< Set bit = seat reserved
+};
+
+/**
+ * @brief Seat map for halls without a fixed specialization
+ *
+ * The taken flags are stored right behind the object, so the map and
+ * its storage are one block of seatMapSize() bytes. Created through
+ * createSeatMap() or placeSeatMap() only.
+ */
+class DynamicSeatMap final : public SeatMap {
+public:
+    // Prevent copying (the flags live outside the object)
+    DynamicSeatMap(const DynamicSeatMap&) = delete;
+    DynamicSeatMap& operator=(const DynamicSeatMap&) = delete;
+
+    int capacity() const override { return m_capacity; }
+    int indexOf(QStringView seatId) const override;
+    QString seatId(int index) const override;
+    bool isTaken(int index) const override { return taken()[index]; }
+    bool anyTaken(const QVector<int>& indices) const override;
+    void take(const QVector<int>& indices) override;
+    void release(const QVector<int>& indices) override;
+    int freeCount() const override { return m_capacity - m_takenCount; }
+    QVector<int> freeSeats() const override;
+    int freeSeatsFrom(int from, int* indices, int maxCount) const override;
+
+private:
+    friend SeatMap* placeSeatMap(void* memory, int capacity);
+
+    /**
+     * @brief Constructs a map with every seat free
+     * @param capacity Number of seats (flags must follow the object)
+     */
+    explicit DynamicSeatMap(int capacity);
+
+    bool* taken() { return reinterpret_cast<bool*>(this + 1); }
+    const bool* taken() const { return reinterpret_cast<const bool*>(this + 1); }
+
+    int m_capacity;             ///< Number of flags behind the object
+    int m_takenCount;           ///< Number of set flags (true = seat reserved)
+};
+
+/**
+ * @brief Frees a seat map from createSeatMap()
+ */
+struct SeatMapDeleter {
+    int numaNode = -1;          ///< Node the block was allocated for
+    bool ownsBlock = true;      ///< false for maps placed in a caller's block: only destroyed
+
+    void operator()(SeatMap* seatMap) const;
+};
+
+/// Seat map owning its NumaMemory block
+using SeatMapPtr = std::unique_ptr<SeatMap, SeatMapDeleter>;
+
+/**
+ * @brief Gets the block size the seat map of a hall size needs
+ * @param capacity Number of seats
+ * @return Bytes for placeSeatMap()
+ */
+std::size_t seatMapSize(int capacity);
+
+/**
+ * @brief Constructs the seat map best suited to a hall size in a caller's block
+ *
+ * Standard layouts (20, 120, 250 and 400 seats) get a FixedSeatMap;
+ * any other size falls back to a DynamicSeatMap.
+ *
+ * @param memory Cache-line-aligned block of at least seatMapSize(capacity) bytes
+ * @param capacity Number of seats
+ * @return New, empty seat map; destroy it with ~SeatMap(), the block stays the caller's
+ */
+SeatMap* placeSeatMap(void* memory, int capacity);
+
+/**
+ * @brief Creates the seat map best suited to a hall size
+ *
+ * The map and its storage are one NumaMemory block (see placeSeatMap()).
+ *
+ * @param capacity Number of seats
+ * @param numaNode Node to bind the block to, -1 for no binding
+ * @return New, empty seat map
+ */
+SeatMapPtr createSeatMap(int capacity, int numaNode = -1);
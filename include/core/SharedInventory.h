@@ -0,0 +1,178 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @brief Seat inventory shared by booking processes on one host
+ *
+ * Lives in a named POSIX shared-memory segment. Every showing owns a
+ * block with a process-shared robust mutex, an atomic free-seat counter
+ * and one atomic bit per seat; the segment header holds the booking ID
+ * counter. Reads (isTaken(), freeCount(), nextBookingId()) are
+ * lock-free; claims take the showing's mutex.
+ *
+ * A claim is recorded as an intent before any seat bit is set. If a
+ * process dies while holding a showing's mutex, the next process to
+ * lock it rolls back the unfinished intent, so seats are never left
+ * half-claimed.
+ *
+ * Every attached process must use the same showing slots and slot capacities.
+ *
+ * @note Linux only; open() fails on other platforms.
+ */
+class SharedInventory {
+public:
+    SharedInventory() = default;
+
+    /**
+     * @brief Unmaps the segment (the segment itself stays until remove())
+     */
+    ~SharedInventory();
+
+    // Prevent copying (owns a mapping)
+    SharedInventory(const SharedInventory&) = delete;
+    SharedInventory& operator=(const SharedInventory&) = delete;
+
+    /**
+     * @brief Creates the segment, or attaches to it if it already exists
+     * @param name Segment name, e.g. "ticket-booking"
+     * @param capacities Seats per showing slot, one entry per slot
+     * @param error Receives the failure reason, may be nullptr
+     * @return true if the inventory is usable
+     */
+    bool open(const QString& name, const QVector<int>& capacities, QString* error = nullptr);
+
+    /**
+     * @brief Creates or attaches to a segment whose slots all have one capacity
+     * @param name Segment name, e.g. "ticket-booking"
+     * @param showingCount Number of showing slots
+     * @param capacity Seats per showing slot
+     * @param error Receives the failure reason, may be nullptr
+     * @return true if the inventory is usable
+     */
+    bool open(const QString& name, int showingCount, int capacity, QString* error = nullptr)
+    {
+        return open(name, QVector<int>(qMax(showingCount, 0), capacity), error);
+    }
+
+    /**
+     * @brief Removes a segment name from the system
+     * @param name Segment name passed to open()
+     * @return true if the segment existed and was removed
+     */
+    static bool remove(const QString& name);
+
+    /**
+     * @brief Checks whether a segment is mapped
+     * @return true after a successful open()
+     */
+    bool isOpen() const { return m_base != nullptr; }
+
+    /**
+     * @brief Gets the number of showing slots
+     * @return Showing slot count
+     */
+    int showingCount() const;
+
+    /**
+     * @brief Gets the seats of a showing slot
+     * @param showing Showing slot
+     * @return Seat capacity
+     */
+    int capacity(int showing) const;
+
+    /**
+     * @brief Checks whether a seat is claimed by any process (lock-free)
+     * @param showing Showing slot
+     * @param seatIndex Zero-based seat index
+     * @return true if the seat is taken
+     */
+    bool isTaken(int showing, int seatIndex) const;
+
+    /**
+     * @brief Counts free seats of a showing (lock-free)
+     * @param showing Showing slot
+     * @return Seats not claimed by any process
+     */
+    int freeCount(int showing) const;
+
+    /**
+     * @brief Allocates a booking ID unique across all processes (lock-free)
+     * @return New booking ID, starting at 1
+     */
+    int nextBookingId();
+
+    /**
+     * @brief Locks a showing and claims seats, pending commit
+     *
+     * On success the showing stays locked until commitClaim() or
+     * abortClaim() is called from the same thread. On failure nothing
+     * is claimed and the showing is unlocked.
+     *
+     * @param showing Showing slot
+     * @param seatIndices Seats to claim
+     * @param conflictingSeat Receives the first seat already taken, may be nullptr
+     * @return true if every seat was free and is now claimed
+     */
+    bool beginClaim(int showing, const QVector<int>& seatIndices, int* conflictingSeat = nullptr);
+
+    /**
+     * @brief Makes a pending claim permanent and unlocks the showing
+     * @param showing Showing slot passed to beginClaim()
+     */
+    void commitClaim(int showing);
+
+    /**
+     * @brief Releases the seats of a pending claim and unlocks the showing
+     * @param showing Showing slot passed to beginClaim()
+     */
+    void abortClaim(int showing);
+
+    /**
+     * @brief Gives committed seats back, e.g. after a cancellation
+     *
+     * Takes the showing's mutex; seats that are not taken are ignored.
+     *
+     * @param showing Showing slot
+     * @param seatIndices Seats to free
+     * @return false if the showing could not be locked
+     */
+    bool release(int showing, const QVector<int>& seatIndices);
+
+    /**
+     * @brief Gets how many claims were rolled back after a process died
+     * @return Recovered claims since the segment was created
+     */
+    int recoveredClaims() const;
+
+private:
+    struct Header;
+    struct ShowingBlock;
+
+    /**
+     * @brief Gets the block of a showing slot
+     */
+    ShowingBlock* block(int showing) const;
+
+    /**
+     * @brief Locks a showing, rolling back the intent of a dead owner
+     * @return false if the mutex is unusable
+     */
+    bool lockShowing(ShowingBlock* showingBlock);
+
+    /**
+     * @brief Clears the seats of a showing's unfinished intent
+     */
+    void rollBackIntent(ShowingBlock* showingBlock);
+
+    /**
+     * @brief Recomputes a showing's free counter from its seat bits
+     */
+    void recountFree(ShowingBlock* showingBlock);
+
+    void* m_base = nullptr;         ///< Start of the mapping
+    qint64 m_size = 0;              ///< Mapping size in bytes
+    qint64 m_blockSize = 0;         ///< Bytes per showing block
+};
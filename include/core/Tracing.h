@@ -0,0 +1,125 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+
+/**
+ * @brief Collects timed spans and exports them as Chrome trace events
+ *
+ * Each thread records into its own fixed-size ring buffer: a span is a
+ * few relaxed stores and one release store, with no lock and no
+ * allocation after the thread's first span. When a buffer is full the
+ * oldest spans are overwritten. exportChromeTrace() gathers every
+ * thread's retained spans into the trace-event JSON format that
+ * Perfetto (ui.perfetto.dev) and chrome://tracing open directly.
+ *
+ * The booking pipeline records spans through the TRACE_* macros below,
+ * which expand to nothing unless the library is built with
+ * -DENABLE_TRACING=ON (defining BOOKING_TRACING).
+ *
+ * @note Thread-safe.
+ */
+class TraceRecorder {
+public:
+    /// Spans kept per thread (power of two)
+    static constexpr int EVENTS_PER_THREAD = 8192;
+
+    /**
+     * @brief Tells whether the pipeline's spans were compiled in
+     * @return true if built with BOOKING_TRACING
+     */
+    static constexpr bool isCompiledIn()
+    {
+#ifdef BOOKING_TRACING
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Reads the trace clock
+     * @return Monotonic time in nanoseconds
+     */
+    static qint64 nowNs();
+
+    /**
+     * @brief Records a finished span in the calling thread's buffer
+     * @param name Span name; must outlive the recorder (a string literal)
+     * @param startNs Start time from nowNs()
+     * @param endNs End time from nowNs()
+     */
+    static void record(const char* name, qint64 startNs, qint64 endNs);
+
+    /**
+     * @brief Renders every retained span as Chrome trace-event JSON
+     *
+     * Spans being overwritten while the export runs are left out.
+     *
+     * @return {"traceEvents":[...]} document
+     */
+    static QByteArray exportChromeTrace();
+
+    /**
+     * @brief Writes exportChromeTrace() to a file
+     * @param path Output file
+     * @param error Receives the reason on failure (optional)
+     * @return true if the file was written
+     */
+    static bool writeChromeTrace(const QString& path, QString* error = nullptr);
+};
+
+/**
+ * @brief Records the time from construction to end() or destruction
+ *
+ * Prefer the TRACE_* macros, which compile out; use this class directly
+ * only where a span must always be recorded.
+ */
+class TraceSpan {
+public:
+    /**
+     * @brief Starts a span
+     * @param name Span name; must outlive the recorder (a string literal)
+     */
+    explicit TraceSpan(const char* name)
+        : m_name(name)
+        , m_startNs(TraceRecorder::nowNs())
+    {
+    }
+
+    ~TraceSpan() { end(); }
+
+    Q_DISABLE_COPY(TraceSpan)
+
+    /**
+     * @brief Ends the span early; later calls do nothing
+     */
+    void end()
+    {
+        if (m_name) {
+            TraceRecorder::record(m_name, m_startNs, TraceRecorder::nowNs());
+            m_name = nullptr;
+        }
+    }
+
+private:
+    const char* m_name;             ///< Span name, null once recorded
+    qint64 m_startNs;               ///< Start time
+};
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+
+#ifdef BOOKING_TRACING
+/// Records a span covering the rest of the enclosing scope
+#define TRACE_SCOPE(name) TraceSpan TRACE_CONCAT(traceSpan_, __LINE__)(name)
+/// Starts a named span that TRACE_END() can close before the scope ends
+#define TRACE_BEGIN(span, name) TraceSpan span(name)
+/// Closes a span started with TRACE_BEGIN()
+#define TRACE_END(span) span.end()
+#else
+#define TRACE_SCOPE(name) static_cast<void>(0)
+#define TRACE_BEGIN(span, name) static_cast<void>(0)
+#define TRACE_END(span) static_cast<void>(0)
+#endif
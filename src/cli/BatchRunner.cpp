@@ -0,0 +1,366 @@
+#include "cli/BatchRunner.h"
+#include "core/JsonText.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace {
+
+/**
+ * @brief Starts a result line: {"line":N,"command":"...","ok":...
+ */
+void openResult(QByteArray& out, int lineNumber, const QString& command, bool ok)
+{
+    out += "{\"line\":";
+    out += QByteArray::number(lineNumber);
+    out += ",\"command\":";
+    appendJsonString(out, command);
+    out += ok ? ",\"ok\":true" : ",\"ok\":false";
+}
+
+void addField(QByteArray& out, const char* key, int value)
+{
+    out += ",\"";
+    out += key;
+    out += "\":";
+    out += QByteArray::number(value);
+}
+
+void addField(QByteArray& out, const char* key, const QString& value)
+{
+    out += ",\"";
+    out += key;
+    out += "\":";
+    appendJsonString(out, value);
+}
+
+void addField(QByteArray& out, const char* key, const QJsonArray& value)
+{
+    out += ",\"";
+    out += key;
+    out += "\":";
+    out += QJsonDocument(value).toJson(QJsonDocument::Compact);
+}
+
+void closeResult(QByteArray& out)
+{
+    out += "}\n";
+}
+
+QStringList splitSeats(const QString& seats)
+{
+    QStringList seatIds = seats.split(',', Qt::SkipEmptyParts);
+    for (QString& seatId : seatIds) {
+        seatId = seatId.trimmed();
+    }
+    return seatIds;
+}
+
+} // namespace
+
+BatchRunner::BatchRunner(BookingService& service)
+    : m_service(service)
+{
+    // Buffered, so the event follows the result of the command that caused it
+    m_promotions = QObject::connect(
+        &service, &BookingService::waitlistPromoted,
+        [this](int waitlistId, int bookingId, const QString& customerName) {
+            m_events += "{\"event\":\"waitlistPromoted\"";
+            addField(m_events, "waitlistId", waitlistId);
+            addField(m_events, "bookingId", bookingId);
+            addField(m_events, "customer", customerName);
+            closeResult(m_events);
+        });
+}
+
+BatchRunner::~BatchRunner()
+{
+    QObject::disconnect(m_promotions);
+}
+
+BatchRunner::Summary BatchRunner::run(QIODevice& input, QIODevice& output)
+{
+    Summary summary;
+    int lineNumber = 0;
+
+    // An empty read means end of input: every line read has its newline
+    for (QByteArray raw = input.readLine(); !raw.isEmpty(); raw = input.readLine()) {
+        ++lineNumber;
+        const QByteArray line = raw.trimmed();
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+
+        Command command;
+        QString error;
+        const bool parsed = line.startsWith('{')
+                                ? parseJson(line, command, error)
+                                : parseWords(QString::fromUtf8(line), command, error);
+
+        ++summary.commands;
+        if (!parsed) {
+            appendFailure(lineNumber, command.name, "InvalidCommand", error);
+            ++summary.failed;
+        } else if (!execute(command, lineNumber)) {
+            ++summary.failed;
+        }
+        m_output += m_events;
+        m_events.clear();
+
+        if (m_output.size() >= OUTPUT_CHUNK_SIZE) {
+            output.write(m_output);
+            m_output.clear();
+        }
+    }
+
+    output.write(m_output);
+    m_output.clear();
+    return summary;
+}
+
+bool BatchRunner::parseWords(const QString& line, Command& command, QString& error)
+{
+    const QStringList words = line.simplified().split(' ', Qt::SkipEmptyParts);
+    command.name = words.value(0);
+
+    bool ok1 = true;
+    bool ok2 = true;
+    if (command.name == "movies" && words.size() == 1) {
+        return true;
+    }
+    if (command.name == "theaters" && words.size() == 2) {
+        command.movieId = words[1].toInt(&ok1);
+        if (ok1) {
+            return true;
+        }
+    } else if (command.name == "seats" && words.size() == 3) {
+        command.theaterId = words[1].toInt(&ok1);
+        command.movieId = words[2].toInt(&ok2);
+        if (ok1 && ok2) {
+            return true;
+        }
+    } else if (command.name == "reserve" && words.size() >= 5) {
+        command.theaterId = words[1].toInt(&ok1);
+        command.movieId = words[2].toInt(&ok2);
+        command.seatIds = splitSeats(words[3]);
+        command.customer = words.mid(4).join(' ');
+        if (ok1 && ok2) {
+            return true;
+        }
+    } else if (command.name == "bookings" && words.size() >= 2) {
+        command.customer = words.mid(1).join(' ');
+        return true;
+    } else if (command.name == "waitlist" && words.size() >= 5) {
+        command.theaterId = words[1].toInt(&ok1);
+        command.movieId = words[2].toInt(&ok2);
+        bool ok3 = true;
+        command.seatCount = words[3].toInt(&ok3);
+        command.customer = words.mid(4).join(' ');
+        if (ok1 && ok2 && ok3) {
+            return true;
+        }
+    } else if (command.name == "cancel" && words.size() == 2) {
+        command.bookingId = words[1].toInt(&ok1);
+        if (ok1) {
+            return true;
+        }
+    } else if (command.name == "load" && words.size() >= 2) {
+        command.path = words.mid(1).join(' ');
+        return true;
+    }
+
+    error = QString("Invalid command: %1").arg(line);
+    return false;
+}
+
+bool BatchRunner::parseJson(const QByteArray& line, Command& command, QString& error)
+{
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(line, &parseError);
+    if (!document.isObject()) {
+        error = QString("Invalid JSON: %1").arg(parseError.errorString());
+        return false;
+    }
+
+    const QJsonObject object = document.object();
+    command.name = object.value("command").toString();
+
+    auto number = [&object](const char* key, int& value) {
+        const QJsonValue field = object.value(key);
+        value = field.toInt();
+        return field.isDouble();
+    };
+    auto text = [&object](const char* key, QString& value) {
+        value = object.value(key).toString();
+        return !value.isEmpty();
+    };
+
+    const QJsonValue seats = object.value("seats");
+    if (seats.isArray()) {
+        for (const QJsonValue& seat : seats.toArray()) {
+            command.seatIds.append(seat.toString());
+        }
+    } else {
+        command.seatIds = splitSeats(seats.toString());
+    }
+    command.idempotencyKey = object.value("key").toString();
+
+    bool valid = false;
+    if (command.name == "movies") {
+        valid = true;
+    } else if (command.name == "theaters") {
+        valid = number("movieId", command.movieId);
+    } else if (command.name == "seats") {
+        valid = number("theaterId", command.theaterId) && number("movieId", command.movieId);
+    } else if (command.name == "reserve") {
+        valid = number("theaterId", command.theaterId) && number("movieId", command.movieId)
+                && text("customer", command.customer);
+    } else if (command.name == "bookings") {
+        valid = text("customer", command.customer);
+    } else if (command.name == "waitlist") {
+        valid = number("theaterId", command.theaterId) && number("movieId", command.movieId)
+                && number("seatCount", command.seatCount) && text("customer", command.customer);
+    } else if (command.name == "cancel") {
+        valid = number("bookingId", command.bookingId);
+    } else if (command.name == "load") {
+        valid = text("path", command.path);
+    }
+
+    if (!valid) {
+        error = command.name.isEmpty() ? QString("Missing command")
+                                       : QString("Invalid arguments for %1").arg(command.name);
+    }
+    return valid;
+}
+
+bool BatchRunner::execute(const Command& command, int lineNumber)
+{
+    if (command.name == "movies") {
+        QJsonArray movies;
+        for (const Movie* movie : m_service.getMovies()) {
+            movies.append(QJsonObject{{"id", movie->getId()},
+                                      {"title", movie->getTitle()},
+                                      {"duration", movie->getDuration()},
+                                      {"genre", movie->getGenre()}});
+        }
+        openResult(m_output, lineNumber, command.name, true);
+        addField(m_output, "movies", movies);
+        closeResult(m_output);
+        return true;
+    }
+
+    if (command.name == "theaters") {
+        QJsonArray theaters;
+        for (const Theater* theater : m_service.getTheaters(command.movieId)) {
+            theaters.append(QJsonObject{{"id", theater->getId()},
+                                        {"name", theater->getName()},
+                                        {"capacity", theater->getCapacity()}});
+        }
+        openResult(m_output, lineNumber, command.name, true);
+        addField(m_output, "theaters", theaters);
+        closeResult(m_output);
+        return true;
+    }
+
+    if (command.name == "seats") {
+        QJsonArray seats;
+        const int available = m_service.forEachAvailableSeat(
+            command.theaterId, command.movieId, [&seats](Seat* seat) {
+                seats.append(seat->getId());
+                return true;
+            });
+        openResult(m_output, lineNumber, command.name, true);
+        addField(m_output, "available", available);
+        addField(m_output, "seats", seats);
+        closeResult(m_output);
+        return true;
+    }
+
+    if (command.name == "reserve") {
+        // An empty key disables deduplication
+        const ReservationResult result =
+            m_service.reserveSeats(command.theaterId, command.movieId, command.seatIds,
+                                   command.customer, command.idempotencyKey);
+        openResult(m_output, lineNumber, command.name, result.ok());
+        if (result) {
+            addField(m_output, "bookingId", result.bookingId);
+        } else {
+            addField(m_output, "code", QString(ReservationResult::codeName(result.code)));
+            addField(m_output, "error", result.describe(command.seatIds));
+            if (result.freeCount >= 0) {
+                addField(m_output, "free", result.freeCount);
+            }
+        }
+        closeResult(m_output);
+        return result.ok();
+    }
+
+    if (command.name == "bookings") {
+        QJsonArray bookings;
+        for (const BookingService::BookingDetails& booking :
+             m_service.getBookingDetails(command.customer)) {
+            bookings.append(QJsonObject{{"id", booking.id},
+                                        {"theaterId", booking.theaterId},
+                                        {"theater", booking.theaterName},
+                                        {"movieId", booking.movieId},
+                                        {"movie", booking.movieTitle},
+                                        {"seats", QJsonArray::fromStringList(booking.seatIds)},
+                                        {"totalPrice", booking.totalPrice}});
+        }
+        openResult(m_output, lineNumber, command.name, true);
+        addField(m_output, "bookings", bookings);
+        closeResult(m_output);
+        return true;
+    }
+
+    if (command.name == "waitlist") {
+        QString error;
+        const int waitlistId = m_service.joinWaitlist(command.theaterId, command.movieId,
+                                                      command.seatCount, command.customer, &error);
+        if (waitlistId == 0) {
+            appendFailure(lineNumber, command.name, "WaitlistRejected", error);
+            return false;
+        }
+        openResult(m_output, lineNumber, command.name, true);
+        addField(m_output, "waitlistId", waitlistId);
+        closeResult(m_output);
+        return true;
+    }
+
+    if (command.name == "cancel") {
+        QString error;
+        if (!m_service.cancelBooking(command.bookingId, &error)) {
+            appendFailure(lineNumber, command.name, "CancelRejected", error);
+            return false;
+        }
+        openResult(m_output, lineNumber, command.name, true);
+        addField(m_output, "bookingId", command.bookingId);
+        closeResult(m_output);
+        return true;
+    }
+
+    if (command.name == "load") {
+        QString error;
+        if (!m_service.loadCatalogFile(command.path, &error)) {
+            appendFailure(lineNumber, command.name, "CatalogRejected", error);
+            return false;
+        }
+        openResult(m_output, lineNumber, command.name, true);
+        addField(m_output, "version", int(m_service.getCatalogStatus().version));
+        closeResult(m_output);
+        return true;
+    }
+
+    appendFailure(lineNumber, command.name, "InvalidCommand",
+                  QString("Unknown command: %1").arg(command.name));
+    return false;
+}
+
+void BatchRunner::appendFailure(int lineNumber, const QString& command, const char* code,
+                                const QString& error)
+{
+    openResult(m_output, lineNumber, command, false);
+    addField(m_output, "code", QString(code));
+    addField(m_output, "error", error);
+    closeResult(m_output);
+}
@@ -89,23 +89,33 @@ void CLIInterface::selectMovie()
     QTextStream in(stdin);
     QTextStream out(stdout);
     
-    out << "Enter movie ID: ";
+    out << "Enter movie ID or title: ";
     out.flush();
     
-    QString input = in.readLine();
-    m_selectedMovieId = input.toInt();
-    
-    auto movies = m_service->getMovies();
-    Movie* selectedMovie = nullptr;
+    const QString input = in.readLine().trimmed();
+    bool isId = false;
+    const int movieId = input.toInt(&isId);
     
-    for (Movie* movie : movies) {
-        if (movie->getId() == m_selectedMovieId) {
-            selectedMovie = movie;
-            break;
+    BookingService::PinnedRef<Movie> selectedMovie;
+    if (isId) {
+        selectedMovie = m_service->getMovie(movieId);
+    } else if (!input.isEmpty()) {
+        // A title prefix must name one movie; list a few candidates otherwise
+        const auto matches = m_service->findMoviesByTitlePrefix(input, 5);
+        if (matches.size() == 1) {
+            selectedMovie = m_service->getMovie(matches.first()->getId());
+        } else if (matches.size() > 1) {
+            out << "Several movies match; enter one ID:\n";
+            for (Movie* movie : matches) {
+                out << "  " << movie->getId() << ": " << movie->getTitle() << "\n";
+            }
+            m_selectedMovieId = -1;
+            return;
         }
     }
     
     if (selectedMovie) {
+        m_selectedMovieId = selectedMovie->getId();
         out << "Movie selected: " << selectedMovie->getTitle() << "\n";
     } else {
         out << "Movie not found!\n";
@@ -149,18 +159,13 @@ void CLIInterface::viewAvailableSeats()
     QString input = in.readLine();
     m_selectedTheaterId = input.toInt();
     
-    auto seats = m_service->getAvailableSeats(m_selectedTheaterId, m_selectedMovieId);
+    // Taken seats show as dashes
+    const BookingService::SeatChart chart = m_service->getSeatChart(
+        m_selectedTheaterId, m_selectedMovieId, SeatChartTemplate::Format::Text);
     
     out << "\n=== AVAILABLE SEATS ===\n\n";
-    out << "Total: " << seats.size() << " seats\n\n";
-    
-    for (int i = 0; i < seats.size(); ++i) {
-        out << seats[i]->getId() << " ";
-        if ((i + 1) % 10 == 0) {
-            out << "\n";
-        }
-    }
-    out << "\n";
+    out << "Total: " << chart.freeCount << " seats\n\n";
+    out << chart.data << "\n";
 }
 
 void CLIInterface::reserveSeats()
@@ -184,11 +189,13 @@ void CLIInterface::reserveSeats()
         seatId = seatId.trimmed();
     }
     
-    if (m_service->reserveSeats(m_selectedTheaterId, m_selectedMovieId, seatIds, m_customerName)) {
+    const ReservationResult result = m_service->reserveSeats(m_selectedTheaterId, m_selectedMovieId,
+                                                             seatIds, m_customerName);
+    if (result) {
         out << "\n✓ Booking successful!\n";
         out << "Reserved seats: " << seatIds.join(", ") << "\n";
     } else {
-        out << "\n✗ Booking failed. Please check seat availability.\n";
+        out << "\n✗ Booking failed: " << result.describe(seatIds) << "\n";
     }
 }
 
@@ -196,8 +203,8 @@ void CLIInterface::viewMyBookings()
 {
     QTextStream out(stdout);
     
-    // Use thread-safe BookingData instead of QObject pointers
-    auto bookings = m_service->getBookingData(m_customerName);
+    // Names are resolved by the service in one call
+    const auto bookings = m_service->getBookingDetails(m_customerName);
     
     out << "=== MY BOOKINGS ===\n\n";
     
@@ -206,29 +213,16 @@ void CLIInterface::viewMyBookings()
         return;
     }
     
-    auto movies = m_service->getMovies();
-    auto theaters = m_service->getTheaters(0);
-    
     for (const auto& booking : bookings) {
         out << "Booking #" << booking.id << "\n";
-        
-        // Find movie
-        for (Movie* movie : movies) {
-            if (movie->getId() == booking.movieId) {
-                out << "Movie: " << movie->getTitle() << "\n";
-                break;
-            }
+        if (!booking.movieTitle.isEmpty()) {
+            out << "Movie: " << booking.movieTitle << "\n";
         }
-        
-        // Find theater
-        for (Theater* theater : theaters) {
-            if (theater->getId() == booking.theaterId) {
-                out << "Theater: " << theater->getName() << "\n";
-                break;
-            }
+        if (!booking.theaterName.isEmpty()) {
+            out << "Theater: " << booking.theaterName << "\n";
         }
-        
         out << "Seats: " << booking.seatIds.join(", ") << "\n";
+        out << "Price: $" << QString::number(booking.totalPrice / 100.0, 'f', 2) << "\n";
         out << "Time: " << booking.bookingTime.toString(Qt::ISODate) << "\n";
         out << "---\n";
     }
@@ -1,7 +1,38 @@
 #include "cli/CLIInterface.h"
+#include "cli/BatchRunner.h"
+#include "core/Tracing.h"
+#include <QCommandLineParser>
 #include <QCoreApplication>
+#include <QFile>
 #include <QTextStream>
 
+/**
+ * @brief Runs a command script without the interactive menu
+ * @param path Script file, or "-" for standard input
+ * @return 0 if every command succeeded, 1 if some failed, 2 if the script cannot be read
+ */
+static int runBatch(const QString& path)
+{
+    QFile input(path);
+    const bool opened = path == "-" ? input.open(stdin, QIODevice::ReadOnly)
+                                    : input.open(QIODevice::ReadOnly);
+    if (!opened) {
+        QTextStream(stderr) << "Error: cannot open " << path << ": " << input.errorString() << "\n";
+        return 2;
+    }
+
+    QFile output;
+    output.open(stdout, QIODevice::WriteOnly);
+
+    BookingService service;
+    BatchRunner runner(service);
+    const BatchRunner::Summary summary = runner.run(input, output);
+    output.flush();
+
+    QTextStream(stderr) << summary.commands << " commands, " << summary.failed << " failed\n";
+    return summary.failed == 0 ? 0 : 1;
+}
+
 /**
  * @brief Main entry point for the CLI application
  * @param argc Argument count
@@ -14,12 +45,42 @@ int main(int argc, char *argv[])
     QCoreApplication::setApplicationName("Ticket Booking System");
     QCoreApplication::setApplicationVersion("1.0.0");
     
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Cinema ticket booking");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    const QCommandLineOption batchOption(
+        QStringList{"b", "batch"},
+        "Run commands from <file> ('-' for stdin), one JSON result per line.", "file");
+    parser.addOption(batchOption);
+    const QCommandLineOption traceOption(
+        QStringList{"t", "trace"},
+        "Write booking pipeline spans to <file> on exit (Chrome trace JSON, opens in Perfetto).",
+        "file");
+    parser.addOption(traceOption);
+    parser.process(app);
+    
+    if (parser.isSet(traceOption) && !TraceRecorder::isCompiledIn()) {
+        QTextStream(stderr) << "Warning: built without tracing (-DENABLE_TRACING=ON); "
+                               "the trace will be empty\n";
+    }
+    
+    int exitCode = 0;
     try {
-        CLIInterface cli;
-        cli.run();
-        return 0;
+        if (parser.isSet(batchOption)) {
+            exitCode = runBatch(parser.value(batchOption));
+        } else {
+            CLIInterface cli;
+            cli.run();
+        }
     } catch (const std::exception& e) {
         QTextStream(stderr) << "Error: " << e.what() << "\n";
-        return 1;
+        exitCode = 1;
+    }
+    
+    QString error;
+    if (parser.isSet(traceOption) && !TraceRecorder::writeChromeTrace(parser.value(traceOption), &error)) {
+        QTextStream(stderr) << "Error: " << error << "\n";
     }
+    return exitCode;
 }
@@ -0,0 +1,99 @@
+#include "core/AdmissionQueue.h"
+#include <QMutexLocker>
+
+AdmissionQueue::AdmissionQueue(int maxActive, int capacity)
+    : m_soldOut(0)
+    , m_maxActive(qMax(1, maxActive))
+    , m_capacity(qMax(1, capacity))
+    , m_nextToken(0)
+    , m_nextAdmit(0)
+    , m_active(0)
+    , m_avgServiceUs(0)
+{
+}
+
+AdmissionQueue::Status AdmissionQueue::enter(Position& position)
+{
+    // Early rejection: no token, no lock
+    if (isSoldOut()) {
+        position = {Status::SoldOut, 0, 0};
+        return Status::SoldOut;
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    const int waiting = static_cast<int>(m_nextToken - m_nextAdmit);
+    position = {Status::Admitted, waiting + m_active, estimateWaitMs(waiting + m_active)};
+    if (waiting >= m_capacity) {
+        position.status = Status::QueueFull;
+        return Status::QueueFull;
+    }
+
+    const quint64 token = m_nextToken++;
+    while (token != m_nextAdmit || (m_active >= m_maxActive && !isSoldOut())) {
+        m_turn.wait(&m_mutex);
+    }
+
+    // Our token is at the head either way; pass the turn on
+    ++m_nextAdmit;
+    m_turn.wakeAll();
+
+    if (isSoldOut()) {
+        position.status = Status::SoldOut;
+        return Status::SoldOut;
+    }
+
+    ++m_active;
+    return Status::Admitted;
+}
+
+void AdmissionQueue::leave(qint64 serviceTimeUs)
+{
+    QMutexLocker locker(&m_mutex);
+
+    --m_active;
+    // Exponential moving average, weight 1/8 for the newest sample
+    m_avgServiceUs += (serviceTimeUs - m_avgServiceUs) / 8;
+    m_turn.wakeAll();
+}
+
+AdmissionQueue::Position AdmissionQueue::position() const
+{
+    if (isSoldOut()) {
+        return {Status::SoldOut, 0, 0};
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    const int waiting = static_cast<int>(m_nextToken - m_nextAdmit);
+    const int ahead = waiting + m_active;
+    return {waiting >= m_capacity ? Status::QueueFull : Status::Admitted,
+            ahead, estimateWaitMs(ahead)};
+}
+
+void AdmissionQueue::setSoldOut(bool soldOut)
+{
+    QMutexLocker locker(&m_mutex);
+    m_soldOut.storeRelease(soldOut ? 1 : 0);
+    m_turn.wakeAll();
+}
+
+void AdmissionQueue::setMaxActive(int maxActive)
+{
+    QMutexLocker locker(&m_mutex);
+    m_maxActive = qMax(1, maxActive);
+    m_turn.wakeAll();
+}
+
+int AdmissionQueue::maxActive() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_maxActive;
+}
+
+qint64 AdmissionQueue::estimateWaitMs(int ahead) const
+{
+    // Callers ahead are served maxActive at a time
+    const qint64 rounds = (ahead + m_maxActive - 1) / m_maxActive;
+    return m_avgServiceUs * rounds / 1000;
+}
@@ -0,0 +1,133 @@
+#include "core/BookingHistory.h"
+#include <algorithm>
+
+BookingHistory::BookingHistory(const BookingHistory& other)
+    : m_bookingIds(other.m_bookingIds)
+    , m_theaterIds(other.m_theaterIds)
+    , m_movieIds(other.m_movieIds)
+    , m_customerHandles(other.m_customerHandles)
+    , m_seatCounts(other.m_seatCounts)
+    , m_totalPrices(other.m_totalPrices)
+    , m_bookedAt(other.m_bookedAt)
+    , m_cancelled(other.m_cancelled)
+    , m_seatOffsets(other.m_seatOffsets)
+    , m_seatIndices(other.m_seatIndices)
+    , m_customers(other.m_customers)
+    , m_ownsTail(false)
+{
+}
+
+BookingHistory& BookingHistory::operator=(const BookingHistory& other)
+{
+    if (this != &other) {
+        *this = BookingHistory(other);
+    }
+    return *this;
+}
+
+void BookingHistory::append(int bookingId, int theaterId, int movieId, quint32 customerHandle,
+                            const QVector<int>& seatIndices, int totalPrice, qint64 bookedAt)
+{
+    m_bookingIds.append(bookingId, m_ownsTail);
+    m_theaterIds.append(theaterId, m_ownsTail);
+    m_movieIds.append(movieId, m_ownsTail);
+    m_customerHandles.append(customerHandle, m_ownsTail);
+    m_seatCounts.append(seatIndices.size(), m_ownsTail);
+    m_totalPrices.append(totalPrice, m_ownsTail);
+    m_bookedAt.append(bookedAt, m_ownsTail);
+    m_cancelled.append(0, m_ownsTail);
+
+    m_seatOffsets.append(m_seatIndices.size(), m_ownsTail);
+    for (int seatIndex : seatIndices) {
+        m_seatIndices.append(static_cast<quint16>(seatIndex), m_ownsTail);
+    }
+
+    // Every tail this history writes to is now its own
+    m_ownsTail = true;
+}
+
+QMap<qint64, BookingHistory::Totals> BookingHistory::totalsBy(Dimension dimension,
+                                                              qint64 from, qint64 to,
+                                                              qint64 bucketSeconds) const
+{
+    const int rows = size();
+    const qint64 bucket = qMax<qint64>(1, bucketSeconds);
+
+    // Pass 1: compute the group key of every row from a single column,
+    // a chunk at a time
+    const Column<qint32>* keyColumn = dimension == Dimension::Movie ? &m_movieIds
+                                                                    : &m_theaterIds;
+    QVector<qint64> keys(rows);
+    for (int chunk = 0, base = 0; base < rows; ++chunk, base += CHUNK_ROWS) {
+        const int count = qMin(CHUNK_ROWS, rows - base);
+        if (dimension == Dimension::TimeBucket) {
+            const qint64* bookedAt = m_bookedAt.chunk(chunk);
+            for (int i = 0; i < count; ++i) {
+                keys[base + i] = bookedAt[i] - bookedAt[i] % bucket;
+            }
+        } else if (dimension == Dimension::Customer) {
+            const quint32* handles = m_customerHandles.chunk(chunk);
+            std::copy(handles, handles + count, keys.begin() + base);
+        } else {
+            const qint32* values = keyColumn->chunk(chunk);
+            std::copy(values, values + count, keys.begin() + base);
+        }
+    }
+
+    // Pass 2: accumulate live rows in range into the group of their key
+    auto accumulate = [&](auto&& totalsFor) {
+        for (int chunk = 0, base = 0; base < rows; ++chunk, base += CHUNK_ROWS) {
+            const int count = qMin(CHUNK_ROWS, rows - base);
+            const qint64* bookedAt = m_bookedAt.chunk(chunk);
+            const quint8* cancelled = m_cancelled.chunk(chunk);
+            const qint32* seatCounts = m_seatCounts.chunk(chunk);
+            const qint32* totalPrices = m_totalPrices.chunk(chunk);
+            for (int i = 0; i < count; ++i) {
+                if (bookedAt[i] < from || bookedAt[i] >= to || cancelled[i]) {
+                    continue;
+                }
+                Totals& totals = totalsFor(keys[base + i]);
+                ++totals.bookings;
+                totals.seats += seatCounts[i];
+                totals.revenue += totalPrices[i];
+            }
+        }
+    };
+
+    QMap<qint64, Totals> result;
+    if (rows == 0) {
+        return result;
+    }
+
+    // Into a dense array when the key range is small
+    const auto [minIt, maxIt] = std::minmax_element(keys.cbegin(), keys.cend());
+    const qint64 minKey = dimension == Dimension::TimeBucket ? 0 : *minIt;
+    const qint64 span = dimension == Dimension::TimeBucket ? 0 : *maxIt - minKey + 1;
+
+    if (span > 0 && span <= 4 * rows + 64) {
+        QVector<Totals> dense(span);
+        accumulate([&dense, minKey](qint64 key) -> Totals& { return dense[key - minKey]; });
+        for (qint64 offset = 0; offset < span; ++offset) {
+            if (dense[offset].bookings > 0) {
+                result.insert(minKey + offset, dense[offset]);
+            }
+        }
+        return result;
+    }
+
+    accumulate([&result](qint64 key) -> Totals& { return result[key]; });
+    return result;
+}
+
+QVector<int> BookingHistory::seatIndices(int row) const
+{
+    const int begin = m_seatOffsets[row];
+    const int end = begin + m_seatCounts[row];
+
+    QVector<int> seats;
+    seats.reserve(end - begin);
+    for (int i = begin; i < end; ++i) {
+        seats.append(m_seatIndices[i]);
+    }
+    return seats;
+}
@@ -1,204 +1,2503 @@
 #include "core/BookingService.h"
+#include "core/Tracing.h"
+#include <QCoreApplication>
 #include <QReadLocker>
 #include <QWriteLocker>
 #include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QTime>
+#include <QDebug>
+#include <QMetaMethod>
+#include <QVarLengthArray>
+#include <QtConcurrent/QtConcurrentMap>
+#include <algorithm>
+#include <new>
+#include <numeric>
 
 BookingService::BookingService(QObject* parent)
     : QObject(parent)
+    , m_pricing(QSharedPointer<const PricingEngine>::create(PricingEngine::defaultPricing()))
     , m_nextBookingId(1)
 {
     initializeSampleData();
 }
 
-QVector<Movie*> BookingService::getMovies() const
+BookingService::Catalog::Catalog(QAtomicInt& liveCount)
+    : liveCount(liveCount)
 {
-    QReadLocker locker(&m_readWriteLock);
-    return m_movies;
+    liveCount.ref();
+}
+
+BookingService::Catalog::~Catalog()
+{
+    liveCount.deref();
+}
+
+void BookingService::IdIndex::build(const QVector<int>& ids)
+{
+    dense.clear();
+    sparse.clear();
+    if (ids.isEmpty()) {
+        return;
+    }
+
+    const auto [minIt, maxIt] = std::minmax_element(ids.cbegin(), ids.cend());
+    const qint64 span = qint64(*maxIt) - *minIt + 1;
+    if (span <= 4 * qint64(ids.size()) + 64) {
+        base = *minIt;
+        dense.fill(-1, span);
+        for (int i = 0; i < ids.size(); ++i) {
+            dense[ids[i] - base] = i;
+        }
+        return;
+    }
+
+    sparse.reserve(ids.size());
+    for (int i = 0; i < ids.size(); ++i) {
+        sparse.insert(ids[i], i);
+    }
+}
+
+int BookingService::IdIndex::indexOf(int id) const
+{
+    if (!dense.isEmpty()) {
+        const qint64 offset = id - base;
+        return offset >= 0 && offset < dense.size() ? dense[offset] : -1;
+    }
+    return sparse.value(id, -1);
+}
+
+void BookingService::MovieSearchIndex::build(const QVector<Movie*>& movies)
+{
+    byGenre.clear();
+    byTitle.clear();
+    byDuration.clear();
+    byTitle.reserve(movies.size());
+    byDuration.reserve(movies.size());
+
+    for (int i = 0; i < movies.size(); ++i) {
+        const Movie* movie = movies[i];
+        byGenre[movie->getGenre().toCaseFolded()].append(i);
+        byTitle.append(qMakePair(movie->getTitle().toCaseFolded(), i));
+        byDuration.append(qMakePair(movie->getDuration(), i));
+    }
+
+    // Ties keep catalog order
+    std::sort(byTitle.begin(), byTitle.end());
+    std::sort(byDuration.begin(), byDuration.end());
+}
+
+QSharedPointer<BookingService::ShowingSeats> BookingService::Catalog::findShowing(int theaterId,
+                                                                                int movieId) const
+{
+    auto theaterIt = theaterSeats.constFind(theaterId);
+    if (theaterIt == theaterSeats.constEnd()) {
+        return {};
+    }
+    return theaterIt->movieSeats.value(movieId);
+}
+
+BookingService::PinnedList<Movie> BookingService::getMovies() const
+{
+    const QSharedPointer<const Catalog> catalog = currentCatalog();
+    return {catalog->movies, catalog};
+}
+
+BookingService::PinnedList<Theater> BookingService::getTheaters(int movieId) const
+{
+    const QSharedPointer<const Catalog> catalog = currentCatalog();
+
+    // Theaters with a showing of the movie, per the loaded catalog
+    QVector<Theater*> theaters;
+    for (Theater* theater : catalog->theaters) {
+        auto theaterIt = catalog->theaterSeats.constFind(theater->getId());
+        if (theaterIt != catalog->theaterSeats.constEnd()
+            && theaterIt->movieSeats.contains(movieId)) {
+            theaters.append(theater);
+        }
+    }
+    return {theaters, catalog};
+}
+
+BookingService::PinnedList<Seat> BookingService::getAvailableSeats(int theaterId,
+                                                                   int movieId) const
+{
+    // The catalog holds the showing, and with it the seats, while pinned
+    const QSharedPointer<const Catalog> catalog = currentCatalog();
+    const QSharedPointer<ShowingSeats> showing = catalog->findShowing(theaterId, movieId);
+    if (!showing) {
+        return {};
+    }
+
+    interleave("seats.lookedUp");
+    QMutexLocker showingLocker(&showing->mutex);
+
+    const QVector<int> freeSeats = showing->seatMap->freeSeats();
+
+    QVector<Seat*> availableSeats;
+    availableSeats.reserve(freeSeats.size());
+    for (int seatIndex : freeSeats) {
+        if (showing->shared && showing->shared->isTaken(showing->sharedSlot, seatIndex)) {
+            continue;   // Booked by another process
+        }
+        availableSeats.append(showing->seats[seatIndex]);
+    }
+
+    return {availableSeats, catalog};
+}
+
+BookingService::Page<Movie*> BookingService::getMoviesPage(int cursor, int limit) const
+{
+    const QSharedPointer<const Catalog> catalog = currentCatalog();
+    const int size = catalog->movies.size();
+
+    Page<Movie*> page;
+    if (limit <= 0) {
+        return page;
+    }
+    page.pin = catalog;
+
+    const int begin = qBound(0, cursor, size);
+    const int count = qMin(limit, size - begin);
+    page.items = catalog->movies.mid(begin, count);
+    page.nextCursor = begin + count < size ? begin + count : -1;
+    return page;
+}
+
+BookingService::Page<Theater*> BookingService::getTheatersPage(int movieId, int cursor,
+                                                               int limit) const
+{
+    const QSharedPointer<const Catalog> catalog = currentCatalog();
+
+    Page<Theater*> page;
+    if (limit <= 0) {
+        return page;
+    }
+    page.pin = catalog;
+
+    for (int i = qMax(cursor, 0); i < catalog->theaters.size(); ++i) {
+        Theater* theater = catalog->theaters[i];
+        if (!catalog->findShowing(theater->getId(), movieId)) {
+            continue;
+        }
+        if (page.items.size() == limit) {
+            page.nextCursor = i;
+            break;
+        }
+        page.items.append(theater);
+    }
+    return page;
+}
+
+BookingService::Page<Seat*> BookingService::getAvailableSeatsPage(int theaterId, int movieId,
+                                                                  int cursor, int limit) const
+{
+    Page<Seat*> page;
+    const QSharedPointer<const Catalog> catalog = currentCatalog();
+    const QSharedPointer<ShowingSeats> showing = catalog->findShowing(theaterId, movieId);
+    if (!showing || limit <= 0) {
+        return page;
+    }
+    page.pin = catalog;
+
+    QMutexLocker showingLocker(&showing->mutex);
+
+    page.items.reserve(qMin(limit, showing->seatMap->freeCount()));
+    int indices[STREAM_CHUNK_SIZE];
+    for (int from = qMax(cursor, 0);;) {
+        const int count = showing->seatMap->freeSeatsFrom(from, indices, STREAM_CHUNK_SIZE);
+        for (int i = 0; i < count; ++i) {
+            const int seatIndex = indices[i];
+            if (showing->shared && showing->shared->isTaken(showing->sharedSlot, seatIndex)) {
+                continue;   // Booked by another process
+            }
+            if (page.items.size() == limit) {
+                page.nextCursor = seatIndex;
+                return page;
+            }
+            page.items.append(showing->seats[seatIndex]);
+        }
+        if (count < STREAM_CHUNK_SIZE) {
+            return page;
+        }
+        from = indices[count - 1] + 1;
+    }
+}
+
+int BookingService::forEachMovie(const MovieVisitor& visitor) const
+{
+    const QSharedPointer<const Catalog> catalog = currentCatalog();
+
+    int visited = 0;
+    for (Movie* movie : catalog->movies) {
+        ++visited;
+        if (!visitor(movie)) {
+            break;
+        }
+    }
+    return visited;
+}
+
+int BookingService::forEachTheater(int movieId, const TheaterVisitor& visitor) const
+{
+    const QSharedPointer<const Catalog> catalog = currentCatalog();
+
+    int visited = 0;
+    for (Theater* theater : catalog->theaters) {
+        if (!catalog->findShowing(theater->getId(), movieId)) {
+            continue;
+        }
+        ++visited;
+        if (!visitor(theater)) {
+            break;
+        }
+    }
+    return visited;
+}
+
+int BookingService::forEachAvailableSeat(int theaterId, int movieId,
+                                         const SeatVisitor& visitor) const
+{
+    // The reference keeps the seats alive while the visitor runs unlocked
+    const QSharedPointer<ShowingSeats> showing = currentCatalog()->findShowing(theaterId, movieId);
+    if (!showing) {
+        return 0;
+    }
+
+    int visited = 0;
+    int indices[STREAM_CHUNK_SIZE];
+    for (int from = 0;;) {
+        int count = 0;
+        {
+            QMutexLocker showingLocker(&showing->mutex);
+            count = showing->seatMap->freeSeatsFrom(from, indices, STREAM_CHUNK_SIZE);
+        }
+
+        for (int i = 0; i < count; ++i) {
+            const int seatIndex = indices[i];
+            if (showing->shared && showing->shared->isTaken(showing->sharedSlot, seatIndex)) {
+                continue;   // Booked by another process
+            }
+            ++visited;
+            if (!visitor(showing->seats[seatIndex])) {
+                return visited;
+            }
+        }
+        if (count < STREAM_CHUNK_SIZE) {
+            return visited;
+        }
+        from = indices[count - 1] + 1;
+    }
+}
+
+BookingService::PinnedRef<Movie> BookingService::getMovie(int movieId) const
+{
+    const QSharedPointer<const Catalog> catalog = currentCatalog();
+    const int position = catalog->movieIndex.indexOf(movieId);
+    return {position >= 0 ? catalog->movies[position] : nullptr, catalog};
+}
+
+BookingService::PinnedList<Movie> BookingService::findMoviesByGenre(const QString& genre) const
+{
+    const QSharedPointer<const Catalog> catalog = currentCatalog();
+
+    QVector<Movie*> movies;
+    auto genreIt = catalog->movieSearch.byGenre.constFind(genre.toCaseFolded());
+    if (genreIt == catalog->movieSearch.byGenre.constEnd()) {
+        return {};
+    }
+    movies.reserve(genreIt->size());
+    for (int position : *genreIt) {
+        movies.append(catalog->movies[position]);
+    }
+    return {movies, catalog};
+}
+
+BookingService::PinnedList<Movie> BookingService::findMoviesByTitlePrefix(const QString& prefix,
+                                                                          int limit) const
+{
+    const QSharedPointer<const Catalog> catalog = currentCatalog();
+    const QVector<QPair<QString, int>>& titles = catalog->movieSearch.byTitle;
+
+    // Titles sharing a prefix are adjacent in sorted order and start at
+    // the first title not less than the prefix itself
+    const QString folded = prefix.toCaseFolded();
+    auto it = std::lower_bound(titles.cbegin(), titles.cend(), folded,
+                               [](const QPair<QString, int>& entry, const QString& key) {
+                                   return entry.first < key;
+                               });
+
+    QVector<Movie*> movies;
+    for (; it != titles.cend() && movies.size() != limit && it->first.startsWith(folded); ++it) {
+        movies.append(catalog->movies[it->second]);
+    }
+    return {movies, catalog};
+}
+
+BookingService::PinnedList<Movie> BookingService::findMoviesByDuration(int minMinutes,
+                                                                       int maxMinutes) const
+{
+    const QSharedPointer<const Catalog> catalog = currentCatalog();
+    const QVector<QPair<int, int>>& durations = catalog->movieSearch.byDuration;
+
+    auto it = std::lower_bound(durations.cbegin(), durations.cend(), qMakePair(minMinutes, 0));
+
+    QVector<Movie*> movies;
+    for (; it != durations.cend() && it->first <= maxMinutes; ++it) {
+        movies.append(catalog->movies[it->second]);
+    }
+    return {movies, catalog};
+}
+
+quint64 BookingService::getSeatMapVersion(int theaterId, int movieId) const
+{
+    const QSharedPointer<ShowingSeats> showing = currentCatalog()->findShowing(theaterId, movieId);
+    if (!showing) {
+        return 0;
+    }
+
+    QMutexLocker showingLocker(&showing->mutex);
+    return showing->version;
+}
+
+BookingService::SeatChart BookingService::getSeatChart(int theaterId, int movieId,
+                                                       SeatChartTemplate::Format format) const
+{
+    const QSharedPointer<ShowingSeats> showing = currentCatalog()->findShowing(theaterId, movieId);
+    if (!showing) {
+        return {0, 0, {}};
+    }
+
+    QMutexLocker showingLocker(&showing->mutex);
+
+    if (!showing->chartTemplate) {
+        showing->chartTemplate = chartTemplate(*showing->seatMap);
+    }
+    const SeatChartTemplate& layout = *showing->chartTemplate;
+    const SeatMap& seatMap = *showing->seatMap;
+
+    if (showing->shared) {
+        // Other processes' bookings never reach the change log
+        QByteArray chart = layout.blank(format);
+        for (int i = 0; i < layout.capacity(); ++i) {
+            if (seatMap.isTaken(i) || showing->shared->isTaken(showing->sharedSlot, i)) {
+                layout.setTaken(chart, format, i, true);
+            }
+        }
+        return {showing->version, showing->shared->freeCount(showing->sharedSlot), chart};
+    }
+
+    const int slot = int(format);
+    QByteArray& chart = showing->charts[slot];
+    quint64& chartVersion = showing->chartVersions[slot];
+
+    if (chart.isNull() || chartVersion != showing->version) {
+        QVector<int> changedIndices;
+        if (!chart.isNull() && chartVersion < showing->version
+            && showing->changes.changesSince(chartVersion, changedIndices)) {
+            for (int index : changedIndices) {
+                layout.setTaken(chart, format, index, seatMap.isTaken(index));
+            }
+        } else {
+            // First request, or the change log no longer reaches back
+            chart = layout.blank(format);
+            for (int i = 0; i < layout.capacity(); ++i) {
+                if (seatMap.isTaken(i)) {
+                    layout.setTaken(chart, format, i, true);
+                }
+            }
+        }
+        chartVersion = showing->version;
+    }
+
+    return {showing->version, seatMap.freeCount(), chart};
+}
+
+BookingService::SeatChangeSet BookingService::getSeatChangesSince(int theaterId, int movieId,
+                                                                  quint64 version) const
+{
+    const QSharedPointer<ShowingSeats> showing = currentCatalog()->findShowing(theaterId, movieId);
+    if (!showing) {
+        return {0, true, {}};
+    }
+
+    QMutexLocker showingLocker(&showing->mutex);
+
+    SeatChangeSet changeSet{showing->version, false, {}};
+    if (version == showing->version) {
+        return changeSet;
+    }
+
+    QVector<int> changedIndices;
+    if (version < showing->version && showing->changes.changesSince(version, changedIndices)) {
+        changeSet.changes.reserve(changedIndices.size());
+        for (int index : changedIndices) {
+            changeSet.changes.append({index, showing->seats[index]->isAvailable()});
+        }
+        return changeSet;
+    }
+
+    // Client is too far behind (or ahead after a restart): send everything
+    changeSet.isFullSnapshot = true;
+    changeSet.changes.reserve(showing->seats.size());
+    for (int i = 0; i < showing->seats.size(); ++i) {
+        changeSet.changes.append({i, showing->seats[i]->isAvailable()});
+    }
+    return changeSet;
+}
+
+ReservationResult BookingService::reserveSeats(int theaterId, int movieId,
+                                               const QStringList& seatIds,
+                                               const QString& customerName)
+{
+    return reserve(theaterId, movieId, seatIds, customerName);
+}
+
+ReservationResult BookingService::reserveSeats(int theaterId, int movieId,
+                                               const QStringList& seatIds,
+                                               const QString& customerName,
+                                               const QString& idempotencyKey,
+                                               int* bookingId)
+{
+    if (idempotencyKey.isEmpty()) {
+        ReservationResult result = reserve(theaterId, movieId, seatIds, customerName);
+        if (bookingId && result) {
+            *bookingId = result.bookingId;
+        }
+        return result;
+    }
+
+    // A retry must describe the same request as the original
+    const QByteArray fingerprint = QString("%1:%2:%3:%4")
+                                       .arg(theaterId).arg(movieId)
+                                       .arg(customerName, seatIds.join(','))
+                                       .toUtf8();
+
+    ReservationResult result;
+    result.theaterId = theaterId;
+    result.movieId = movieId;
+
+    switch (m_idempotency.begin(idempotencyKey, fingerprint, result.bookingId)) {
+    case IdempotencyTable::Status::Started:
+        break;
+    case IdempotencyTable::Status::Replayed: {
+        if (bookingId) {
+            *bookingId = result.bookingId;
+        }
+
+        // The key stays bound to its booking after a cancellation
+        bool cancelled = false;
+        {
+            QMutexLocker bookingLocker(&m_bookingMutex);
+            const int row = bookingRow(result.bookingId);
+            cancelled = row >= 0 && m_bookingData[row].cancelled;
+        }
+        if (cancelled) {
+            result.fail(ReservationResult::Code::BookingCancelled);
+            reportFailure(result, seatIds);
+        }
+        return result;
+    }
+    case IdempotencyTable::Status::Mismatch:
+        result.fail(ReservationResult::Code::IdempotencyMismatch);
+        reportFailure(result, seatIds);
+        return result;
+    }
+
+    result = reserve(theaterId, movieId, seatIds, customerName);
+    if (!result) {
+        m_idempotency.abandon(idempotencyKey);
+        return result;
+    }
+
+    m_idempotency.finish(idempotencyKey, result.bookingId);
+    if (bookingId) {
+        *bookingId = result.bookingId;
+    }
+    return result;
+}
+
+ReservationResult BookingService::reserve(int theaterId, int movieId, const QStringList& seatIds,
+                                          const QString& customerName)
+{
+    TRACE_SCOPE("reserveSeats");
+
+    ReservationResult result;
+    result.theaterId = theaterId;
+    result.movieId = movieId;
+
+    if (m_isReplica.loadAcquire()) {
+        reportFailure(result.fail(ReservationResult::Code::ReadOnlyReplica), seatIds);
+        return result;
+    }
+
+    // Throttle before any lookup or lock
+    TRACE_BEGIN(rateLimitSpan, "rateLimit");
+    RateLimiter::QuotaHold quotaHold;
+    if (!admitRequest(customerName, theaterId, movieId, seatIds.size(), result, quotaHold)) {
+        reportFailure(result, seatIds);
+        return result;
+    }
+    TRACE_END(rateLimitSpan);
+    interleave("reserve.admitted");
+
+    result = bookShowing(theaterId, movieId, seatIds, customerName, quotaHold);
+    if (!result) {
+        m_rateLimiter.release(customerName, theaterId, movieId, quotaHold);
+    }
+    return result;
+}
+
+ReservationResult BookingService::bookShowing(int theaterId, int movieId,
+                                              const QStringList& seatIds,
+                                              const QString& customerName,
+                                              const RateLimiter::QuotaHold& quotaHold)
+{
+    ReservationResult result;
+    result.theaterId = theaterId;
+    result.movieId = movieId;
+
+    Booking* booking = nullptr;
+    bool replaced = false;
+
+    do {
+        QSharedPointer<const Catalog> catalog;
+        QSharedPointer<const PricingEngine> pricing;
+
+        TRACE_BEGIN(lookupSpan, "lookupShowing");
+        {
+            QReadLocker locker(&m_readWriteLock);
+            catalog = m_catalog;
+            pricing = m_pricing;
+        }
+
+        if (!catalog->theaterSeats.contains(theaterId)) {
+            reportFailure(result.fail(ReservationResult::Code::TheaterNotFound), seatIds);
+            return result;
+        }
+
+        // Keeps the showing alive even if a reload drops it meanwhile
+        const QSharedPointer<ShowingSeats> showing = catalog->findShowing(theaterId, movieId);
+        if (!showing) {
+            reportFailure(result.fail(ReservationResult::Code::ShowingNotFound), seatIds);
+            return result;
+        }
+
+        // Do not hold the old version back while waiting for admission
+        catalog.clear();
+        TRACE_END(lookupSpan);
+        interleave("reserve.lookedUp");
+
+        // Early rejection: hopeless requests fail without queueing or locking
+        TRACE_BEGIN(precheckSpan, "precheckSeats");
+        if (!precheckSeats(*showing, seatIds, result)) {
+            reportFailure(result, seatIds);
+            return result;
+        }
+        TRACE_END(precheckSpan);
+        interleave("reserve.prechecked");
+
+        TRACE_BEGIN(admissionSpan, "admissionWait");
+        AdmissionQueue::Position position;
+        switch (showing->admission.enter(position)) {
+        case AdmissionQueue::Status::Admitted:
+            break;
+        case AdmissionQueue::Status::SoldOut:
+            result.freeCount = 0;
+            reportFailure(result.fail(ReservationResult::Code::SoldOut), seatIds);
+            return result;
+        case AdmissionQueue::Status::QueueFull:
+            result.queueAhead = position.ahead;
+            result.estimatedWaitMs = position.estimatedWaitMs;
+            reportFailure(result.fail(ReservationResult::Code::QueueFull), seatIds);
+            return result;
+        }
+        TRACE_END(admissionSpan);
+
+        QElapsedTimer serviceTimer;
+        serviceTimer.start();
+
+        {
+            // Only this showing is locked; other showings remain bookable
+            TRACE_BEGIN(lockSpan, "showingLockWait");
+            QMutexLocker showingLocker(&showing->mutex);
+            TRACE_END(lockSpan);
+
+            // A reload replaced the showing after we picked it: start over
+            replaced = showing->retired;
+
+            QVector<int> seatIndices;
+            if (!replaced && prepareSeats(*showing, seatIds, seatIndices, result)
+                && claimSharedSeats(*showing, seatIndices, result)) {
+                // Price at the occupancy the customer saw, before committing
+                const QVector<int> seatPrices = priceSeats(*pricing, *showing, seatIndices);
+                commitSeats(*showing, seatIndices);
+                result.freeCount = showing->availableCount.loadAcquire();
+
+                {
+                    TRACE_BEGIN(bookingLockSpan, "bookingLockWait");
+                    QMutexLocker bookingLocker(&m_bookingMutex);
+                    TRACE_END(bookingLockSpan);
+                    booking = recordBooking(theaterId, movieId, showing->lineage, seatIds,
+                                            seatIndices, customerName, seatPrices, quotaHold);
+                    result.bookingId = m_bookingData.last().id;
+                }
+                finishSharedClaim(*showing, true);
+            }
+        }
+
+        showing->admission.leave(serviceTimer.nsecsElapsed() / 1000);
+        interleave("reserve.unlocked");
+    } while (replaced);
+
+    // Emit signals outside the locks so slots may call back into the service
+    if (!result) {
+        reportFailure(result, seatIds);
+        return result;
+    }
+
+    TRACE_SCOPE("emitSignals");
+    emit seatsReserved(theaterId, movieId, seatIds);
+    if (booking) {
+        emit bookingCreated(booking);
+    }
+
+    return result;
+}
+
+ReservationResult BookingService::reserveGroup(const QVector<ShowingRequest>& requests,
+                                               const QString& customerName)
+{
+    TRACE_SCOPE("reserveGroup");
+
+    ReservationResult result;
+
+    if (m_isReplica.loadAcquire()) {
+        reportFailure(result.fail(ReservationResult::Code::ReadOnlyReplica), {});
+        return result;
+    }
+
+    // Merge requests per showing; QMap ordering gives the global lock order
+    QMap<QPair<int, int>, QStringList> seatsByShowing;
+    for (const ShowingRequest& request : requests) {
+        seatsByShowing[qMakePair(request.theaterId, request.movieId)] += request.seatIds;
+    }
+
+    if (seatsByShowing.isEmpty()) {
+        reportFailure(result.fail(ReservationResult::Code::NoSeatsRequested), {});
+        return result;
+    }
+
+    // Throttle each part before any lookup or lock; a rejected part undoes the others
+    QVector<RateLimiter::QuotaHold> quotaHolds;
+    quotaHolds.reserve(seatsByShowing.size());
+    auto releaseQuota = [&]() {
+        auto it = seatsByShowing.cbegin();
+        for (const RateLimiter::QuotaHold& hold : std::as_const(quotaHolds)) {
+            m_rateLimiter.release(customerName, it.key().first, it.key().second, hold);
+            ++it;
+        }
+    };
+    for (auto it = seatsByShowing.cbegin(); it != seatsByShowing.cend(); ++it) {
+        result.theaterId = it.key().first;
+        result.movieId = it.key().second;
+        RateLimiter::QuotaHold hold;
+        if (!admitRequest(customerName, it.key().first, it.key().second, it->size(), result,
+                          hold)) {
+            releaseQuota();
+            reportFailure(result, it.value());
+            return result;
+        }
+        quotaHolds.append(hold);
+    }
+
+    // Seats of the part a failure refers to, for the failure text
+    QStringList failedSeatIds;
+    QVector<Booking*> bookings;
+    bool replaced = false;
+
+    do {
+        QSharedPointer<const Catalog> catalog;
+        QSharedPointer<const PricingEngine> pricing;
+
+        {
+            QReadLocker locker(&m_readWriteLock);
+            catalog = m_catalog;
+            pricing = m_pricing;
+        }
+
+        replaced = false;
+        QVector<QSharedPointer<ShowingSeats>> showings;
+        showings.reserve(seatsByShowing.size());
+        for (auto it = seatsByShowing.cbegin(); it != seatsByShowing.cend(); ++it) {
+            result.theaterId = it.key().first;
+            result.movieId = it.key().second;
+            failedSeatIds = it.value();
+
+            QSharedPointer<ShowingSeats> showing = catalog->findShowing(it.key().first,
+                                                                        it.key().second);
+            if (!showing) {
+                result.fail(ReservationResult::Code::ShowingNotFound);
+                break;
+            }
+            // Fail before locking anything if one part is already hopeless
+            if (!precheckSeats(*showing, it.value(), result)) {
+                break;
+            }
+            showings.append(showing);
+        }
+
+        if (result) {
+            interleave("group.prechecked");
+
+            // Lock every involved showing in ascending order (deadlock-free)
+            TRACE_BEGIN(lockSpan, "showingLockWait");
+            for (const auto& showing : showings) {
+                showing->mutex.lock();
+            }
+            TRACE_END(lockSpan);
+
+            // A reload replaced one of the showings after we picked it: start over
+            replaced = std::any_of(showings.cbegin(), showings.cend(),
+                                   [](const auto& showing) { return showing->retired; });
+
+            // Prepare: validate everything before touching any seat
+            QVector<QVector<int>> seatIndices(showings.size());
+            int i = 0;
+            for (auto it = seatsByShowing.cbegin(); !replaced && it != seatsByShowing.cend();
+                 ++it, ++i) {
+                result.theaterId = it.key().first;
+                result.movieId = it.key().second;
+                failedSeatIds = it.value();
+                if (!prepareSeats(*showings[i], it.value(), seatIndices[i], result)) {
+                    break;
+                }
+            }
+
+            // Other processes: claim every part or none
+            int claimed = 0;
+            if (!replaced && result) {
+                auto it = seatsByShowing.cbegin();
+                for (; claimed < showings.size(); ++claimed, ++it) {
+                    if (!claimSharedSeats(*showings[claimed], seatIndices[claimed], result)) {
+                        result.theaterId = it.key().first;
+                        result.movieId = it.key().second;
+                        failedSeatIds = it.value();
+                        break;
+                    }
+                }
+                if (!result) {
+                    while (claimed > 0) {
+                        finishSharedClaim(*showings[--claimed], false);
+                    }
+                }
+            }
+
+            // Commit: all seats are known to be free, price and reserve them
+            if (!replaced && result) {
+                QVector<QVector<int>> seatPrices(showings.size());
+                for (i = 0; i < showings.size(); ++i) {
+                    seatPrices[i] = priceSeats(*pricing, *showings[i], seatIndices[i]);
+                    commitSeats(*showings[i], seatIndices[i]);
+                }
+
+                TRACE_BEGIN(bookingLockSpan, "bookingLockWait");
+                QMutexLocker bookingLocker(&m_bookingMutex);
+                TRACE_END(bookingLockSpan);
+                i = 0;
+                for (auto it = seatsByShowing.cbegin(); it != seatsByShowing.cend(); ++it, ++i) {
+                    Booking* booking = recordBooking(it.key().first, it.key().second,
+                                                     showings[i]->lineage, it.value(),
+                                                     seatIndices[i], customerName,
+                                                     seatPrices[i], quotaHolds[i]);
+                    if (booking) {
+                        bookings.append(booking);
+                    }
+                    if (i == 0) {
+                        result.bookingId = m_bookingData.last().id;
+                    }
+                }
+                bookingLocker.unlock();
+
+                for (const auto& showing : showings) {
+                    finishSharedClaim(*showing, true);
+                }
+            }
+
+            for (int j = showings.size() - 1; j >= 0; --j) {
+                showings[j]->mutex.unlock();
+            }
+            interleave("group.unlocked");
+        }
+    } while (replaced);
+
+    if (!result) {
+        releaseQuota();
+        reportFailure(result, failedSeatIds);
+        return result;
+    }
+
+    // On success the result refers to the first showing of the group
+    result.theaterId = seatsByShowing.firstKey().first;
+    result.movieId = seatsByShowing.firstKey().second;
+
+    TRACE_SCOPE("emitSignals");
+    for (auto it = seatsByShowing.cbegin(); it != seatsByShowing.cend(); ++it) {
+        emit seatsReserved(it.key().first, it.key().second, it.value());
+    }
+    for (Booking* booking : bookings) {
+        emit bookingCreated(booking);
+    }
+
+    return result;
+}
+
+bool BookingService::cancelBooking(int bookingId, QString* error)
+{
+    TRACE_SCOPE("cancelBooking");
+
+    if (m_isReplica.loadAcquire()) {
+        if (error) {
+            *error = "A replica cannot cancel bookings";
+        }
+        return false;
+    }
+
+    return cancel(bookingId, error);
+}
+
+bool BookingService::cancel(int bookingId, QString* error)
+{
+    auto fail = [error](const QString& reason) {
+        if (error) {
+            *error = reason;
+        }
+        return false;
+    };
+
+    BookingData booking;
+    QVector<Promotion> promotions;
+
+    for (;;) {
+        int row = -1;
+        {
+            QMutexLocker bookingLocker(&m_bookingMutex);
+            row = bookingRow(bookingId);
+            if (row < 0) {
+                return fail(QString("Booking %1 not found").arg(bookingId));
+            }
+            booking = m_bookingData[row];
+        }
+        if (booking.cancelled) {
+            return fail(QString("Booking %1 is already cancelled").arg(bookingId));
+        }
+
+        QSharedPointer<const Catalog> catalog;
+        QSharedPointer<const PricingEngine> pricing;
+        {
+            QReadLocker locker(&m_readWriteLock);
+            catalog = m_catalog;
+            pricing = m_pricing;
+        }
+        const QSharedPointer<ShowingSeats> showing =
+            catalog->findShowing(booking.theaterId, booking.movieId);
+        catalog.clear();
+        interleave("cancel.found");
+
+        if (!showing || showing->lineage != booking.showingLineage) {
+            // Dropped by a reload (and possibly added back since, with seats
+            // of its own): there are no seats left to give back
+            QMutexLocker bookingLocker(&m_bookingMutex);
+            if (m_bookingData[row].cancelled) {
+                return fail(QString("Booking %1 is already cancelled").arg(bookingId));
+            }
+            markCancelled(row);
+            break;
+        }
+
+        QMutexLocker showingLocker(&showing->mutex);
+        if (showing->retired) {
+            continue;   // Replaced by a reload meanwhile
+        }
+
+        {
+            QMutexLocker bookingLocker(&m_bookingMutex);
+            // Another caller may have cancelled it since we looked
+            if (m_bookingData[row].cancelled) {
+                return fail(QString("Booking %1 is already cancelled").arg(bookingId));
+            }
+            markCancelled(row);
+        }
+
+        QVector<int> seatIndices;
+        seatIndices.reserve(booking.seatIds.size());
+        for (const QString& seatId : std::as_const(booking.seatIds)) {
+            seatIndices.append(showing->seatMap->indexOf(seatId));
+        }
+        releaseSeats(*showing, seatIndices);
+
+        // Waiting parties get the seats before anyone else can see them free
+        promotions = promoteWaitlist(booking.theaterId, booking.movieId, *showing, *pricing);
+        break;
+    }
+    interleave("cancel.unlocked");
+
+    if (!m_isReplica.loadAcquire()) {
+        m_rateLimiter.release(booking.customerId, booking.theaterId, booking.movieId,
+                              booking.quotaHold);
+    }
+
+    emit seatsReleased(booking.theaterId, booking.movieId, booking.seatIds);
+    emitPromotions(promotions);
+    return true;
+}
+
+int BookingService::joinWaitlist(int theaterId, int movieId, int seatCount,
+                                 const QString& customerName, QString* error)
+{
+    auto fail = [error](const QString& reason) {
+        if (error) {
+            *error = reason;
+        }
+        return 0;
+    };
+
+    if (m_isReplica.loadAcquire()) {
+        return fail("A replica cannot take waitlist entries");
+    }
+    if (seatCount < 1) {
+        return fail("A waitlist entry needs at least one seat");
+    }
+
+    ReservationResult result;
+    result.theaterId = theaterId;
+    result.movieId = movieId;
+    RateLimiter::QuotaHold quotaHold;
+    if (!admitRequest(customerName, theaterId, movieId, seatCount, result, quotaHold)) {
+        return fail(result.describe({}));
+    }
+
+    WaitlistEntry entry{m_lastWaitlistId.fetchAndAddRelaxed(1) + 1, customerName, seatCount,
+                        QDateTime::currentDateTime(), quotaHold};
+    QVector<Promotion> promotions;
+
+    for (;;) {
+        QSharedPointer<const Catalog> catalog;
+        QSharedPointer<const PricingEngine> pricing;
+        {
+            QReadLocker locker(&m_readWriteLock);
+            catalog = m_catalog;
+            pricing = m_pricing;
+        }
+        const QSharedPointer<ShowingSeats> showing = catalog->findShowing(theaterId, movieId);
+        catalog.clear();
+
+        QString reason;
+        if (!showing) {
+            reason = result.fail(ReservationResult::Code::ShowingNotFound).describe({});
+        } else if (seatCount > showing->seats.size()) {
+            reason = QString("Showing has only %1 seats").arg(showing->seats.size());
+        }
+        if (!reason.isEmpty()) {
+            m_rateLimiter.release(customerName, theaterId, movieId, quotaHold);
+            return fail(reason);
+        }
+        interleave("waitlist.lookedUp");
+
+        QMutexLocker showingLocker(&showing->mutex);
+        if (showing->retired) {
+            continue;   // Replaced by a reload meanwhile
+        }
+
+        // Served at once if the seats are there
+        showing->waitlist.append(entry);
+        promotions = promoteWaitlist(theaterId, movieId, *showing, *pricing);
+        break;
+    }
+    interleave("waitlist.unlocked");
+
+    emitPromotions(promotions);
+    return entry.id;
+}
+
+bool BookingService::leaveWaitlist(int theaterId, int movieId, int waitlistId)
+{
+    WaitlistEntry entry;
+
+    for (;;) {
+        const QSharedPointer<ShowingSeats> showing =
+            currentCatalog()->findShowing(theaterId, movieId);
+        if (!showing) {
+            return false;
+        }
+
+        QMutexLocker showingLocker(&showing->mutex);
+        if (showing->retired) {
+            continue;   // Replaced by a reload meanwhile
+        }
+
+        auto it = std::find_if(showing->waitlist.begin(), showing->waitlist.end(),
+                               [waitlistId](const WaitlistEntry& waiting) {
+                                   return waiting.id == waitlistId;
+                               });
+        if (it == showing->waitlist.end()) {
+            return false;
+        }
+        entry = *it;
+        showing->waitlist.erase(it);
+        break;
+    }
+
+    m_rateLimiter.release(entry.customerId, theaterId, movieId, entry.quotaHold);
+    return true;
+}
+
+QVector<BookingService::WaitlistEntry> BookingService::getWaitlist(int theaterId,
+                                                                  int movieId) const
+{
+    const QSharedPointer<ShowingSeats> showing = currentCatalog()->findShowing(theaterId, movieId);
+    if (!showing) {
+        return {};
+    }
+
+    QMutexLocker showingLocker(&showing->mutex);
+    return showing->waitlist;
+}
+
+bool BookingService::admitRequest(const QString& customerName, int theaterId, int movieId,
+                                  int seatCount, ReservationResult& result,
+                                  RateLimiter::QuotaHold& hold)
+{
+    const RateLimiter::Decision decision =
+        m_rateLimiter.admit(customerName, theaterId, movieId, seatCount);
+
+    switch (decision.status) {
+    case RateLimiter::Status::Allowed:
+        hold = decision.hold;
+        return true;
+    case RateLimiter::Status::CustomerRateLimited:
+    case RateLimiter::Status::ShowingRateLimited:
+        result.estimatedWaitMs = decision.retryAfterMs;
+        result.fail(ReservationResult::Code::RateLimited);
+        return false;
+    case RateLimiter::Status::QuotaExceeded:
+        result.quotaLeft = decision.seatsLeft;
+        result.fail(ReservationResult::Code::QuotaExceeded);
+        return false;
+    }
+    return true;
+}
+
+void BookingService::reportFailure(const ReservationResult& result, const QStringList& seatIds)
+{
+    // Rendering the text allocates; skip it when nobody listens
+    static const QMetaMethod signal = QMetaMethod::fromSignal(&BookingService::reservationFailed);
+    if (isSignalConnected(signal)) {
+        emit reservationFailed(result.describe(seatIds));
+    }
+}
+
+void BookingService::setRateLimits(const RateLimiter::Limits& limits)
+{
+    m_rateLimiter.setLimits(limits);
+}
+
+RateLimiter::Limits BookingService::getRateLimits() const
+{
+    return m_rateLimiter.limits();
+}
+
+AdmissionQueue::Position BookingService::getAdmissionPosition(int theaterId, int movieId) const
+{
+    const QSharedPointer<ShowingSeats> showing = currentCatalog()->findShowing(theaterId, movieId);
+    if (!showing) {
+        return {AdmissionQueue::Status::SoldOut, 0, 0};
+    }
+
+    return showing->admission.position();
+}
+
+bool BookingService::setAdmissionLimit(int theaterId, int movieId, int maxActive)
+{
+    const QSharedPointer<ShowingSeats> showing = currentCatalog()->findShowing(theaterId, movieId);
+    if (!showing) {
+        return false;
+    }
+
+    showing->admission.setMaxActive(maxActive);
+    return true;
+}
+
+QVector<int> BookingService::getSeatPrices(int theaterId, int movieId) const
+{
+    const QSharedPointer<ShowingSeats> showing = currentCatalog()->findShowing(theaterId, movieId);
+    if (!showing) {
+        return {};
+    }
+
+    QSharedPointer<const PricingEngine> pricing;
+    {
+        QReadLocker locker(&m_readWriteLock);
+        pricing = m_pricing;
+    }
+
+    // Occupancy comes from the atomic counter; no need to lock the showing
+    return pricing->priceAll(showing->seats.size(), occupancyPercent(*showing),
+                               QTime::currentTime().hour());
+}
+
+void BookingService::setPricing(const PricingEngine& pricing)
+{
+    QWriteLocker locker(&m_readWriteLock);
+    m_pricing = QSharedPointer<const PricingEngine>::create(pricing);
+}
+
+QVector<Booking*> BookingService::getBookings(const QString& customerName) const
+{
+    QMutexLocker locker(&m_bookingMutex);
+
+    QVector<Booking*> customerBookings;
+    for (Booking* booking : m_bookings) {
+        if (booking->getCustomerId() == customerName) {
+            customerBookings.append(booking);
+        }
+    }
+
+    return customerBookings;
+}
+
+QVector<BookingService::BookingData> BookingService::getBookingData(const QString& customerName) const
+{
+    // Unknown customers have no bookings; no need to take the booking lock
+    const quint32 handle = m_customers.find(customerName);
+    if (handle == CustomerRegistry::INVALID_HANDLE) {
+        return {};
+    }
+
+    QMutexLocker locker(&m_bookingMutex);
+
+    const QVector<int> rows = m_bookingRowsByCustomer.value(handle);
+
+    QVector<BookingData> customerBookings;
+    customerBookings.reserve(rows.size());
+    for (int row : rows) {
+        customerBookings.append(m_bookingData[row]);
+    }
+
+    return customerBookings;
+}
+
+BookingService::Page<BookingService::BookingData> BookingService::getBookingDataPage(
+    const QString& customerName, int cursor, int limit) const
+{
+    Page<BookingData> page;
+    const quint32 handle = m_customers.find(customerName);
+    if (handle == CustomerRegistry::INVALID_HANDLE || limit <= 0) {
+        return page;
+    }
+
+    QMutexLocker locker(&m_bookingMutex);
+
+    // The cursor is a booking row, not a position in the customer's list:
+    // cancellations remove rows from the list but never renumber them
+    const QVector<int> rows = m_bookingRowsByCustomer.value(handle);
+    const int begin = int(std::lower_bound(rows.cbegin(), rows.cend(), qMax(cursor, 0))
+                          - rows.cbegin());
+    const int count = qMin(limit, int(rows.size()) - begin);
+
+    page.items.reserve(count);
+    for (int i = begin; i < begin + count; ++i) {
+        page.items.append(m_bookingData[rows[i]]);
+    }
+    page.nextCursor = begin + count < rows.size() ? rows[begin + count] : -1;
+    return page;
+}
+
+int BookingService::forEachBooking(const QString& customerName,
+                                   const BookingVisitor& visitor) const
+{
+    const quint32 handle = m_customers.find(customerName);
+    if (handle == CustomerRegistry::INVALID_HANDLE) {
+        return 0;
+    }
+
+    int visited = 0;
+    QVarLengthArray<BookingData, STREAM_CHUNK_SIZE> chunk;
+    // Resumes at a booking row, so cancellations between chunks skip nothing
+    for (int nextRow = 0;;) {
+        chunk.clear();
+        {
+            QMutexLocker locker(&m_bookingMutex);
+            const auto rowsIt = m_bookingRowsByCustomer.constFind(handle);
+            if (rowsIt == m_bookingRowsByCustomer.constEnd()) {
+                return visited;
+            }
+            for (auto it = std::lower_bound(rowsIt->cbegin(), rowsIt->cend(), nextRow);
+                 it != rowsIt->cend() && chunk.size() < STREAM_CHUNK_SIZE; ++it) {
+                chunk.append(m_bookingData[*it]);
+                nextRow = *it + 1;
+            }
+        }
+
+        for (const BookingData& booking : chunk) {
+            ++visited;
+            if (!visitor(booking)) {
+                return visited;
+            }
+        }
+        if (chunk.size() < STREAM_CHUNK_SIZE) {
+            return visited;
+        }
+    }
+}
+
+QVector<BookingService::BookingDetails> BookingService::getBookingDetails(const QString& customerName) const
+{
+    const quint32 handle = m_customers.find(customerName);
+    if (handle == CustomerRegistry::INVALID_HANDLE) {
+        return {};
+    }
+
+    // One catalog version for the whole page, taken before the booking lock
+    const QSharedPointer<const Catalog> catalog = currentCatalog();
+    interleave("details.catalogTaken");
+
+    QMutexLocker locker(&m_bookingMutex);
+
+    const QVector<int> rows = m_bookingRowsByCustomer.value(handle);
+
+    QVector<BookingDetails> details;
+    details.reserve(rows.size());
+    for (int row : rows) {
+        const BookingData& booking = m_bookingData[row];
+        const int movieIndex = catalog->movieIndex.indexOf(booking.movieId);
+        const int theaterIndex = catalog->theaterIndex.indexOf(booking.theaterId);
+        details.append({booking.id,
+                        booking.movieId,
+                        movieIndex >= 0 ? catalog->movies[movieIndex]->getTitle() : QString(),
+                        booking.theaterId,
+                        theaterIndex >= 0 ? catalog->theaters[theaterIndex]->getName() : QString(),
+                        booking.seatIds,
+                        booking.seatPrices,
+                        booking.totalPrice,
+                        booking.bookingTime});
+    }
+
+    return details;
+}
+
+BookingHistory BookingService::getBookingHistory() const
+{
+    QMutexLocker locker(&m_bookingMutex);
+    return m_history;
+}
+
+bool BookingService::attachSharedInventory(const QString& name, QString* error)
+{
+    // Holding off reloads keeps the slot assignment below in sync with the catalog
+    QMutexLocker reloadLocker(&m_catalogReloadMutex);
+    const QSharedPointer<const Catalog> catalog = currentCatalog();
+
+    if (m_sharedInventory) {
+        if (error) {
+            *error = "A shared inventory is already attached";
+        }
+        return false;
+    }
+
+    // Each slot is sized to its own hall, so shared free counts stay exact
+    QVector<int> capacities;
+    for (const TheaterSeats& theater : catalog->theaterSeats) {
+        for (const auto& showing : theater.movieSeats) {
+            capacities.append(showing->seats.size());
+        }
+    }
+
+    auto inventory = std::make_unique<SharedInventory>();
+    if (!inventory->open(name, capacities, error)) {
+        return false;
+    }
+
+    // Slots follow (theaterId, movieId) order, matching the local lock order
+    int slot = 0;
+    for (const TheaterSeats& theater : catalog->theaterSeats) {
+        for (const auto& showing : theater.movieSeats) {
+            QMutexLocker showingLocker(&showing->mutex);
+            showing->shared = inventory.get();
+            showing->sharedSlot = slot++;
+        }
+    }
+
+    m_sharedInventory = std::move(inventory);
+    return true;
+}
+
+bool BookingService::startReplication(const QString& socketPath, QString* error)
+{
+    if (m_isReplica.loadAcquire()) {
+        if (error) {
+            *error = "A replica cannot serve replicas";
+        }
+        return false;
+    }
+
+    auto publisher = std::make_unique<ReplicationPublisher>();
+    if (!publisher->listen(socketPath, error)) {
+        return false;
+    }
+
+    QMutexLocker locker(&m_bookingMutex);
+
+    if (m_replicationPublisher) {
+        if (error) {
+            *error = "Replication is already running";
+        }
+        return false;
+    }
+
+    // Seed the log with what is already booked and cancelled, in the
+    // original order, so replicas start complete. Entries the bounded log
+    // would drop right away keep their sequences but are not encoded.
+    const quint64 logSize = m_bookingData.size() + m_cancelledRows.size();
+    const quint64 retained = ReplicationPublisher::DEFAULT_RETAINED_FRAMES;
+    const quint64 firstPublished = logSize > retained ? logSize - retained + 1 : 1;
+    publisher->skipTo(firstPublished - 1);
+
+    int nextBooking = 0;
+    int nextCancellation = 0;
+    for (quint64 sequence = 1; sequence <= logSize; ++sequence) {
+        if (sequence < firstPublished) {
+            if (nextCancellation < m_cancelledRows.size()
+                && m_cancelledRows[nextCancellation].first == sequence) {
+                ++nextCancellation;
+            } else {
+                ++nextBooking;
+            }
+            continue;
+        }
+
+        ReplicationRecord record;
+        if (nextCancellation < m_cancelledRows.size()
+            && m_cancelledRows[nextCancellation].first == sequence) {
+            const int row = m_cancelledRows[nextCancellation++].second;
+            const BookingData& bookingData = m_bookingData[row];
+            record.kind = ReplicationRecord::Kind::Cancellation;
+            record.bookingId = bookingData.id;
+            record.theaterId = bookingData.theaterId;
+            record.movieId = bookingData.movieId;
+            record.seatIds = bookingData.seatIds;
+        } else {
+            const BookingData& bookingData = m_bookingData[nextBooking++];
+            record.bookingId = bookingData.id;
+            record.theaterId = bookingData.theaterId;
+            record.movieId = bookingData.movieId;
+            record.customerId = bookingData.customerId;
+            record.seatIds = bookingData.seatIds;
+            record.seatPrices = bookingData.seatPrices;
+            record.bookedAtMs = bookingData.bookingTime.toMSecsSinceEpoch();
+        }
+        publisher->publish(record);
+    }
+
+    m_replicationPublisher = std::move(publisher);
+    return true;
+}
+
+bool BookingService::replicateFrom(const QString& socketPath, QString* error)
+{
+    quint64 fromSequence = 0;
+    {
+        QMutexLocker locker(&m_bookingMutex);
+        if (m_replicationPublisher || m_replicationSubscriber) {
+            if (error) {
+                *error = "Replication is already running";
+            }
+            return false;
+        }
+        fromSequence = m_bookingData.size() + m_cancelledRows.size() + 1;
+    }
+
+    // Reject reservations before the first record can arrive
+    m_isReplica.storeRelease(1);
+
+    auto subscriber = std::make_unique<ReplicationSubscriber>();
+    if (!subscriber->connectTo(socketPath, fromSequence,
+                               [this](const ReplicationRecord& record) {
+                                   return applyReplicatedBooking(record);
+                               },
+                               error)) {
+        m_isReplica.storeRelease(0);
+        return false;
+    }
+
+    QMutexLocker locker(&m_bookingMutex);
+    m_replicationSubscriber = std::move(subscriber);
+    return true;
+}
+
+bool BookingService::promoteToPrimary()
+{
+    std::unique_ptr<ReplicationSubscriber> subscriber;
+    {
+        QMutexLocker locker(&m_bookingMutex);
+        if (!m_isReplica.loadAcquire() || !m_replicationSubscriber) {
+            return false;
+        }
+        subscriber = std::move(m_replicationSubscriber);
+    }
+
+    // Waits for an in-flight apply, which needs the booking lock
+    subscriber->disconnect();
+
+    m_isReplica.storeRelease(0);
+    return true;
+}
+
+BookingService::ReplicationStatus BookingService::getReplicationStatus() const
+{
+    QMutexLocker locker(&m_bookingMutex);
+
+    ReplicationStatus status;
+    status.role = m_isReplica.loadAcquire() ? ReplicationRole::Replica : ReplicationRole::Primary;
+    status.appliedSequence = m_bookingData.size() + m_cancelledRows.size();
+    status.primarySequence = status.appliedSequence;
+    status.lagMs = m_replicationLagMs.loadAcquire();
+    status.connected = false;
+    status.replicaCount = 0;
+
+    if (m_replicationPublisher) {
+        status.replicaCount = m_replicationPublisher->replicaCount();
+    }
+    if (m_replicationSubscriber) {
+        status.primarySequence = qMax(status.primarySequence,
+                                      m_replicationSubscriber->primarySequence());
+        status.connected = m_replicationSubscriber->isConnected();
+    }
+
+    return status;
+}
+
+bool BookingService::loadCatalog(const CatalogData& catalog, QString* error)
+{
+    if (!catalog.validate(error)) {
+        return false;
+    }
+
+    interleave("reload.validated");
+    QMutexLocker reloadLocker(&m_catalogReloadMutex);
+
+    if (m_sharedInventory) {
+        // Shared slots are assigned per showing when attaching
+        if (error) {
+            *error = "Cannot replace the catalog while a shared inventory is attached";
+        }
+        return false;
+    }
+
+    const QSharedPointer<const Catalog> current = currentCatalog();
+
+    QHash<int, const CatalogData::TheaterEntry*> halls;
+    halls.reserve(catalog.theaters.size());
+    for (const CatalogData::TheaterEntry& entry : catalog.theaters) {
+        halls.insert(entry.id, &entry);
+    }
+
+    // Surviving showings in a hall of the same size and placement are reused as they are
+    QVector<QSharedPointer<ShowingSeats>> showings(catalog.showings.size());
+    QVector<int> showingIndices;
+    for (int i = 0; i < catalog.showings.size(); ++i) {
+        const CatalogData::ShowingEntry& entry = catalog.showings[i];
+        QSharedPointer<ShowingSeats> existing =
+            current ? current->findShowing(entry.theaterId, entry.movieId) : nullptr;
+        const CatalogData::TheaterEntry* hall = halls.value(entry.theaterId);
+        if (existing && existing->seats.size() == hall->capacity
+            && existing->numaNode == hall->numaNode) {
+            showings[i] = existing;
+        } else {
+            showingIndices.append(i);
+        }
+    }
+
+    // One block per NUMA node holds every showing this load builds there
+    QVector<std::size_t> offsets(catalog.showings.size());
+    QMap<int, std::size_t> blockSizes;
+    for (int index : std::as_const(showingIndices)) {
+        const CatalogData::TheaterEntry* hall = halls.value(catalog.showings[index].theaterId);
+        std::size_t& size = blockSizes[hall->numaNode];
+        offsets[index] = size;
+        size += ShowingSeats::footprint(hall->capacity);
+    }
+    QMap<int, QSharedPointer<ShowingBlock>> blocks;
+    for (auto it = blockSizes.cbegin(); it != blockSizes.cend(); ++it) {
+        blocks.insert(it.key(), QSharedPointer<ShowingBlock>::create(it.value(), it.key()));
+    }
+
+    // Build the other seat maps in parallel, without holding any lock
+    QThread* owner = thread();
+    auto build = [&](int index) {
+        const CatalogData::TheaterEntry* hall = halls.value(catalog.showings[index].theaterId);
+        showings[index] = buildShowing(hall->capacity, blocks.value(hall->numaNode),
+                                       offsets[index], owner);
+    };
+    if (showingIndices.size() >= PARALLEL_BUILD_THRESHOLD) {
+        QtConcurrent::blockingMap(showingIndices, build);
+    } else {
+        std::for_each(showingIndices.cbegin(), showingIndices.cend(), build);
+    }
+
+    // A successor takes over its predecessor's lineage in carryOverSeats()
+    for (int index : std::as_const(showingIndices)) {
+        showings[index]->lineage = m_nextShowingLineage++;
+    }
+
+    auto next = QSharedPointer<Catalog>::create(m_liveCatalogs);
+    next->version = current ? current->version + 1 : 1;
+
+    for (int i = 0; i < catalog.showings.size(); ++i) {
+        const CatalogData::ShowingEntry& entry = catalog.showings[i];
+        next->theaterSeats[entry.theaterId].movieSeats.insert(entry.movieId, showings[i]);
+    }
+
+    // Old showings that are not reused: replaced by a resized one, or dropped
+    struct Retiring {
+        int theaterId;
+        int movieId;
+        QSharedPointer<ShowingSeats> showing;
+        QSharedPointer<ShowingSeats> successor;     ///< null if dropped
+    };
+    QVector<Retiring> retiring;
+    if (current) {
+        for (auto theaterIt = current->theaterSeats.cbegin();
+             theaterIt != current->theaterSeats.cend(); ++theaterIt) {
+            for (auto movieIt = theaterIt->movieSeats.cbegin();
+                 movieIt != theaterIt->movieSeats.cend(); ++movieIt) {
+                QSharedPointer<ShowingSeats> successor =
+                    next->findShowing(theaterIt.key(), movieIt.key());
+                if (successor != movieIt.value()) {
+                    retiring.append({theaterIt.key(), movieIt.key(), movieIt.value(), successor});
+                }
+            }
+        }
+    }
+
+    // Freeze them (in lock order) so nothing commits to them while their
+    // seats are carried over and the new version is published
+    for (const Retiring& old : retiring) {
+        old.showing->mutex.lock();
+    }
+    auto unlockRetiring = [&retiring]() {
+        for (int i = retiring.size() - 1; i >= 0; --i) {
+            retiring[i].showing->mutex.unlock();
+        }
+    };
+
+    for (const Retiring& old : retiring) {
+        if (old.successor && !carryOverSeats(*old.showing, *old.successor)) {
+            unlockRetiring();
+            if (error) {
+                *error = QString("Theater %1 is too small for the seats booked for movie %2")
+                             .arg(old.theaterId).arg(old.movieId);
+            }
+            return false;
+        }
+    }
+
+    // Unchanged movies and theaters keep their objects, so pointers held
+    // by callers stay valid. Every version listing an object shares its
+    // reference; the last one to go may be on any thread, so the owner
+    // thread deletes it. New ones belong to the service thread,
+    // whichever thread loads.
+    const auto deleteLater = [](QObject* object) { object->deleteLater(); };
+    QHash<int, QSharedPointer<QObject>> oldMovies;
+    QHash<int, QSharedPointer<QObject>> oldTheaters;
+    if (current) {
+        for (int i = 0; i < current->movies.size(); ++i) {
+            oldMovies.insert(current->movies[i]->getId(), current->objectRefs[i]);
+        }
+        for (int i = 0; i < current->theaters.size(); ++i) {
+            oldTheaters.insert(current->theaters[i]->getId(),
+                               current->objectRefs[current->movies.size() + i]);
+        }
+    }
+
+    next->movies.reserve(catalog.movies.size());
+    next->objectRefs.reserve(catalog.movies.size() + catalog.theaters.size());
+    for (const CatalogData::MovieEntry& entry : catalog.movies) {
+        QSharedPointer<QObject> ref = oldMovies.value(entry.id);
+        Movie* movie = static_cast<Movie*>(ref.data());
+        if (!movie || movie->getTitle() != entry.title || movie->getDuration() != entry.duration
+            || movie->getGenre() != entry.genre) {
+            movie = new Movie(entry.id, entry.title, entry.duration, entry.genre);
+            movie->moveToThread(owner);
+            movie->setParent(this);
+            ref = QSharedPointer<QObject>(movie, deleteLater);
+        }
+        next->movies.append(movie);
+        next->objectRefs.append(ref);
+    }
+
+    next->theaters.reserve(catalog.theaters.size());
+    for (const CatalogData::TheaterEntry& entry : catalog.theaters) {
+        QSharedPointer<QObject> ref = oldTheaters.value(entry.id);
+        Theater* theater = static_cast<Theater*>(ref.data());
+        if (!theater || theater->getName() != entry.name
+            || theater->getCapacity() != entry.capacity) {
+            theater = new Theater(entry.id, entry.name, entry.capacity);
+            theater->moveToThread(owner);
+            theater->setParent(this);
+            ref = QSharedPointer<QObject>(theater, deleteLater);
+        }
+        next->theaters.append(theater);
+        next->objectRefs.append(ref);
+    }
+
+    QVector<int> ids;
+    ids.reserve(next->movies.size());
+    for (const Movie* movie : std::as_const(next->movies)) {
+        ids.append(movie->getId());
+    }
+    next->movieIndex.build(ids);
+    ids.clear();
+    for (const Theater* theater : std::as_const(next->theaters)) {
+        ids.append(theater->getId());
+    }
+    next->theaterIndex.build(ids);
+    next->movieSearch.build(next->movies);
+
+    // Publish: only the handle swap happens under the write lock
+    {
+        QWriteLocker locker(&m_readWriteLock);
+        m_catalog = next;
+    }
+
+    // Reservations still holding a retired showing start over; parties
+    // waiting for a dropped showing are let go
+    QVector<QPair<QPair<int, int>, WaitlistEntry>> droppedEntries;
+    for (const Retiring& old : retiring) {
+        old.showing->retired = true;
+        if (!old.successor) {
+            for (const WaitlistEntry& entry : std::as_const(old.showing->waitlist)) {
+                droppedEntries.append(qMakePair(qMakePair(old.theaterId, old.movieId), entry));
+            }
+        }
+    }
+    unlockRetiring();
+
+    for (const auto& dropped : std::as_const(droppedEntries)) {
+        m_rateLimiter.release(dropped.second.customerId, dropped.first.first,
+                              dropped.first.second, dropped.second.quotaHold);
+    }
+
+    // A larger hall may have room for parties that were waiting
+    QSharedPointer<const PricingEngine> pricing;
+    {
+        QReadLocker locker(&m_readWriteLock);
+        pricing = m_pricing;
+    }
+    QVector<Promotion> promotions;
+    for (const Retiring& old : retiring) {
+        if (old.successor) {
+            QMutexLocker showingLocker(&old.successor->mutex);
+            promotions += promoteWaitlist(old.theaterId, old.movieId, *old.successor, *pricing);
+        }
+    }
+    reloadLocker.unlock();
+    emitPromotions(promotions);
+
+    return true;
 }
 
-QVector<Theater*> BookingService::getTheaters(int movieId) const
+bool BookingService::loadCatalogFile(const QString& path, QString* error)
 {
-    QReadLocker locker(&m_readWriteLock);
-    
-    // For simplicity, all theaters show all movies
-    // In a real system, this would check schedules
-    Q_UNUSED(movieId)
-    return m_theaters;
+    CatalogData catalog;
+    return CatalogLoader::loadFile(path, catalog, error) && loadCatalog(catalog, error);
 }
 
-QVector<Seat*> BookingService::getAvailableSeats(int theaterId, int movieId) const
+BookingService::CatalogStatus BookingService::getCatalogStatus() const
 {
-    QReadLocker locker(&m_readWriteLock);
-    
-    auto theaterIt = m_theaterSeats.find(theaterId);
-    if (theaterIt == m_theaterSeats.end()) {
-        return {};
+    const QSharedPointer<const Catalog> catalog = currentCatalog();
+
+    CatalogStatus status;
+    status.version = catalog->version;
+    status.liveVersions = m_liveCatalogs.loadAcquire();
+    status.showingCount = 0;
+    for (const TheaterSeats& theater : catalog->theaterSeats) {
+        status.showingCount += theater.movieSeats.size();
+    }
+    return status;
+}
+
+void BookingService::initializeSampleData()
+{
+    CatalogData catalog;
+
+    catalog.movies = {
+        {1, "The Matrix Resurrections", 148, "Sci-Fi"},
+        {2, "Dune: Part Two", 166, "Sci-Fi"},
+        {3, "Oppenheimer", 180, "Drama"},
+        {4, "Barbie", 114, "Comedy"}
+    };
+
+    catalog.theaters = {
+        {1, "IMAX Hall", Theater::TOTAL_SEATS},
+        {2, "VIP Hall", Theater::TOTAL_SEATS},
+        {3, "Standard Hall A", Theater::TOTAL_SEATS}
+    };
+
+    // Every theater shows every movie
+    for (const CatalogData::TheaterEntry& theater : catalog.theaters) {
+        for (const CatalogData::MovieEntry& movie : catalog.movies) {
+            catalog.showings.append({theater.id, movie.id});
+        }
+    }
+
+    loadCatalog(catalog);
+}
+
+BookingService::ShowingBlock::ShowingBlock(std::size_t size, int node)
+    : numaNode(node)
+{
+    QString bindError;
+    memory = static_cast<char*>(NumaMemory::allocate(size, NumaMemory::CACHE_LINE_SIZE, numaNode,
+                                                     &bindError));
+    static QAtomicInt bindWarned;
+    if (!bindError.isEmpty() && bindWarned.testAndSetRelaxed(0, 1)) {
+        qWarning() << "Showings left on their default NUMA node:" << bindError;
+    }
+}
+
+BookingService::ShowingBlock::~ShowingBlock()
+{
+    NumaMemory::release(memory, NumaMemory::CACHE_LINE_SIZE, numaNode);
+}
+
+BookingService::ShowingSeats::ShowingSeats(int capacity, QSharedPointer<ShowingBlock> owningBlock,
+                                           void* bits)
+    : takenBits(static_cast<TakenBitsLine*>(bits))
+    , numaNode(owningBlock->numaNode)
+    , block(std::move(owningBlock))
+{
+    const int lines = (capacity + SEATS_PER_LINE - 1) / SEATS_PER_LINE;
+    for (int i = 0; i < lines; ++i) {
+        new (&takenBits[i]) TakenBitsLine();
+    }
+}
+
+BookingService::ShowingSeats::~ShowingSeats()
+{
+    // seatOwner deletes the seats. They live on the service thread, but
+    // the last reference to a showing may go away on any thread (a reader
+    // holding a pinned result, a reload worker). A thread that has finished
+    // (or never ran) will not process a deferred delete again, so only a
+    // running owner thread gets one; whoever owns such a thread without an
+    // event loop (the simulator) processes deferred deletes itself
+    if (QObject* owner = seatOwner.release()) {
+        QThread* ownerThread = owner->thread();
+        if (!ownerThread || ownerThread == QThread::currentThread()
+            || !ownerThread->isRunning() || !QCoreApplication::instance()) {
+            delete owner;
+        } else {
+            owner->deleteLater();
+        }
+    }
+
+    // Taken bits are trivially destructible; the seat map and the block
+    // holding all three go with the members
+}
+
+std::size_t BookingService::ShowingSeats::footprint(int capacity)
+{
+    const std::size_t line = NumaMemory::CACHE_LINE_SIZE;
+    const std::size_t lines = (capacity + SEATS_PER_LINE - 1) / SEATS_PER_LINE;
+    return sizeof(ShowingSeats) + lines * sizeof(TakenBitsLine)
+           + (seatMapSize(capacity) + line - 1) / line * line;
+}
+
+QSharedPointer<BookingService::ShowingSeats> BookingService::buildShowing(
+    int capacity, const QSharedPointer<ShowingBlock>& block, std::size_t offset, QThread* owner)
+{
+    // Whole lines of the load's block: showing, taken bits, seat map
+    char* memory = block->memory + offset;
+    const std::size_t lines = (capacity + ShowingSeats::SEATS_PER_LINE - 1)
+                              / ShowingSeats::SEATS_PER_LINE;
+    char* bits = memory + sizeof(ShowingSeats);
+    char* seatMapMemory = bits + lines * sizeof(ShowingSeats::TakenBitsLine);
+
+    // Nothing here throws before the deleter owns the showing, which
+    // destroys it in place and lets go of the block last (also if the
+    // control block cannot be allocated)
+    QSharedPointer<ShowingSeats> showing(new (memory) ShowingSeats(capacity, block, bits),
+                                         [](ShowingSeats* seats) {
+                                             const QSharedPointer<ShowingBlock> keep = seats->block;
+                                             seats->~ShowingSeats();
+                                         });
+
+    showing->seatMap = SeatMapPtr(placeSeatMap(seatMapMemory, capacity),
+                                  SeatMapDeleter{showing->numaNode, false});
+    showing->seats.reserve(capacity);
+
+    // Owned by the showing; freed when the last reference goes away
+    showing->seatOwner = std::make_unique<QObject>();
+    for (int i = 0; i < capacity; ++i) {
+        showing->seats.append(new Seat(showing->seatMap->seatId(i), Seat::Status::Available,
+                                       showing->seatOwner.get()));
+    }
+    showing->seatOwner->moveToThread(owner);
+
+    showing->availableCount.storeRelease(capacity);
+
+    return showing;
+}
+
+void BookingService::setInterleaveHook(InterleaveHook hook, void* context)
+{
+    m_interleaveHook = hook;
+    m_interleaveContext = context;
+}
+
+bool BookingService::verifyInvariants(QString* error) const
+{
+    const QSharedPointer<const Catalog> catalog = currentCatalog();
+
+    struct LockedShowing {
+        int theaterId;
+        int movieId;
+        ShowingSeats* showing;
+    };
+
+    // Lock order: showings ascending (QMap order), then the booking records
+    QVector<LockedShowing> showings;
+    for (auto theaterIt = catalog->theaterSeats.cbegin(); theaterIt != catalog->theaterSeats.cend();
+         ++theaterIt) {
+        for (auto movieIt = theaterIt->movieSeats.cbegin();
+             movieIt != theaterIt->movieSeats.cend(); ++movieIt) {
+            showings.append({theaterIt.key(), movieIt.key(), movieIt->data()});
+        }
     }
-    
-    auto movieIt = theaterIt->movieSeats.find(movieId);
-    if (movieIt == theaterIt->movieSeats.end()) {
+    for (const LockedShowing& entry : std::as_const(showings)) {
+        entry.showing->mutex.lock();
+    }
+    m_bookingMutex.lock();
+
+    auto check = [&]() -> QString {
+        // Every view of a showing's seats agrees
+        QHash<QPair<int, int>, int> takenCounts;
+        for (const LockedShowing& entry : std::as_const(showings)) {
+            const ShowingSeats& showing = *entry.showing;
+            const int capacity = showing.seatMap->capacity();
+            int taken = 0;
+            for (int i = 0; i < capacity; ++i) {
+                const bool isTaken = showing.seatMap->isTaken(i);
+                taken += isTaken ? 1 : 0;
+                if (showing.isTakenBitSet(i) != isTaken) {
+                    return QString("Showing %1/%2: taken bit of seat %3 disagrees with the seat map")
+                        .arg(entry.theaterId).arg(entry.movieId).arg(showing.seatMap->seatId(i));
+                }
+                if (showing.seats[i]->isAvailable() == isTaken) {
+                    return QString("Showing %1/%2: seat %3 object disagrees with the seat map")
+                        .arg(entry.theaterId).arg(entry.movieId).arg(showing.seatMap->seatId(i));
+                }
+            }
+            if (showing.seatMap->freeCount() != capacity - taken
+                || showing.availableCount.loadAcquire() != capacity - taken) {
+                return QString("Showing %1/%2: %3 seats taken but free counts are %4 and %5")
+                    .arg(entry.theaterId).arg(entry.movieId).arg(taken)
+                    .arg(showing.seatMap->freeCount()).arg(showing.availableCount.loadAcquire());
+            }
+            takenCounts.insert(qMakePair(entry.theaterId, entry.movieId), taken);
+        }
+
+        // No seat is sold twice, and every sold seat is taken
+        QSet<int> bookingIds;
+        QHash<QPair<int, int>, QVector<bool>> soldSeats;
+        int liveBookings = 0;
+        for (int row = 0; row < m_bookingData.size(); ++row) {
+            const BookingData& booking = m_bookingData[row];
+            if (bookingIds.contains(booking.id)) {
+                return QString("Booking ID %1 is used twice").arg(booking.id);
+            }
+            bookingIds.insert(booking.id);
+            if (m_history.isCancelled(row) != booking.cancelled) {
+                return QString("Booking history disagrees on cancellation of booking %1")
+                    .arg(booking.id);
+            }
+            if (booking.cancelled) {
+                continue;   // Its seats were given back
+            }
+            ++liveBookings;
+
+            const QSharedPointer<ShowingSeats> showing =
+                catalog->findShowing(booking.theaterId, booking.movieId);
+            if (!showing || showing->lineage != booking.showingLineage) {
+                continue;   // Dropped by a reload
+            }
+            QVector<bool>& sold = soldSeats[qMakePair(booking.theaterId, booking.movieId)];
+            sold.resize(showing->seatMap->capacity());
+            for (const QString& seatId : booking.seatIds) {
+                const int index = showing->seatMap->indexOf(seatId);
+                if (index < 0 || !showing->seatMap->isTaken(index)) {
+                    return QString("Booking %1: seat %2 is not taken").arg(booking.id).arg(seatId);
+                }
+                if (sold[index]) {
+                    return QString("Showing %1/%2: seat %3 is sold twice")
+                        .arg(booking.theaterId).arg(booking.movieId).arg(seatId);
+                }
+                sold[index] = true;
+            }
+        }
+
+        // Other processes' bookings are not recorded here
+        if (!m_sharedInventory) {
+            for (auto it = takenCounts.cbegin(); it != takenCounts.cend(); ++it) {
+                const QVector<bool> sold = soldSeats.value(it.key());
+                const int booked = int(std::count(sold.cbegin(), sold.cend(), true));
+                if (booked != it.value()) {
+                    return QString("Showing %1/%2: %3 seats taken but %4 booked")
+                        .arg(it.key().first).arg(it.key().second).arg(it.value()).arg(booked);
+                }
+            }
+        }
+
+        // Indexes cover every live booking once, in booking order
+        int indexed = 0;
+        for (auto it = m_bookingRowsByCustomer.cbegin(); it != m_bookingRowsByCustomer.cend(); ++it) {
+            int previous = -1;
+            for (int row : it.value()) {
+                if (row <= previous || row >= m_bookingData.size()
+                    || m_bookingData[row].customerHandle != it.key()
+                    || m_bookingData[row].cancelled) {
+                    return QString("Customer index of %1 is corrupt at row %2")
+                        .arg(m_customers.name(it.key())).arg(row);
+                }
+                previous = row;
+                ++indexed;
+            }
+        }
+        if (indexed != liveBookings) {
+            return QString("Customer index covers %1 of %2 bookings")
+                .arg(indexed).arg(liveBookings);
+        }
+        if (m_history.size() != m_bookingData.size()) {
+            return QString("Booking history has %1 rows for %2 bookings")
+                .arg(m_history.size()).arg(m_bookingData.size());
+        }
         return {};
+    };
+
+    const QString violation = check();
+
+    m_bookingMutex.unlock();
+    for (int i = showings.size() - 1; i >= 0; --i) {
+        showings[i].showing->mutex.unlock();
     }
-    
-    QVector<Seat*> availableSeats;
-    for (Seat* seat : movieIt.value()) {
-        if (seat->isAvailable()) {
-            availableSeats.append(seat);
+
+    if (!violation.isEmpty() && error) {
+        *error = violation;
+    }
+    return violation.isEmpty();
+}
+
+QSharedPointer<const SeatChartTemplate> BookingService::chartTemplate(const SeatMap& layout) const
+{
+    // Every hall lays out seats by capacity alone
+    QMutexLocker locker(&m_chartTemplateMutex);
+    QSharedPointer<const SeatChartTemplate>& entry = m_chartTemplates[layout.capacity()];
+    if (!entry) {
+        entry = QSharedPointer<const SeatChartTemplate>::create(layout);
+    }
+    return entry;
+}
+
+QSharedPointer<const BookingService::Catalog> BookingService::currentCatalog() const
+{
+    QReadLocker locker(&m_readWriteLock);
+    return m_catalog;
+}
+
+bool BookingService::carryOverSeats(const ShowingSeats& from, ShowingSeats& to)
+{
+    QVector<int> taken;
+    for (int i = 0; i < from.seats.size(); ++i) {
+        if (from.seatMap->isTaken(i)) {
+            if (i >= to.seats.size()) {
+                return false;
+            }
+            taken.append(i);
         }
     }
-    
-    return availableSeats;
+
+    to.seatMap->take(taken);
+    for (int seatIndex : taken) {
+        to.seats[seatIndex]->setStatus(Seat::Status::Reserved);
+        to.setTakenBit(seatIndex);
+    }
+    to.availableCount.storeRelease(to.seats.size() - taken.size());
+    to.admission.setMaxActive(from.admission.maxActive());
+    to.admission.setSoldOut(taken.size() == to.seats.size());
+    to.waitlist = from.waitlist;
+    to.lineage = from.lineage;
+
+    // The layout changed: clients holding an older version need a full snapshot
+    to.version = from.version + 1;
+    to.changes.reset(to.version);
+
+    return true;
 }
 
-bool BookingService::reserveSeats(int theaterId, int movieId,
-                                  const QStringList& seatIds,
-                                  const QString& customerName)
+bool BookingService::precheckSeats(const ShowingSeats& showing, const QStringList& seatIds,
+                                   ReservationResult& result) const
 {
-    // Use exclusive lock for reservation (critical section)
-    QMutexLocker reservationLocker(&m_reservationMutex);
-    
-    // Find theater and movie seats
-    auto theaterIt = m_theaterSeats.find(theaterId);
-    if (theaterIt == m_theaterSeats.end()) {
-        emit reservationFailed("Theater not found");
+    using Code = ReservationResult::Code;
+
+    // With a shared inventory, other processes' bookings count too
+    result.freeCount = showing.shared ? showing.shared->freeCount(showing.sharedSlot)
+                                      : showing.availableCount.loadAcquire();
+    if (result.freeCount == 0) {
+        result.fail(Code::SoldOut);
         return false;
     }
-    
-    auto movieIt = theaterIt->movieSeats.find(movieId);
-    if (movieIt == theaterIt->movieSeats.end()) {
-        emit reservationFailed("Movie not showing in this theater");
+
+    if (result.freeCount < seatIds.size()) {
+        result.fail(Code::NotEnoughSeats);
         return false;
     }
-    
-    // Verify all seats are available
-    QVector<Seat*> seatsToReserve;
-    for (const QString& seatId : seatIds) {
-        Seat* seat = nullptr;
-        for (Seat* s : movieIt.value()) {
-            if (s->getId() == seatId) {
-                seat = s;
-                break;
+
+    // Report every offending seat; unknown seats take precedence
+    for (int i = 0; i < seatIds.size(); ++i) {
+        const int seatIndex = showing.seatMap->indexOf(seatIds[i]);
+        if (seatIndex < 0) {
+            if (result.code != Code::SeatNotFound) {
+                result.seatCount = 0;
+                result.fail(Code::SeatNotFound);
             }
+            result.addSeat(i);
+            continue;
         }
-        
-        if (!seat) {
-            emit reservationFailed(QString("Seat %1 not found").arg(seatId));
-            return false;
+
+        // Taken bits are cleared only by cancellations, so a set bit is a
+        // definite no as of this read
+        if (result.code != Code::SeatNotFound
+            && (showing.isTakenBitSet(seatIndex)
+                || (showing.shared && showing.shared->isTaken(showing.sharedSlot, seatIndex)))) {
+            result.fail(Code::SeatTaken);
+            result.addSeat(seatIndex);
         }
-        
-        if (!seat->isAvailable()) {
-            emit reservationFailed(QString("Seat %1 is not available").arg(seatId));
-            return false;
+    }
+
+    return result.ok();
+}
+
+bool BookingService::prepareSeats(const ShowingSeats& showing, const QStringList& seatIds,
+                                  QVector<int>& seatIndices, ReservationResult& result) const
+{
+    TRACE_SCOPE("seatLookup");
+    using Code = ReservationResult::Code;
+
+    seatIndices.clear();
+    seatIndices.reserve(seatIds.size());
+
+    // Report every offending seat; unknown seats come first, then taken, then repeated
+    auto report = [&result](Code code, int seat) {
+        if (result.ok() || code < result.code) {
+            result.seatCount = 0;
+            result.fail(code);
+        }
+        if (code == result.code) {
+            result.addSeat(seat);
+        }
+    };
+
+    for (int i = 0; i < seatIds.size(); ++i) {
+        const int seatIndex = showing.seatMap->indexOf(seatIds[i]);
+        if (seatIndex < 0) {
+            report(Code::SeatNotFound, i);
+        } else if (showing.seatMap->isTaken(seatIndex)) {
+            report(Code::SeatTaken, seatIndex);
+        } else if (seatIndices.contains(seatIndex)) {
+            report(Code::DuplicateSeat, seatIndex);
+        } else {
+            seatIndices.append(seatIndex);
+        }
+    }
+
+    return result.ok();
+}
+
+int BookingService::occupancyPercent(const ShowingSeats& showing)
+{
+    const int capacity = showing.seats.size();
+    if (capacity == 0) {
+        return 100;
+    }
+    return (capacity - showing.availableCount.loadAcquire()) * 100 / capacity;
+}
+
+QVector<int> BookingService::priceSeats(const PricingEngine& pricing, const ShowingSeats& showing,
+                                        const QVector<int>& seatIndices) const
+{
+    TRACE_SCOPE("priceSeats");
+    const int capacity = showing.seats.size();
+    const int occupancy = occupancyPercent(showing);
+    const int hour = QTime::currentTime().hour();
+
+    QVector<int> seatPrices;
+    seatPrices.reserve(seatIndices.size());
+    for (int seatIndex : seatIndices) {
+        seatPrices.append(pricing.priceOf(seatIndex, capacity, occupancy, hour));
+    }
+    return seatPrices;
+}
+
+bool BookingService::claimSharedSeats(ShowingSeats& showing, const QVector<int>& seatIndices,
+                                      ReservationResult& result)
+{
+    if (!showing.shared) {
+        return true;
+    }
+
+    int conflictingSeat = -1;
+    if (showing.shared->beginClaim(showing.sharedSlot, seatIndices, &conflictingSeat)) {
+        return true;
+    }
+
+    if (conflictingSeat >= 0) {
+        result.fail(ReservationResult::Code::SeatTaken).addSeat(conflictingSeat);
+    } else {
+        result.fail(ReservationResult::Code::SharedInventoryUnavailable);
+    }
+    return false;
+}
+
+void BookingService::finishSharedClaim(ShowingSeats& showing, bool commit)
+{
+    if (!showing.shared) {
+        return;
+    }
+
+    if (commit) {
+        showing.shared->commitClaim(showing.sharedSlot);
+    } else {
+        showing.shared->abortClaim(showing.sharedSlot);
+    }
+}
+
+void BookingService::commitSeats(ShowingSeats& showing, const QVector<int>& seatIndices)
+{
+    TRACE_SCOPE("updateSeatStatus");
+    showing.seatMap->take(seatIndices);
+    for (int seatIndex : seatIndices) {
+        showing.seats[seatIndex]->setStatus(Seat::Status::Reserved);
+        showing.setTakenBit(seatIndex);
+    }
+
+    // Publish the change as one new seat map version
+    ++showing.version;
+    for (int seatIndex : seatIndices) {
+        showing.changes.record(showing.version, seatIndex);
+    }
+
+    // Last seats gone: turn the waiting room away
+    const int taken = seatIndices.size();
+    if (showing.availableCount.fetchAndSubOrdered(taken) == taken) {
+        showing.admission.setSoldOut(true);
+    }
+}
+
+void BookingService::releaseSeats(ShowingSeats& showing, const QVector<int>& seatIndices)
+{
+    TRACE_SCOPE("releaseSeats");
+
+    // Free seats stay out, so the count never grows past what was taken
+    QVector<int> taken;
+    taken.reserve(seatIndices.size());
+    for (int seatIndex : seatIndices) {
+        if (seatIndex >= 0 && showing.seatMap->isTaken(seatIndex) && !taken.contains(seatIndex)) {
+            taken.append(seatIndex);
+        }
+    }
+    if (taken.isEmpty()) {
+        return;
+    }
+
+    showing.seatMap->release(taken);
+    for (int seatIndex : std::as_const(taken)) {
+        showing.seats[seatIndex]->setStatus(Seat::Status::Available);
+        showing.clearTakenBit(seatIndex);
+    }
+
+    ++showing.version;
+    for (int seatIndex : std::as_const(taken)) {
+        showing.changes.record(showing.version, seatIndex);
+    }
+
+    if (showing.availableCount.fetchAndAddOrdered(taken.size()) == 0) {
+        showing.admission.setSoldOut(false);
+    }
+
+    if (showing.shared && !showing.shared->release(showing.sharedSlot, taken)) {
+        qWarning() << "Released seats stay taken in the shared inventory";
+    }
+}
+
+QVector<BookingService::Promotion> BookingService::promoteWaitlist(int theaterId, int movieId,
+                                                                   ShowingSeats& showing,
+                                                                   const PricingEngine& pricing)
+{
+    QVector<Promotion> promotions;
+    if (m_isReplica.loadAcquire()) {
+        return promotions;  // The primary's promotions arrive as bookings
+    }
+
+    // First fit in joining order: a party that does not fit lets smaller ones pass
+    for (int i = 0; i < showing.waitlist.size();) {
+        const WaitlistEntry& entry = showing.waitlist[i];
+        const QVector<int> seatIndices = pickWaitlistSeats(showing, entry.seatCount);
+        if (seatIndices.isEmpty()) {
+            ++i;
+            continue;
+        }
+
+        ReservationResult result;
+        if (!claimSharedSeats(showing, seatIndices, result)) {
+            break;  // Another process got there first; retried on the next release
+        }
+
+        const QVector<int> seatPrices = priceSeats(pricing, showing, seatIndices);
+        commitSeats(showing, seatIndices);
+
+        Promotion promotion{entry.id, 0, entry.customerId, theaterId, movieId, {}, nullptr};
+        for (int seatIndex : seatIndices) {
+            promotion.seatIds.append(showing.seatMap->seatId(seatIndex));
+        }
+        {
+            QMutexLocker bookingLocker(&m_bookingMutex);
+            promotion.booking = recordBooking(theaterId, movieId, showing.lineage,
+                                              promotion.seatIds, seatIndices, entry.customerId,
+                                              seatPrices, entry.quotaHold);
+            promotion.bookingId = m_bookingData.last().id;
+        }
+        finishSharedClaim(showing, true);
+
+        promotions.append(promotion);
+        showing.waitlist.removeAt(i);
+    }
+    return promotions;
+}
+
+QVector<int> BookingService::pickWaitlistSeats(const ShowingSeats& showing, int seatCount)
+{
+    const int capacity = showing.seatMap->capacity();
+    auto isFree = [&showing](int seatIndex) {
+        return !showing.seatMap->isTaken(seatIndex)
+               && !(showing.shared && showing.shared->isTaken(showing.sharedSlot, seatIndex));
+    };
+
+    // Smallest run of adjacent free seats that holds the party
+    int bestStart = -1;
+    int bestLength = 0;
+    QVector<int> lowest;
+    for (int i = 0; i < capacity;) {
+        if (!isFree(i)) {
+            ++i;
+            continue;
+        }
+        const int start = i;
+        for (; i < capacity && isFree(i); ++i) {
+            if (lowest.size() < seatCount) {
+                lowest.append(i);
+            }
+        }
+        const int length = i - start;
+        if (length >= seatCount && (bestStart < 0 || length < bestLength)) {
+            bestStart = start;
+            bestLength = length;
         }
-        
-        seatsToReserve.append(seat);
     }
-    
-    // Reserve all seats atomically
-    for (Seat* seat : seatsToReserve) {
-        seat->setStatus(Seat::Status::Reserved);
+
+    if (bestStart < 0) {
+        return lowest.size() == seatCount ? lowest : QVector<int>();
+    }
+
+    QVector<int> seatIndices(seatCount);
+    std::iota(seatIndices.begin(), seatIndices.end(), bestStart);
+    return seatIndices;
+}
+
+void BookingService::emitPromotions(const QVector<Promotion>& promotions)
+{
+    for (const Promotion& promotion : promotions) {
+        emit seatsReserved(promotion.theaterId, promotion.movieId, promotion.seatIds);
+        if (promotion.booking) {
+            emit bookingCreated(promotion.booking);
+        }
+        emit waitlistPromoted(promotion.waitlistId, promotion.bookingId, promotion.customerId);
     }
-    
-    // Get current booking ID and increment for next booking
-    int bookingId = m_nextBookingId++;
-    
+}
+
+Booking* BookingService::recordBooking(int theaterId, int movieId, quint64 showingLineage,
+                                       const QStringList& seatIds, const QVector<int>& seatIndices,
+                                       const QString& customerName, const QVector<int>& seatPrices,
+                                       const RateLimiter::QuotaHold& quotaHold)
+{
+    // Get current booking ID and increment for next booking; with a shared
+    // inventory IDs come from the segment so they are unique across processes
+    int bookingId = m_sharedInventory ? m_sharedInventory->nextBookingId() : m_nextBookingId++;
+
     // Store booking data (thread-safe without creating QObject in wrong thread)
+    TRACE_BEGIN(dataSpan, "bookingData");
     BookingData bookingData;
     bookingData.id = bookingId;
     bookingData.customerId = customerName;
     bookingData.movieId = movieId;
     bookingData.theaterId = theaterId;
+    bookingData.showingLineage = showingLineage;
     bookingData.seatIds = seatIds;
+    bookingData.seatPrices = seatPrices;
     bookingData.bookingTime = QDateTime::currentDateTime();
-    
-    m_bookingData.append(bookingData);
-    
-    // Create Booking QObject only in the service's thread using QMetaObject::invokeMethod
-    // This ensures the object is created in the correct thread
-    Booking* booking = nullptr;
-    if (QThread::currentThread() == this->thread()) {
-        // We're in the correct thread, create directly
-        booking = new Booking(bookingId, customerName, movieId, theaterId, seatIds, this);
-        m_bookings.append(booking);
-    } else {
-        // We're in a different thread, defer creation to main thread
-        // For now, just store the data - booking objects can be created on-demand
-        // This is a safe approach for multi-threaded scenarios
-    }
-    
-    // Emit signals (these are thread-safe in Qt)
-    emit seatsReserved(theaterId, movieId, seatIds);
-    if (booking) {
-        emit bookingCreated(booking);
+    bookingData.quotaHold = quotaHold;
+    storeBooking(bookingData, seatIndices);
+    TRACE_END(dataSpan);
+
+    // Create Booking QObject only in the service's thread
+    // Off-thread bookings are kept as plain data; objects can be created on-demand
+    if (QThread::currentThread() != this->thread()) {
+        return nullptr;
     }
-    
-    return true;
+
+    TRACE_SCOPE("bookingObject");
+    Booking* booking = new Booking(bookingId, bookingData.customerId, movieId, theaterId, seatIds,
+                                   this);
+    m_bookings.append(booking);
+    return booking;
 }
 
-QVector<Booking*> BookingService::getBookings(const QString& customerName) const
+void BookingService::storeBooking(BookingData& bookingData, const QVector<int>& seatIndices)
 {
-    QReadLocker locker(&m_readWriteLock);
-    
-    QVector<Booking*> customerBookings;
-    for (Booking* booking : m_bookings) {
-        if (booking->getCustomerId() == customerName) {
-            customerBookings.append(booking);
-        }
+    // Intern the customer; every booking shares one copy of the name
+    bookingData.customerHandle = m_customers.intern(bookingData.customerId);
+    bookingData.customerId = m_customers.name(bookingData.customerHandle);
+    bookingData.totalPrice = std::accumulate(bookingData.seatPrices.cbegin(),
+                                             bookingData.seatPrices.cend(), 0);
+
+    m_bookingRowsByCustomer[bookingData.customerHandle].append(m_bookingData.size());
+    m_bookingData.append(bookingData);
+    m_history.append(bookingData.id, bookingData.theaterId, bookingData.movieId,
+                     bookingData.customerHandle, seatIndices, bookingData.totalPrice,
+                     bookingData.bookingTime.toSecsSinceEpoch());
+
+    if (m_replicationPublisher) {
+        ReplicationRecord record;
+        record.bookingId = bookingData.id;
+        record.theaterId = bookingData.theaterId;
+        record.movieId = bookingData.movieId;
+        record.customerId = bookingData.customerId;
+        record.seatIds = bookingData.seatIds;
+        record.seatPrices = bookingData.seatPrices;
+        record.bookedAtMs = bookingData.bookingTime.toMSecsSinceEpoch();
+        m_replicationPublisher->publish(record);
     }
-    
-    return customerBookings;
 }
 
-QVector<BookingService::BookingData> BookingService::getBookingData(const QString& customerName) const
+int BookingService::bookingRow(int bookingId) const
 {
-    QMutexLocker locker(&m_reservationMutex);
-    
-    QVector<BookingData> customerBookings;
-    for (const BookingData& data : m_bookingData) {
-        if (data.customerId == customerName) {
-            customerBookings.append(data);
+    // IDs are handed out in booking order
+    auto it = std::lower_bound(m_bookingData.cbegin(), m_bookingData.cend(), bookingId,
+                               [](const BookingData& booking, int id) { return booking.id < id; });
+    return it != m_bookingData.cend() && it->id == bookingId ? int(it - m_bookingData.cbegin())
+                                                              : -1;
+}
+
+void BookingService::markCancelled(int row)
+{
+    BookingData& bookingData = m_bookingData[row];
+    bookingData.cancelled = true;
+    m_bookingRowsByCustomer[bookingData.customerHandle].removeOne(row);
+    m_history.cancel(row);
+
+    // The object stays alive (it may have been handed out) but is no longer listed
+    for (int i = 0; i < m_bookings.size(); ++i) {
+        if (m_bookings[i]->getId() == bookingData.id) {
+            m_bookings.remove(i);
+            break;
         }
     }
-    
-    return customerBookings;
+
+    const quint64 sequence = m_bookingData.size() + m_cancelledRows.size() + 1;
+    m_cancelledRows.append(qMakePair(sequence, row));
+
+    if (m_replicationPublisher) {
+        ReplicationRecord record;
+        record.kind = ReplicationRecord::Kind::Cancellation;
+        record.bookingId = bookingData.id;
+        record.theaterId = bookingData.theaterId;
+        record.movieId = bookingData.movieId;
+        record.seatIds = bookingData.seatIds;
+        m_replicationPublisher->publish(record);
+    }
 }
 
-void BookingService::initializeSampleData()
+bool BookingService::applyReplicatedBooking(const ReplicationRecord& record)
 {
-    QWriteLocker locker(&m_readWriteLock);
-    
-    // Initialize movies (Qt manages memory via parent)
-    m_movies.append(new Movie(1, "The Matrix Resurrections", 148, "Sci-Fi", this));
-    m_movies.append(new Movie(2, "Dune: Part Two", 166, "Sci-Fi", this));
-    m_movies.append(new Movie(3, "Oppenheimer", 180, "Drama", this));
-    m_movies.append(new Movie(4, "Barbie", 114, "Comedy", this));
-    
-    // Initialize theaters (Qt manages memory via parent)
-    m_theaters.append(new Theater(1, "IMAX Hall", Theater::TOTAL_SEATS, this));
-    m_theaters.append(new Theater(2, "VIP Hall", Theater::TOTAL_SEATS, this));
-    m_theaters.append(new Theater(3, "Standard Hall A", Theater::TOTAL_SEATS, this));
-    
-    // Initialize seats for all theater-movie combinations
-    for (Theater* theater : m_theaters) {
-        for (Movie* movie : m_movies) {
-            initializeSeats(theater->getId(), movie->getId());
-        }
-    }
-}
-
-void BookingService::initializeSeats(int theaterId, int movieId)
-{
-    QVector<Seat*> seats;
-    seats.reserve(Theater::TOTAL_SEATS);
-    
-    for (int i = 1; i <= Theater::TOTAL_SEATS; ++i) {
-        QString seatId = QString("A%1").arg(i);
-        // Qt manages memory via parent (this)
-        Seat* seat = new Seat(seatId, Seat::Status::Available, this);
-        seats.append(seat);
-    }
-    
-    m_theaterSeats[theaterId].movieSeats[movieId] = seats;
+    // Log positions are counted from stored rows, so a record that is not
+    // stored must stop the stream rather than shift every later one
+    if (record.kind == ReplicationRecord::Kind::Cancellation) {
+        QString error;
+        if (!cancel(record.bookingId, &error)) {
+            // Only possible if the replica diverged from the primary
+            qWarning() << "Cannot apply replicated cancellation:" << error;
+            return false;
+        }
+        m_replicationLagMs.storeRelease(QDateTime::currentMSecsSinceEpoch()
+                                        - record.committedAtMs);
+        return true;
+    }
+
+    for (;;) {
+        const QSharedPointer<ShowingSeats> showing =
+            currentCatalog()->findShowing(record.theaterId, record.movieId);
+        if (!showing) {
+            qWarning() << "Replicated booking" << record.bookingId
+                       << "refers to an unknown showing";
+            return false;
+        }
+
+        QMutexLocker showingLocker(&showing->mutex);
+        if (showing->retired) {
+            continue;   // Replaced by a reload meanwhile
+        }
+
+        QVector<int> seatIndices;
+        ReservationResult result;
+        if (!prepareSeats(*showing, record.seatIds, seatIndices, result)) {
+            // Only possible if the replica diverged from the primary
+            qWarning() << "Cannot apply replicated booking" << record.bookingId << ":"
+                       << result.describe(record.seatIds);
+            return false;
+        }
+        commitSeats(*showing, seatIndices);
+
+        QMutexLocker bookingLocker(&m_bookingMutex);
+
+        BookingData bookingData;
+        bookingData.id = record.bookingId;
+        bookingData.customerId = record.customerId;
+        bookingData.movieId = record.movieId;
+        bookingData.theaterId = record.theaterId;
+        bookingData.showingLineage = showing->lineage;
+        bookingData.seatIds = record.seatIds;
+        bookingData.seatPrices = record.seatPrices;
+        bookingData.bookingTime = QDateTime::fromMSecsSinceEpoch(record.bookedAtMs);
+        storeBooking(bookingData, seatIndices);
+
+        // A promoted replica continues the primary's ID sequence
+        m_nextBookingId = qMax(m_nextBookingId, record.bookingId + 1);
+        break;
+    }
+
+    m_replicationLagMs.storeRelease(QDateTime::currentMSecsSinceEpoch() - record.committedAtMs);
+
+    emit seatsReserved(record.theaterId, record.movieId, record.seatIds);
+    return true;
 }
 
 QString BookingService::makeKey(int theaterId, int movieId) const
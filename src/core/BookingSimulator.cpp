@@ -0,0 +1,755 @@
+#include "core/BookingSimulator.h"
+#include "core/BookingService.h"
+#include "core/CatalogLoader.h"
+#include "models/Seat.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QSet>
+#include <QThread>
+
+namespace {
+
+constexpr quint64 FNV_OFFSET = 14695981039346656037ull;
+constexpr quint64 FNV_PRIME = 1099511628211ull;
+
+/// Lane of the calling thread, -1 outside the simulation
+thread_local int t_lane = -1;
+
+} // namespace
+
+QString BookingSimulator::Report::describe() const
+{
+    QString text = QString("seed %1: %2 operations, %3 steps, %4 switches, %5 bookings, "
+                           "%6 epochs, digest %7, %8 ms")
+                       .arg(seed).arg(operations).arg(steps).arg(switches).arg(bookings)
+                       .arg(epochs).arg(digest, 16, 16, QChar('0')).arg(elapsedMs);
+    if (!ok) {
+        text += QString("\nFAILED at step %1: %2").arg(failedStep).arg(error);
+        for (const QString& entry : trail) {
+            text += "\n  " + entry;
+        }
+    }
+    return text;
+}
+
+BookingSimulator::BookingSimulator(const Options& options)
+    : m_options(options)
+    , m_stopped(0)
+    , m_steps(0)
+    , m_random(options.seed)
+{
+    m_options.lanes = qMax(1, options.lanes);
+    m_options.clients = qMax(m_options.lanes + 1, options.clients);
+    m_options.theaters = qMax(1, options.theaters);
+    m_options.movies = qMax(1, options.movies);
+    m_options.capacity = qBound(3, options.capacity, CatalogData::MAX_CAPACITY - 4);
+    m_options.operations = qMax(0, options.operations);
+    m_options.checkEvery = qMax(0, options.checkEvery);
+
+    m_clientNames.reserve(m_options.clients);
+    for (int i = 0; i < m_options.clients; ++i) {
+        m_clientNames.append(QString("client-%1").arg(i));
+    }
+    m_seatIds.reserve(m_options.capacity + 4);
+    for (int i = 1; i <= m_options.capacity + 4; ++i) {
+        m_seatIds.append(QString("A%1").arg(i));
+    }
+
+    m_report.seed = options.seed;
+    m_report.digest = FNV_OFFSET;
+}
+
+BookingSimulator::~BookingSimulator()
+{
+    // After a deadlock the stuck lanes (and the service they use) are abandoned
+    if (!m_finished && !m_lanes.isEmpty()) {
+        return;
+    }
+    qDeleteAll(m_lanes);
+    delete m_service;
+}
+
+BookingSimulator::Report BookingSimulator::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    m_laneAlive.fill(true, m_options.lanes);
+    m_laneBusy.fill(false, m_options.lanes);
+    m_aliveLanes = m_options.lanes;
+    m_clientBusy.fill(false, m_options.clients);
+    for (int lane = 0; lane < m_options.lanes; ++lane) {
+        m_lanes.append(QThread::create([this, lane]() { runLane(lane); }));
+    }
+    for (QThread* lane : std::as_const(m_lanes)) {
+        lane->start();
+    }
+
+    // Watchdog: a lane blocked inside the service stops the steps
+    bool stalled = false;
+    int blockedLane = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        quint64 lastSteps = m_steps.loadRelaxed();
+        QElapsedTimer idle;
+        idle.start();
+        while (!m_finished && !stopped()) {
+            m_stateChanged.wait(&m_mutex, 100);
+            // This thread owns the service's seats but runs no event loop:
+            // showings retired by the lanes' reloads are deleted here
+            QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+            const quint64 steps = m_steps.loadRelaxed();
+            if (steps != lastSteps) {
+                lastSteps = steps;
+                idle.restart();
+            } else if (!m_finished && idle.elapsed() > m_options.stallTimeoutMs) {
+                stalled = true;
+                blockedLane = m_current;
+                m_stopped.storeRelease(1);
+                m_batonMoved.wakeAll();
+            }
+        }
+    }
+
+    if (stalled) {
+        Report report;
+        report.seed = m_options.seed;
+        report.steps = m_steps.loadRelaxed();
+        report.failedStep = report.steps;
+        report.error = QString("No progress for %1 ms: lane %2 is blocked (deadlock?)")
+                           .arg(m_options.stallTimeoutMs).arg(blockedLane);
+        report.elapsedMs = timer.elapsed();
+        return report;
+    }
+
+    for (QThread* lane : std::as_const(m_lanes)) {
+        lane->wait();
+    }
+    m_finished = true;
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+
+    m_report.ok = m_report.error.isEmpty();
+    m_report.steps = m_steps.loadRelaxed();
+    m_report.elapsedMs = timer.elapsed();
+    return m_report;
+}
+
+void BookingSimulator::onInterleave(void* context, const char* point)
+{
+    if (t_lane >= 0) {
+        static_cast<BookingSimulator*>(context)->step(t_lane, point);
+    }
+}
+
+void BookingSimulator::runLane(int lane)
+{
+    t_lane = lane;
+
+    // Wait for the first turn
+    {
+        QMutexLocker locker(&m_mutex);
+        while (m_current != lane && !stopped()) {
+            m_batonMoved.wait(&m_mutex);
+        }
+    }
+
+    while (!stopped()) {
+        if (!m_service && !startEpoch()) {
+            return;
+        }
+
+        if (m_draining || m_started >= m_options.operations) {
+            if (m_inFlight > 0) {
+                // Let an operation in flight finish
+                int target = int(m_random.bounded(quint32(m_options.lanes)));
+                while (!m_laneBusy[target]) {
+                    target = (target + 1) % m_options.lanes;
+                }
+                if (!passTo(target, lane)) {
+                    return;
+                }
+                continue;
+            }
+
+            if (m_epochOperations > 0 && !closeEpoch()) {
+                return;
+            }
+            if (m_started >= m_options.operations) {
+                retire(lane);
+                return;
+            }
+            if (!startEpoch()) {
+                return;
+            }
+            continue;
+        }
+
+        const int client = pickClient();
+        ++m_started;
+        ++m_epochOperations;
+        ++m_inFlight;
+        m_laneBusy[lane] = true;
+        m_clientBusy[client] = true;
+
+        if (!runOperation(client)) {
+            return;
+        }
+
+        m_clientBusy[client] = false;
+        m_laneBusy[lane] = false;
+        --m_inFlight;
+        ++m_report.operations;
+        m_draining = epochFull();
+
+        if (!step(lane, "client.done")) {
+            return;
+        }
+    }
+}
+
+bool BookingSimulator::step(int lane, const char* point)
+{
+    if (stopped()) {
+        return false;
+    }
+
+    const quint64 steps = m_steps.fetchAndAddRelaxed(1) + 1;
+    m_trail[steps % TRAIL_LENGTH] = {steps, lane, point};
+    mix(quint64(lane));
+    mix(point);
+
+    if (m_options.checkEvery > 0 && steps % quint64(m_options.checkEvery) == 0) {
+        QString error;
+        if (!m_service->verifyInvariants(&error)) {
+            return fail(error);
+        }
+    }
+
+    if (m_aliveLanes > 1 && m_random.generateDouble() < m_options.switchChance) {
+        // Any other live lane, uniformly
+        int skip = int(m_random.bounded(quint32(m_aliveLanes - 1)));
+        int target = 0;
+        for (;; ++target) {
+            if (target != lane && m_laneAlive[target] && skip-- == 0) {
+                break;
+            }
+        }
+        ++m_report.switches;
+        return passTo(target, lane);
+    }
+    return true;
+}
+
+bool BookingSimulator::passTo(int target, int lane)
+{
+    QMutexLocker locker(&m_mutex);
+    m_current = target;
+    m_batonMoved.wakeAll();
+    while (m_current != lane && !stopped()) {
+        m_batonMoved.wait(&m_mutex);
+    }
+    return !stopped();
+}
+
+void BookingSimulator::retire(int lane)
+{
+    m_laneAlive[lane] = false;
+    --m_aliveLanes;
+
+    QMutexLocker locker(&m_mutex);
+    if (m_aliveLanes == 0) {
+        m_finished = true;
+        m_stateChanged.wakeAll();
+        return;
+    }
+    int target = 0;
+    while (!m_laneAlive[target]) {
+        ++target;
+    }
+    m_current = target;
+    m_batonMoved.wakeAll();
+}
+
+bool BookingSimulator::fail(const QString& error)
+{
+    if (stopped()) {
+        return false;
+    }
+
+    m_report.error = error;
+    m_report.failedStep = m_steps.loadRelaxed();
+    for (quint64 i = 0; i < quint64(TRAIL_LENGTH); ++i) {
+        const TrailEntry& entry = m_trail[(m_report.failedStep + 1 + i) % TRAIL_LENGTH];
+        if (entry.point) {
+            m_report.trail.append(
+                QString("step %1 lane %2 %3").arg(entry.step).arg(entry.lane).arg(entry.point));
+        }
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_stopped.storeRelease(1);
+    m_batonMoved.wakeAll();
+    m_stateChanged.wakeAll();
+    return false;
+}
+
+bool BookingSimulator::runOperation(int client)
+{
+    const int roll = int(m_random.bounded(100));
+    if (roll < 34) {
+        return reserve(client);
+    }
+    if (roll < 40) {
+        return cancelBooking(client);
+    }
+    if (roll < 65) {
+        return reserveKeyed(client);
+    }
+    if (roll < 77) {
+        return reserveGroup(client);
+    }
+    if (roll < 85) {
+        return checkAvailableSeats();
+    }
+    if (roll < 88) {
+        return joinWaitlist();
+    }
+    if (roll < 98) {
+        return checkBookingDetails(client);
+    }
+    return reloadCatalog();
+}
+
+bool BookingSimulator::reserve(int client)
+{
+    const Showing showing = pickShowing();
+    const QStringList seatIds = pickSeats(showing, 1 + int(m_random.bounded(3)));
+
+    const ReservationResult result = m_service->reserveSeats(showing.theaterId, showing.movieId,
+                                                             seatIds, m_clientNames[client]);
+    if (stopped()) {
+        return false;
+    }
+    mix(quint64(result.code));
+    return !result || recordBooking(client, showing, seatIds, result.bookingId);
+}
+
+bool BookingSimulator::reserveKeyed(int client)
+{
+    ClientState& state = m_clients[client];
+    const int roll = state.lastKey.isEmpty() ? 0 : int(m_random.bounded(100));
+
+    if (roll >= 80 && state.lastBookingId > 0) {
+        // Same key, different request: must be refused
+        QStringList seatIds = state.lastSeats;
+        seatIds.append(m_seatIds[0]);
+        const ReservationResult result = m_service->reserveSeats(
+            state.lastShowing.theaterId, state.lastShowing.movieId, seatIds,
+            m_clientNames[client], state.lastKey);
+        if (stopped()) {
+            return false;
+        }
+        mix(quint64(result.code));
+        if (result.code != ReservationResult::Code::IdempotencyMismatch) {
+            return fail(QString("Key %1 reused for a different request returned %2")
+                            .arg(state.lastKey, ReservationResult::codeName(result.code)));
+        }
+        return true;
+    }
+
+    if (roll < 50) {
+        state.lastKey = QString("%1-key-%2").arg(m_clientNames[client]).arg(++state.keySerial);
+        state.lastShowing = pickShowing();
+        state.lastSeats = pickSeats(state.lastShowing, 1 + int(m_random.bounded(3)));
+        state.lastBookingId = 0;
+        state.lastCancelled = false;
+    }
+
+    // New key, or a retry of the last one
+    int bookingId = 0;
+    const ReservationResult result = m_service->reserveSeats(
+        state.lastShowing.theaterId, state.lastShowing.movieId, state.lastSeats,
+        m_clientNames[client], state.lastKey, &bookingId);
+    if (stopped()) {
+        return false;
+    }
+    mix(quint64(result.code));
+
+    if (state.lastBookingId > 0) {
+        // A retry after cancelling must not report the seats as held
+        const ReservationResult::Code expected = state.lastCancelled
+                                                     ? ReservationResult::Code::BookingCancelled
+                                                     : ReservationResult::Code::Ok;
+        if (result.code != expected || bookingId != state.lastBookingId) {
+            return fail(QString("Retry of key %1 returned %2 (booking %3, first booked as %4)")
+                            .arg(state.lastKey, ReservationResult::codeName(result.code))
+                            .arg(bookingId).arg(state.lastBookingId));
+        }
+        return true;
+    }
+    if (!result) {
+        return true;
+    }
+    state.lastBookingId = bookingId;
+    return recordBooking(client, state.lastShowing, state.lastSeats, bookingId);
+}
+
+bool BookingSimulator::reserveGroup(int client)
+{
+    const Showing first = pickShowing();
+    Showing second = pickShowing();
+    while (second.theaterId == first.theaterId && second.movieId == first.movieId) {
+        if (m_options.theaters * m_options.movies == 1) {
+            return reserve(client);
+        }
+        second = pickShowing();
+    }
+
+    const QVector<BookingService::ShowingRequest> requests = {
+        {first.theaterId, first.movieId, pickSeats(first, 1 + int(m_random.bounded(2)))},
+        {second.theaterId, second.movieId, pickSeats(second, 1 + int(m_random.bounded(2)))},
+    };
+    const ReservationResult result = m_service->reserveGroup(requests, m_clientNames[client]);
+    if (stopped()) {
+        return false;
+    }
+    mix(quint64(result.code));
+    if (!result) {
+        return true;
+    }
+    // The parts are booked under one lock in (theaterId, movieId) order,
+    // so their IDs are consecutive in that order
+    const bool firstLower = qMakePair(first.theaterId, first.movieId)
+                            < qMakePair(second.theaterId, second.movieId);
+    return recordBooking(client, first, requests[0].seatIds,
+                         result.bookingId + (firstLower ? 0 : 1))
+           && recordBooking(client, second, requests[1].seatIds,
+                            result.bookingId + (firstLower ? 1 : 0));
+}
+
+bool BookingSimulator::cancelBooking(int client)
+{
+    ClientState& state = m_clients[client];
+    if (state.held.isEmpty()) {
+        return true;
+    }
+
+    // Leave the model first: once the service frees the seats, another
+    // lane may book them before this call returns
+    const Held held = state.held.takeAt(int(m_random.bounded(quint32(state.held.size()))));
+    ++m_releases[showingIndex(held.showing)];
+    QVector<bool>& sold = m_sold[showingIndex(held.showing)];
+    for (const QString& seatId : held.seatIds) {
+        sold[m_seatIds.indexOf(seatId)] = false;
+        --m_soldTotal;
+    }
+    --state.bookings;
+    ++m_cancelledBookings;
+    if (held.bookingId == state.lastBookingId) {
+        state.lastCancelled = true;
+    }
+
+    QString error;
+    const bool cancelled = m_service->cancelBooking(held.bookingId, &error);
+    if (stopped()) {
+        return false;
+    }
+    mix(quint64(cancelled));
+    if (!cancelled) {
+        return fail(QString("%1 cannot cancel booking %2: %3")
+                        .arg(m_clientNames[client]).arg(held.bookingId).arg(error));
+    }
+    return true;
+}
+
+bool BookingSimulator::joinWaitlist()
+{
+    // Each party is its own customer, so promotions never change what a
+    // busy client expects to see
+    const Showing showing = pickShowing();
+    const int seatCount = 1 + int(m_random.bounded(3));
+    const QString customer = QString("waitlist-%1").arg(++m_waitlistSerial);
+
+    QString error;
+    const int waitlistId = m_service->joinWaitlist(showing.theaterId, showing.movieId, seatCount,
+                                                   customer, &error);
+    if (stopped()) {
+        return false;
+    }
+    mix(quint64(waitlistId));
+    if (waitlistId == 0) {
+        return fail(QString("%1 cannot join the waitlist of %2/%3: %4")
+                        .arg(customer).arg(showing.theaterId).arg(showing.movieId).arg(error));
+    }
+    return true;
+}
+
+bool BookingSimulator::checkAvailableSeats()
+{
+    const Showing showing = pickShowing();
+    const int showingAt = showingIndex(showing);
+    const QVector<bool> soldBefore = m_sold[showingAt];
+    const int releasesBefore = m_releases[showingAt];
+
+    const BookingService::PinnedList<Seat> seats =
+        m_service->getAvailableSeats(showing.theaterId, showing.movieId);
+    if (stopped()) {
+        return false;
+    }
+    mix(quint64(seats.size()));
+
+    // The answer may reflect any moment of the call (one racing a reload
+    // reads the version being replaced), so only seats that stayed sold
+    // throughout must be missing
+    if (m_releases[showingAt] != releasesBefore) {
+        return true;
+    }
+    const QVector<bool>& sold = m_sold[showingAt];
+    for (const Seat* seat : seats) {
+        const int index = m_seatIds.indexOf(seat->getId());
+        if (index >= 0 && soldBefore[index] && sold[index]) {
+            return fail(QString("Showing %1/%2: sold seat %3 is listed as available")
+                            .arg(showing.theaterId).arg(showing.movieId).arg(seat->getId()));
+        }
+    }
+    return true;
+}
+
+bool BookingSimulator::checkBookingDetails(int client)
+{
+    // The client has no other operation in flight, so its count is exact
+    const QVector<BookingService::BookingDetails> details =
+        m_service->getBookingDetails(m_clientNames[client]);
+    if (stopped()) {
+        return false;
+    }
+    mix(quint64(details.size()));
+    if (details.size() != m_clients[client].bookings) {
+        return fail(QString("%1 sees %2 bookings, expected %3")
+                        .arg(m_clientNames[client]).arg(details.size())
+                        .arg(m_clients[client].bookings));
+    }
+    return true;
+}
+
+bool BookingSimulator::reloadCatalog()
+{
+    CatalogData catalog;
+    for (int movieId = 1; movieId <= m_options.movies; ++movieId) {
+        catalog.movies.append({movieId, QString("Movie %1").arg(movieId), 100, "Drama"});
+    }
+    QVector<int> capacities;
+    for (int theaterId = 1; theaterId <= m_options.theaters; ++theaterId) {
+        capacities.append(m_options.capacity - 2 + int(m_random.bounded(7)));
+        catalog.theaters.append({theaterId, QString("Hall %1").arg(theaterId),
+                                 capacities.last()});
+        for (int movieId = 1; movieId <= m_options.movies; ++movieId) {
+            catalog.showings.append({theaterId, movieId});
+        }
+    }
+
+    // Fails when a hall would lose a sold seat
+    const bool loaded = m_service->loadCatalog(catalog);
+    if (stopped()) {
+        return false;
+    }
+    mix(quint64(loaded));
+    if (loaded) {
+        m_capacities = capacities;
+    }
+    return true;
+}
+
+bool BookingSimulator::recordBooking(int client, const Showing& showing,
+                                     const QStringList& seatIds, int bookingId)
+{
+    QVector<bool>& sold = m_sold[showingIndex(showing)];
+    for (const QString& seatId : seatIds) {
+        const int index = m_seatIds.indexOf(seatId);
+        if (sold[index]) {
+            return fail(QString("Showing %1/%2: seat %3 sold twice (booking %4)")
+                            .arg(showing.theaterId).arg(showing.movieId).arg(seatId)
+                            .arg(bookingId));
+        }
+        sold[index] = true;
+        ++m_soldTotal;
+    }
+    if (client >= 0) {
+        ++m_clients[client].bookings;
+        m_clients[client].held.append({bookingId, showing, seatIds});
+    } else {
+        ++m_promotedBookings;
+    }
+    ++m_report.bookings;
+    return true;
+}
+
+void BookingSimulator::recordPromotion(int bookingId)
+{
+    // Emitted right after the promotion's seatsReserved(), on the lane
+    // holding the baton
+    if (!stopped()) {
+        mix(quint64(bookingId));
+        recordBooking(-1, m_lastReserved, m_lastReservedSeats, bookingId);
+    }
+}
+
+bool BookingSimulator::startEpoch()
+{
+    CatalogData catalog;
+    for (int movieId = 1; movieId <= m_options.movies; ++movieId) {
+        catalog.movies.append({movieId, QString("Movie %1").arg(movieId), 100, "Drama"});
+    }
+    for (int theaterId = 1; theaterId <= m_options.theaters; ++theaterId) {
+        catalog.theaters.append({theaterId, QString("Hall %1").arg(theaterId),
+                                 m_options.capacity});
+        for (int movieId = 1; movieId <= m_options.movies; ++movieId) {
+            catalog.showings.append({theaterId, movieId});
+        }
+    }
+
+    delete m_service;
+    m_service = new BookingService;
+    QString error;
+    if (!m_service->loadCatalog(catalog, &error)) {
+        return fail("Cannot load the simulation catalog: " + error);
+    }
+    m_service->setInterleaveHook(&BookingSimulator::onInterleave, this);
+    QObject::connect(m_service, &BookingService::seatsReserved,
+                     [this](int theaterId, int movieId, const QStringList& seatIds) {
+                         m_lastReserved = {theaterId, movieId};
+                         m_lastReservedSeats = seatIds;
+                     });
+    QObject::connect(m_service, &BookingService::waitlistPromoted,
+                     [this](int, int bookingId, const QString&) { recordPromotion(bookingId); });
+
+    m_capacities.fill(m_options.capacity, m_options.theaters);
+    m_sold.fill(QVector<bool>(m_options.capacity + 4, false),
+                m_options.theaters * m_options.movies);
+    m_releases.fill(0, m_sold.size());
+    m_soldTotal = 0;
+    m_promotedBookings = 0;
+    m_cancelledBookings = 0;
+    m_clients.fill(ClientState(), m_options.clients);
+    m_epochOperations = 0;
+    m_draining = false;
+    ++m_report.epochs;
+    return true;
+}
+
+bool BookingSimulator::closeEpoch()
+{
+    QString error;
+    if (!m_service->verifyInvariants(&error)) {
+        return fail(error);
+    }
+
+    // Nothing in flight: the service must match the model exactly. The
+    // queries below must not hand the baton on.
+    m_service->setInterleaveHook(nullptr, nullptr);
+    for (int theaterId = 1; theaterId <= m_options.theaters; ++theaterId) {
+        for (int movieId = 1; movieId <= m_options.movies; ++movieId) {
+            const Showing showing{theaterId, movieId};
+            const QVector<bool>& sold = m_sold[showingIndex(showing)];
+
+            QSet<QString> available;
+            for (const Seat* seat : m_service->getAvailableSeats(theaterId, movieId)) {
+                available.insert(seat->getId());
+            }
+            // Every party that fits has been served
+            for (const BookingService::WaitlistEntry& entry :
+                 m_service->getWaitlist(theaterId, movieId)) {
+                if (entry.seatCount <= available.size()) {
+                    return fail(QString("Showing %1/%2 at rest: %3 waits for %4 of %5 free seats")
+                                    .arg(theaterId).arg(movieId).arg(entry.customerId)
+                                    .arg(entry.seatCount).arg(available.size()));
+                }
+            }
+            for (int i = 0; i < m_seatIds.size(); ++i) {
+                const bool expected = i < m_capacities[theaterId - 1] && !sold[i];
+                if (available.contains(m_seatIds[i]) != expected) {
+                    return fail(QString("Showing %1/%2 at rest: seat %3 should be %4")
+                                    .arg(theaterId).arg(movieId).arg(m_seatIds[i])
+                                    .arg(expected ? "available" : "unavailable"));
+                }
+            }
+        }
+    }
+
+    int bookings = 0;
+    for (int client = 0; client < m_clients.size(); ++client) {
+        bookings += m_clients[client].bookings;
+        if (m_clients[client].bookings > 0
+            && m_service->getBookingData(m_clientNames[client]).size()
+                   != m_clients[client].bookings) {
+            return fail(QString("%1 at rest: expected %2 bookings")
+                            .arg(m_clientNames[client]).arg(m_clients[client].bookings));
+        }
+    }
+    // The history keeps cancelled bookings
+    bookings += m_promotedBookings + m_cancelledBookings;
+    if (m_service->getBookingHistory().size() != bookings) {
+        return fail(QString("At rest: %1 bookings recorded, expected %2")
+                        .arg(m_service->getBookingHistory().size()).arg(bookings));
+    }
+
+    m_service->setInterleaveHook(&BookingSimulator::onInterleave, this);
+    m_epochOperations = 0;
+    return true;
+}
+
+bool BookingSimulator::epochFull() const
+{
+    int seats = 0;
+    for (int capacity : m_capacities) {
+        seats += capacity * m_options.movies;
+    }
+    // Mostly sold, or so many operations that further ones mostly fail
+    return m_soldTotal * 5 >= seats * 4 || m_epochOperations >= 50 * seats;
+}
+
+BookingSimulator::Showing BookingSimulator::pickShowing()
+{
+    return {1 + int(m_random.bounded(quint32(m_options.theaters))),
+            1 + int(m_random.bounded(quint32(m_options.movies)))};
+}
+
+QStringList BookingSimulator::pickSeats(const Showing& showing, int count)
+{
+    // Duplicates and seats lost to a smaller hall are allowed: they must fail cleanly
+    const quint32 capacity = quint32(m_capacities[showing.theaterId - 1]);
+    QStringList seatIds;
+    for (int i = 0; i < count; ++i) {
+        seatIds.append(m_seatIds[int(m_random.bounded(capacity))]);
+    }
+    return seatIds;
+}
+
+int BookingSimulator::pickClient()
+{
+    int client = int(m_random.bounded(quint32(m_options.clients)));
+    while (m_clientBusy[client]) {
+        client = int(m_random.bounded(quint32(m_options.clients)));
+    }
+    return client;
+}
+
+int BookingSimulator::showingIndex(const Showing& showing) const
+{
+    return (showing.theaterId - 1) * m_options.movies + showing.movieId - 1;
+}
+
+void BookingSimulator::mix(quint64 value)
+{
+    for (int i = 0; i < 8; ++i) {
+        m_report.digest = (m_report.digest ^ ((value >> (8 * i)) & 0xff)) * FNV_PRIME;
+    }
+}
+
+void BookingSimulator::mix(const char* text)
+{
+    for (; *text; ++text) {
+        m_report.digest = (m_report.digest ^ quint8(*text)) * FNV_PRIME;
+    }
+}
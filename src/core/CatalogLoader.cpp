@@ -0,0 +1,219 @@
+#include "core/CatalogLoader.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPair>
+#include <QSet>
+
+namespace {
+
+bool fail(QString* error, const QString& reason)
+{
+    if (error) {
+        *error = reason;
+    }
+    return false;
+}
+
+/**
+ * @brief Splits one CSV line, honouring double quotes ("" is a literal quote)
+ */
+QStringList splitCsvLine(const QString& line)
+{
+    QStringList fields;
+    QString field;
+    bool quoted = false;
+
+    for (qsizetype i = 0; i < line.size(); ++i) {
+        const QChar c = line[i];
+        if (quoted) {
+            if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+                field += '"';
+                ++i;
+            } else if (c == '"') {
+                quoted = false;
+            } else {
+                field += c;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            fields.append(field.trimmed());
+            field.clear();
+        } else {
+            field += c;
+        }
+    }
+    fields.append(field.trimmed());
+    return fields;
+}
+
+} // namespace
+
+bool CatalogData::validate(QString* error) const
+{
+    QSet<int> movieIds;
+    for (const MovieEntry& movie : movies) {
+        if (movieIds.contains(movie.id)) {
+            return fail(error, QString("Duplicate movie ID %1").arg(movie.id));
+        }
+        movieIds.insert(movie.id);
+    }
+
+    QSet<int> theaterIds;
+    for (const TheaterEntry& theater : theaters) {
+        if (theaterIds.contains(theater.id)) {
+            return fail(error, QString("Duplicate theater ID %1").arg(theater.id));
+        }
+        if (theater.capacity <= 0 || theater.capacity > MAX_CAPACITY) {
+            return fail(error, QString("Theater %1 has invalid capacity %2")
+                                   .arg(theater.id).arg(theater.capacity));
+        }
+        if (theater.numaNode < -1) {
+            return fail(error, QString("Theater %1 has invalid NUMA node %2")
+                                   .arg(theater.id).arg(theater.numaNode));
+        }
+        theaterIds.insert(theater.id);
+    }
+
+    QSet<QPair<int, int>> showingKeys;
+    for (const ShowingEntry& showing : showings) {
+        if (!theaterIds.contains(showing.theaterId)) {
+            return fail(error, QString("Showing refers to unknown theater %1").arg(showing.theaterId));
+        }
+        if (!movieIds.contains(showing.movieId)) {
+            return fail(error, QString("Showing refers to unknown movie %1").arg(showing.movieId));
+        }
+        const QPair<int, int> key(showing.theaterId, showing.movieId);
+        if (showingKeys.contains(key)) {
+            return fail(error, QString("Duplicate showing of movie %1 in theater %2")
+                                   .arg(showing.movieId).arg(showing.theaterId));
+        }
+        showingKeys.insert(key);
+    }
+
+    return true;
+}
+
+bool CatalogLoader::loadFile(const QString& path, CatalogData& catalog, QString* error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return fail(error, QString("Cannot open %1: %2").arg(path, file.errorString()));
+    }
+    const QByteArray data = file.readAll();
+
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    bool parsed = false;
+    if (suffix == "json") {
+        parsed = parseJson(data, catalog, error);
+    } else if (suffix == "csv") {
+        parsed = parseCsv(data, catalog, error);
+    } else {
+        return fail(error, QString("Unknown catalog format: %1").arg(path));
+    }
+
+    return parsed && catalog.validate(error);
+}
+
+bool CatalogLoader::parseJson(const QByteArray& data, CatalogData& catalog, QString* error)
+{
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(data, &parseError);
+    if (!document.isObject()) {
+        return fail(error, QString("Invalid JSON catalog: %1").arg(parseError.errorString()));
+    }
+
+    const QJsonObject root = document.object();
+    const QJsonArray movies = root.value("movies").toArray();
+    const QJsonArray theaters = root.value("theaters").toArray();
+    const QJsonArray showings = root.value("showings").toArray();
+
+    catalog = CatalogData();
+    catalog.movies.reserve(movies.size());
+    catalog.theaters.reserve(theaters.size());
+    catalog.showings.reserve(showings.size());
+
+    for (const QJsonValue& value : movies) {
+        const QJsonObject movie = value.toObject();
+        if (!movie.value("id").isDouble() || !movie.value("title").isString()) {
+            return fail(error, "Movie entries need a numeric id and a title");
+        }
+        catalog.movies.append({movie.value("id").toInt(), movie.value("title").toString(),
+                               movie.value("duration").toInt(),
+                               movie.value("genre").toString()});
+    }
+
+    for (const QJsonValue& value : theaters) {
+        const QJsonObject theater = value.toObject();
+        if (!theater.value("id").isDouble() || !theater.value("capacity").isDouble()) {
+            return fail(error, "Theater entries need a numeric id and capacity");
+        }
+        const QJsonValue numaNode = theater.value("numaNode");
+        if (!numaNode.isUndefined() && !numaNode.isDouble()) {
+            return fail(error, "Theater numaNode must be a number");
+        }
+        catalog.theaters.append({theater.value("id").toInt(), theater.value("name").toString(),
+                                 theater.value("capacity").toInt(), numaNode.toInt(-1)});
+    }
+
+    for (const QJsonValue& value : showings) {
+        const QJsonObject showing = value.toObject();
+        if (!showing.value("theaterId").isDouble() || !showing.value("movieId").isDouble()) {
+            return fail(error, "Showing entries need a numeric theaterId and movieId");
+        }
+        catalog.showings.append({showing.value("theaterId").toInt(),
+                                 showing.value("movieId").toInt()});
+    }
+
+    return true;
+}
+
+bool CatalogLoader::parseCsv(const QByteArray& data, CatalogData& catalog, QString* error)
+{
+    catalog = CatalogData();
+
+    const QStringList lines = QString::fromUtf8(data).split('\n');
+    for (int lineNumber = 1; lineNumber <= lines.size(); ++lineNumber) {
+        const QString line = lines[lineNumber - 1].trimmed();
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+
+        const QStringList fields = splitCsvLine(line);
+        const QString& type = fields[0];
+
+        bool ok1 = false;
+        bool ok2 = false;
+        if (type == "movie" && fields.size() == 5) {
+            const int id = fields[1].toInt(&ok1);
+            const int duration = fields[3].toInt(&ok2);
+            if (ok1 && ok2) {
+                catalog.movies.append({id, fields[2], duration, fields[4]});
+                continue;
+            }
+        } else if (type == "theater" && (fields.size() == 4 || fields.size() == 5)) {
+            const int id = fields[1].toInt(&ok1);
+            const int capacity = fields[3].toInt(&ok2);
+            bool ok3 = true;
+            const int numaNode = fields.size() == 5 ? fields[4].toInt(&ok3) : -1;
+            if (ok1 && ok2 && ok3) {
+                catalog.theaters.append({id, fields[2], capacity, numaNode});
+                continue;
+            }
+        } else if (type == "showing" && fields.size() == 3) {
+            const int theaterId = fields[1].toInt(&ok1);
+            const int movieId = fields[2].toInt(&ok2);
+            if (ok1 && ok2) {
+                catalog.showings.append({theaterId, movieId});
+                continue;
+            }
+        }
+
+        return fail(error, QString("Invalid catalog line %1: %2").arg(lineNumber).arg(line));
+    }
+
+    return true;
+}
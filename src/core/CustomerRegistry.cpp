@@ -0,0 +1,59 @@
+#include "core/CustomerRegistry.h"
+#include <QReadLocker>
+#include <QWriteLocker>
+
+quint32 CustomerRegistry::intern(const QString& customerId)
+{
+    {
+        QReadLocker locker(&m_lock);
+        auto it = m_handles.constFind(customerId);
+        if (it != m_handles.constEnd()) {
+            return it.value();
+        }
+    }
+
+    QWriteLocker locker(&m_lock);
+
+    // Another thread may have interned it between the two locks
+    auto it = m_handles.constFind(customerId);
+    if (it != m_handles.constEnd()) {
+        return it.value();
+    }
+
+    const quint32 handle = static_cast<quint32>(m_names.size());
+    m_names.append(customerId);
+    m_handles.insert(customerId, handle);
+    return handle;
+}
+
+quint32 CustomerRegistry::find(const QString& customerId) const
+{
+    QReadLocker locker(&m_lock);
+    return m_handles.value(customerId, INVALID_HANDLE);
+}
+
+QString CustomerRegistry::name(quint32 handle) const
+{
+    QReadLocker locker(&m_lock);
+    return handle < static_cast<quint32>(m_names.size()) ? m_names[handle] : QString();
+}
+
+int CustomerRegistry::size() const
+{
+    QReadLocker locker(&m_lock);
+    return m_names.size();
+}
+
+qint64 CustomerRegistry::memoryUsage() const
+{
+    QReadLocker locker(&m_lock);
+
+    qint64 bytes = m_names.capacity() * qint64(sizeof(QString));
+    // Hash nodes: key + value + bucket overhead (approximate)
+    bytes += m_handles.size() * qint64(sizeof(QString) + sizeof(quint32) + 2 * sizeof(void*));
+    for (const QString& name : m_names) {
+        // String payload is shared by both members and every booking
+        bytes += name.capacity() * qint64(sizeof(QChar));
+    }
+    return bytes;
+}
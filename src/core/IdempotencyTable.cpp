@@ -0,0 +1,124 @@
+#include "core/IdempotencyTable.h"
+#include <QMutexLocker>
+
+IdempotencyTable::IdempotencyTable(int capacity, qint64 ttlMs)
+    : m_shardCapacity(qMax(1, capacity / SHARD_COUNT))
+    , m_ttlMs(ttlMs)
+{
+    m_clock.start();
+}
+
+IdempotencyTable::Status IdempotencyTable::begin(const QString& key, const QByteArray& fingerprint,
+                                                 int& bookingId)
+{
+    Shard& shard = shardFor(key);
+    QMutexLocker locker(&shard.mutex);
+
+    for (;;) {
+        const qint64 nowMs = m_clock.elapsed();
+        auto it = shard.entries.find(key);
+
+        if (it == shard.entries.end() || (it->done && it->expiresAtMs <= nowMs)) {
+            if (it != shard.entries.end()) {
+                shard.entries.erase(it);
+            }
+            makeRoom(shard, nowMs);
+
+            Entry entry;
+            entry.fingerprint = fingerprint;
+            entry.serial = ++shard.nextSerial;
+            shard.entries.insert(key, entry);
+            shard.order.enqueue({key, entry.serial});
+            return Status::Started;
+        }
+
+        if (it->fingerprint != fingerprint) {
+            return Status::Mismatch;
+        }
+
+        if (it->done) {
+            bookingId = it->bookingId;
+            return Status::Replayed;
+        }
+
+        // The first attempt is still running; wait for its outcome
+        shard.settled.wait(&shard.mutex);
+    }
+}
+
+void IdempotencyTable::finish(const QString& key, int bookingId)
+{
+    Shard& shard = shardFor(key);
+    QMutexLocker locker(&shard.mutex);
+
+    auto it = shard.entries.find(key);
+    if (it != shard.entries.end()) {
+        it->bookingId = bookingId;
+        it->done = true;
+        it->expiresAtMs = m_clock.elapsed() + m_ttlMs;
+    }
+    shard.settled.wakeAll();
+}
+
+void IdempotencyTable::abandon(const QString& key)
+{
+    Shard& shard = shardFor(key);
+    QMutexLocker locker(&shard.mutex);
+
+    shard.entries.remove(key);
+    shard.settled.wakeAll();
+}
+
+int IdempotencyTable::size() const
+{
+    int total = 0;
+    for (const Shard& shard : m_shards) {
+        QMutexLocker locker(&shard.mutex);
+        total += shard.entries.size();
+    }
+    return total;
+}
+
+IdempotencyTable::Shard& IdempotencyTable::shardFor(const QString& key)
+{
+    return m_shards[qHash(key) % SHARD_COUNT];
+}
+
+void IdempotencyTable::makeRoom(Shard& shard, qint64 nowMs)
+{
+    // Abandoned and re-begun keys leave stale slots behind; compact now and then
+    if (shard.order.size() > 2 * m_shardCapacity) {
+        QQueue<Slot> live;
+        for (const Slot& slot : std::as_const(shard.order)) {
+            const auto it = shard.entries.constFind(slot.key);
+            if (it != shard.entries.cend() && it->serial == slot.serial) {
+                live.enqueue(slot);
+            }
+        }
+        shard.order.swap(live);
+    }
+
+    // Oldest keys first: drop expired ones, then evict until there is room.
+    // Keys still in progress are never evicted; they go to the back.
+    int budget = shard.order.size();
+    while (!shard.order.isEmpty() && budget-- > 0) {
+        const Slot& oldest = shard.order.head();
+        auto it = shard.entries.find(oldest.key);
+        if (it == shard.entries.end() || it->serial != oldest.serial) {
+            shard.order.dequeue();
+            continue;
+        }
+
+        const bool expired = it->done && it->expiresAtMs <= nowMs;
+        if (!expired && shard.entries.size() < m_shardCapacity) {
+            break;
+        }
+
+        if (it->done) {
+            shard.entries.erase(it);
+            shard.order.dequeue();
+        } else {
+            shard.order.enqueue(shard.order.dequeue());
+        }
+    }
+}
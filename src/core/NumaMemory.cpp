@@ -0,0 +1,117 @@
+#include "core/NumaMemory.h"
+#include <QFile>
+#include <new>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <cstring>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+/// Nodes a binding request can name (size of the mbind node mask)
+constexpr int MAX_NODES = 1024;
+constexpr int BITS_PER_WORD = int(sizeof(unsigned long) * 8);
+
+std::size_t pageSize()
+{
+#ifdef Q_OS_LINUX
+    const long size = sysconf(_SC_PAGESIZE);
+    if (size > 0) {
+        return std::size_t(size);
+    }
+#endif
+    return 4096;
+}
+
+std::size_t roundUp(std::size_t size, std::size_t multiple)
+{
+    return (size + multiple - 1) / multiple * multiple;
+}
+
+/**
+ * @brief Binds a page-aligned range to one node, moving pages already touched
+ */
+bool bindToNode(void* memory, std::size_t size, int node, QString* error)
+{
+    if (node >= MAX_NODES || node >= NumaMemory::nodeCount()) {
+        if (error) {
+            *error = QString("NUMA node %1 does not exist").arg(node);
+        }
+        return false;
+    }
+
+#if defined(Q_OS_LINUX) && defined(SYS_mbind)
+    // Kernel ABI values (numaif.h), spelled out to avoid a libnuma dependency
+    constexpr int MPOL_BIND_MODE = 2;
+    constexpr unsigned MPOL_MF_MOVE_FLAG = 1u << 1;
+
+    unsigned long mask[MAX_NODES / BITS_PER_WORD] = {};
+    mask[node / BITS_PER_WORD] = 1ul << (node % BITS_PER_WORD);
+    if (syscall(SYS_mbind, memory, size, MPOL_BIND_MODE, mask,
+                (unsigned long)MAX_NODES, MPOL_MF_MOVE_FLAG) == 0) {
+        return true;
+    }
+    if (error) {
+        *error = QString("Cannot bind memory to NUMA node %1: %2").arg(node).arg(strerror(errno));
+    }
+#else
+    Q_UNUSED(memory);
+    Q_UNUSED(size);
+    if (error) {
+        *error = QString("NUMA binding is not supported on this platform");
+    }
+#endif
+    return false;
+}
+
+} // namespace
+
+int NumaMemory::nodeCount()
+{
+    // e.g. "0", "0-3" or "0,2-3": the highest node ID comes last
+    static const int count = []() {
+        QFile file("/sys/devices/system/node/possible");
+        if (!file.open(QIODevice::ReadOnly)) {
+            return 1;
+        }
+        const QString ranges = QString::fromLatin1(file.readAll()).trimmed();
+        bool ok = false;
+        const qsizetype separator = qMax(ranges.lastIndexOf(','), ranges.lastIndexOf('-'));
+        const int highest = ranges.mid(separator + 1).toInt(&ok);
+        return ok && highest >= 0 ? highest + 1 : 1;
+    }();
+    return count;
+}
+
+void* NumaMemory::allocate(std::size_t size, std::size_t alignment, int node, QString* error)
+{
+    const std::size_t blockAlignment = effectiveAlignment(alignment, node);
+    // Bound blocks own whole pages, so binding never moves a neighbour
+    const std::size_t blockSize = roundUp(size, blockAlignment);
+    void* memory = ::operator new(blockSize, std::align_val_t(blockAlignment));
+
+    if (node >= 0) {
+        bindToNode(memory, blockSize, node, error);
+    }
+    return memory;
+}
+
+void NumaMemory::release(void* memory, std::size_t alignment, int node)
+{
+    if (memory) {
+        ::operator delete(memory, std::align_val_t(effectiveAlignment(alignment, node)));
+    }
+}
+
+std::size_t NumaMemory::effectiveAlignment(std::size_t alignment, int node)
+{
+    const std::size_t lineAligned = alignment < CACHE_LINE_SIZE ? CACHE_LINE_SIZE : alignment;
+    if (node < 0) {
+        return lineAligned;
+    }
+    const std::size_t page = pageSize();
+    return lineAligned < page ? page : lineAligned;
+}
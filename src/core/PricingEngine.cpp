@@ -0,0 +1,92 @@
+#include "core/PricingEngine.h"
+#include <algorithm>
+
+PricingEngine::PricingEngine(const QVector<SeatClass>& seatClasses, const QVector<Rule>& rules)
+    : m_seatClasses(seatClasses)
+{
+    if (m_seatClasses.isEmpty()) {
+        m_seatClasses.append({"Standard", 0, 0});
+    }
+
+    // A band starts at every threshold a rule tests, so all occupancies
+    // of a band match the same rules
+    QVector<int> bandStarts = {0};
+    for (const Rule& rule : rules) {
+        if (rule.minOccupancy > 0 && rule.minOccupancy <= 100) {
+            bandStarts.append(rule.minOccupancy);
+        }
+    }
+    std::sort(bandStarts.begin(), bandStarts.end());
+    bandStarts.erase(std::unique(bandStarts.begin(), bandStarts.end()), bandStarts.end());
+    m_bandCount = int(bandStarts.size());
+
+    m_occupancyBands.resize(101);
+    for (int occupancy = 0, band = 0; occupancy <= 100; ++occupancy) {
+        while (band + 1 < m_bandCount && bandStarts[band + 1] <= occupancy) {
+            ++band;
+        }
+        m_occupancyBands[occupancy] = band;
+    }
+
+    m_table.resize(m_seatClasses.size() * m_bandCount * HOURS);
+
+    for (int seatClass = 0; seatClass < m_seatClasses.size(); ++seatClass) {
+        for (int band = 0; band < m_bandCount; ++band) {
+            const int occupancy = bandStarts[band];
+            for (int hour = 0; hour < HOURS; ++hour) {
+                // Keep full precision while stacking rules, round once
+                double price = m_seatClasses[seatClass].basePrice;
+                for (const Rule& rule : rules) {
+                    if ((rule.seatClass < 0 || rule.seatClass == seatClass)
+                        && occupancy >= rule.minOccupancy
+                        && hour >= rule.fromHour && hour < rule.toHour) {
+                        price *= (100 + rule.adjustPercent) / 100.0;
+                    }
+                }
+                m_table[tableIndex(seatClass, occupancy, hour)] = qRound(price);
+            }
+        }
+    }
+}
+
+PricingEngine PricingEngine::defaultPricing()
+{
+    return PricingEngine(
+        {
+            {"Standard", 0, 1200},
+            {"Premium", 70, 1800}   // Seats 15-20 of a 20-seat hall
+        },
+        {
+            {-1, 0, 18, 24, 15},    // Evening showings
+            {-1, 50, 0, 24, 10},    // Half full
+            {-1, 80, 0, 24, 15}     // Nearly sold out (stacks with the above)
+        });
+}
+
+QVector<int> PricingEngine::priceAll(int capacity, int occupancyPercent, int hour) const
+{
+    QVector<int> prices;
+    prices.reserve(capacity);
+
+    // Walk the classes alongside the seats instead of looking each one up
+    int seatClass = 0;
+    for (int seatIndex = 0; seatIndex < capacity; ++seatIndex) {
+        while (seatClass + 1 < m_seatClasses.size()
+               && startsClass(seatIndex, capacity, m_seatClasses[seatClass + 1])) {
+            ++seatClass;
+        }
+        prices.append(m_table[tableIndex(seatClass, occupancyPercent, hour)]);
+    }
+
+    return prices;
+}
+
+int PricingEngine::seatClassOf(int seatIndex, int capacity) const
+{
+    int seatClass = 0;
+    while (seatClass + 1 < m_seatClasses.size()
+           && startsClass(seatIndex, capacity, m_seatClasses[seatClass + 1])) {
+        ++seatClass;
+    }
+    return seatClass;
+}
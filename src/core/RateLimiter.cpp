@@ -0,0 +1,206 @@
+#include "core/RateLimiter.h"
+#include <QMutexLocker>
+#include <cmath>
+
+namespace {
+
+/**
+ * @brief Fills in a default burst of one second's worth of requests
+ */
+int effectiveBurst(double rate, int burst)
+{
+    if (rate <= 0) {
+        return 0;
+    }
+    return burst > 0 ? burst : qMax(1, int(std::ceil(rate)));
+}
+
+} // namespace
+
+RateLimiter::RateLimiter(int capacity)
+    : m_shardCapacity(qMax(1, capacity / SHARD_COUNT))
+    , m_enabled(0)
+{
+    for (Shard& shard : m_shards) {
+        shard.sweepAt = m_shardCapacity;
+    }
+    m_clock.start();
+}
+
+void RateLimiter::setLimits(const Limits& limits)
+{
+    Limits normalized = limits;
+    normalized.customerRate = qMax(0.0, limits.customerRate);
+    normalized.showingRate = qMax(0.0, limits.showingRate);
+    normalized.customerBurst = effectiveBurst(normalized.customerRate, limits.customerBurst);
+    normalized.showingBurst = effectiveBurst(normalized.showingRate, limits.showingBurst);
+    normalized.maxSeatsPerCustomer = qMax(0, limits.maxSeatsPerCustomer);
+
+    for (Shard& shard : m_shards) {
+        QMutexLocker locker(&shard.mutex);
+        shard.limits = normalized;
+        if (normalized.customerRate <= 0) {
+            shard.customers.clear();
+        }
+        if (normalized.showingRate <= 0) {
+            shard.showings.clear();
+        }
+        if (normalized.maxSeatsPerCustomer <= 0) {
+            shard.seats.clear();
+            ++shard.quotaEpoch;
+        }
+    }
+
+    const bool enabled = normalized.customerRate > 0 || normalized.showingRate > 0
+                         || normalized.maxSeatsPerCustomer > 0;
+    m_enabled.storeRelease(enabled ? 1 : 0);
+}
+
+RateLimiter::Limits RateLimiter::limits() const
+{
+    QMutexLocker locker(&m_shards[0].mutex);
+    return m_shards[0].limits;
+}
+
+RateLimiter::Decision RateLimiter::admit(const QString& customer, int theaterId, int movieId,
+                                         int seatCount)
+{
+    Decision decision;
+    if (!m_enabled.loadAcquire()) {
+        return decision;
+    }
+
+    const qint64 nowNs = m_clock.nsecsElapsed();
+    Shard& shard = m_shards[shardOf(customer)];
+
+    // One shard lock at a time: customer bucket, showing bucket, then quota
+    {
+        QMutexLocker locker(&shard.mutex);
+        if (shard.limits.customerRate > 0
+            && !takeToken(shard, shard.customers, customer, shard.limits.customerRate,
+                          shard.limits.customerBurst, nowNs, decision.retryAfterMs)) {
+            decision.status = Status::CustomerRateLimited;
+            return decision;
+        }
+    }
+
+    {
+        Shard& showingShard = m_shards[shardOf(theaterId, movieId)];
+        QMutexLocker locker(&showingShard.mutex);
+        if (showingShard.limits.showingRate > 0
+            && !takeToken(showingShard, showingShard.showings, qMakePair(theaterId, movieId),
+                          showingShard.limits.showingRate, showingShard.limits.showingBurst,
+                          nowNs, decision.retryAfterMs)) {
+            decision.status = Status::ShowingRateLimited;
+            return decision;
+        }
+    }
+
+    QMutexLocker locker(&shard.mutex);
+    const int maxSeats = shard.limits.maxSeatsPerCustomer;
+    if (maxSeats <= 0) {
+        return decision;
+    }
+
+    const QuotaKey key{customer, theaterId, movieId};
+    const int held = shard.seats.value(key);
+    if (held + seatCount > maxSeats) {
+        decision.status = Status::QuotaExceeded;
+        decision.seatsLeft = qMax(0, maxSeats - held);
+        return decision;
+    }
+    shard.seats.insert(key, held + seatCount);
+    decision.hold = {seatCount, shard.quotaEpoch};
+    return decision;
+}
+
+void RateLimiter::release(const QString& customer, int theaterId, int movieId,
+                          const QuotaHold& hold)
+{
+    if (hold.seats <= 0 || !m_enabled.loadAcquire()) {
+        return;
+    }
+
+    Shard& shard = m_shards[shardOf(customer)];
+    QMutexLocker locker(&shard.mutex);
+
+    // Counted before the quota was last turned off: already dropped
+    if (hold.epoch != shard.quotaEpoch) {
+        return;
+    }
+
+    auto it = shard.seats.find(QuotaKey{customer, theaterId, movieId});
+    if (it == shard.seats.end()) {
+        return;
+    }
+    *it -= hold.seats;
+    if (*it <= 0) {
+        shard.seats.erase(it);
+    }
+}
+
+int RateLimiter::seatsHeld(const QString& customer, int theaterId, int movieId) const
+{
+    const Shard& shard = m_shards[shardOf(customer)];
+    QMutexLocker locker(&shard.mutex);
+    return shard.seats.value(QuotaKey{customer, theaterId, movieId});
+}
+
+template<typename Key>
+bool RateLimiter::takeToken(Shard& shard, QHash<Key, Bucket>& buckets, const Key& key,
+                            double rate, int burst, qint64 nowNs, qint64& retryAfterMs)
+{
+    auto it = buckets.find(key);
+    if (it == buckets.end()) {
+        if (shard.customers.size() + shard.showings.size() >= shard.sweepAt) {
+            sweep(shard, nowNs);
+        }
+        it = buckets.insert(key, Bucket{double(burst), nowNs});
+    } else {
+        const double refill = double(nowNs - it->updatedNs) * rate / 1e9;
+        it->tokens = qMin(double(burst), it->tokens + refill);
+        it->updatedNs = nowNs;
+    }
+
+    if (it->tokens < 1.0) {
+        retryAfterMs = qint64(std::ceil((1.0 - it->tokens) * 1000.0 / rate));
+        return false;
+    }
+    it->tokens -= 1.0;
+    return true;
+}
+
+void RateLimiter::sweep(Shard& shard, qint64 nowNs)
+{
+    auto full = [nowNs](const Bucket& bucket, double rate, int burst) {
+        return bucket.tokens + double(nowNs - bucket.updatedNs) * rate / 1e9 >= burst;
+    };
+
+    for (auto it = shard.customers.begin(); it != shard.customers.end();) {
+        if (full(*it, shard.limits.customerRate, shard.limits.customerBurst)) {
+            it = shard.customers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = shard.showings.begin(); it != shard.showings.end();) {
+        if (full(*it, shard.limits.showingRate, shard.limits.showingBurst)) {
+            it = shard.showings.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // Every bucket still busy: let the shard grow rather than sweep per insert
+    shard.sweepAt = qMax(m_shardCapacity, 2 * int(shard.customers.size() + shard.showings.size()));
+}
+
+int RateLimiter::shardOf(const QString& customer)
+{
+    return int(qHash(customer) % SHARD_COUNT);
+}
+
+int RateLimiter::shardOf(int theaterId, int movieId)
+{
+    return int(qHash(qMakePair(theaterId, movieId)) % SHARD_COUNT);
+}
@@ -0,0 +1,565 @@
+#include "core/ReplicationStream.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QIODevice>
+#include <QMutexLocker>
+#include <QThread>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+namespace {
+
+enum FrameType : quint8 {
+    RecordFrame = 1,        ///< Payload: ReplicationRecord::encode()
+    HeartbeatFrame = 2      ///< Payload: quint64 log head
+};
+
+/// Frames larger than this are treated as a corrupt stream
+constexpr quint32 MAX_FRAME_SIZE = 1 << 20;
+
+/// How often blocked socket calls wake up to check for shutdown
+constexpr int POLL_INTERVAL_MS = 100;
+
+/// Frames a sender takes per hold of the publisher mutex
+constexpr int SEND_BATCH_FRAMES = 256;
+
+/**
+ * @brief Builds a frame: big-endian length, type byte, payload
+ */
+QByteArray makeFrame(FrameType type, const QByteArray& payload)
+{
+    QByteArray frame;
+    QDataStream out(&frame, QIODevice::WriteOnly);
+    out << quint32(payload.size() + 1) << quint8(type);
+    frame.append(payload);
+    return frame;
+}
+
+QByteArray encodeSequence(quint64 sequence)
+{
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    out << sequence;
+    return bytes;
+}
+
+quint64 decodeSequence(const QByteArray& bytes)
+{
+    QDataStream in(bytes);
+    quint64 sequence = 0;
+    in >> sequence;
+    return sequence;
+}
+
+#ifdef Q_OS_UNIX
+
+/**
+ * @brief Fills a sockaddr_un, failing if the path does not fit
+ */
+bool makeAddress(const QString& socketPath, sockaddr_un& address, QString* error)
+{
+    const QByteArray path = socketPath.toUtf8();
+    if (path.isEmpty() || path.size() >= qsizetype(sizeof(address.sun_path))) {
+        if (error) {
+            *error = QString("Invalid socket path: %1").arg(socketPath);
+        }
+        return false;
+    }
+
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.constData(), path.size());
+    return true;
+}
+
+/**
+ * @brief Waits until a socket is ready, giving up when stop is set
+ */
+bool waitReady(int fd, short events, const QAtomicInt& stop)
+{
+    pollfd entry{fd, events, 0};
+    while (stop.loadAcquire() == 0) {
+        const int result = poll(&entry, 1, POLL_INTERVAL_MS);
+        if (result > 0) {
+            return true;
+        }
+        if (result < 0 && errno != EINTR) {
+            return false;
+        }
+    }
+    return false;
+}
+
+bool writeFully(int fd, const QByteArray& data, const QAtomicInt& stop)
+{
+    qsizetype written = 0;
+    while (written < data.size()) {
+        if (!waitReady(fd, POLLOUT, stop)) {
+            return false;
+        }
+        const ssize_t n = send(fd, data.constData() + written, data.size() - written, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        written += n;
+    }
+    return true;
+}
+
+bool readFully(int fd, char* data, qsizetype size, const QAtomicInt& stop)
+{
+    qsizetype received = 0;
+    while (received < size) {
+        if (!waitReady(fd, POLLIN, stop)) {
+            return false;
+        }
+        const ssize_t n = recv(fd, data + received, size - received, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;   // EOF: the peer went away
+        }
+        received += n;
+    }
+    return true;
+}
+
+#endif // Q_OS_UNIX
+
+} // namespace
+
+QByteArray ReplicationRecord::encode() const
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << sequence << committedAtMs << qint32(bookingId) << qint32(theaterId) << qint32(movieId)
+        << customerId << seatIds << seatPrices << bookedAtMs << quint8(kind);
+    return payload;
+}
+
+bool ReplicationRecord::decode(const QByteArray& payload, ReplicationRecord& record)
+{
+    QDataStream in(payload);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    qint32 bookingId = 0;
+    qint32 theaterId = 0;
+    qint32 movieId = 0;
+    quint8 kind = 0;
+    in >> record.sequence >> record.committedAtMs >> bookingId >> theaterId >> movieId
+       >> record.customerId >> record.seatIds >> record.seatPrices >> record.bookedAtMs >> kind;
+
+    record.bookingId = bookingId;
+    record.theaterId = theaterId;
+    record.movieId = movieId;
+    record.kind = static_cast<ReplicationRecord::Kind>(kind);
+    return in.status() == QDataStream::Ok && kind <= quint8(ReplicationRecord::Kind::Cancellation)
+           && (record.kind == ReplicationRecord::Kind::Cancellation
+               || record.seatPrices.size() == record.seatIds.size());
+}
+
+ReplicationPublisher::ReplicationPublisher(int retainedFrames)
+    : m_retainedFrames(qMax(1, retainedFrames))
+{
+}
+
+ReplicationPublisher::~ReplicationPublisher()
+{
+    close();
+}
+
+quint64 ReplicationPublisher::publish(ReplicationRecord record)
+{
+    QMutexLocker locker(&m_mutex);
+
+    record.sequence = m_firstSequence + m_frames.size();
+    record.committedAtMs = QDateTime::currentMSecsSinceEpoch();
+    m_frames.append(makeFrame(RecordFrame, record.encode()));
+
+    // Dropping from the front of a QList only moves its begin
+    if (m_frames.size() > m_retainedFrames) {
+        m_frames.removeFirst();
+        ++m_firstSequence;
+    }
+
+    m_logGrown.wakeAll();
+    return record.sequence;
+}
+
+bool ReplicationPublisher::skipTo(quint64 sequence)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_frames.isEmpty() || sequence + 1 < m_firstSequence) {
+        return false;
+    }
+    m_firstSequence = sequence + 1;
+    return true;
+}
+
+quint64 ReplicationPublisher::headSequence() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_firstSequence + m_frames.size() - 1;
+}
+
+quint64 ReplicationPublisher::oldestSequence() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_firstSequence;
+}
+
+int ReplicationPublisher::replicaCount() const
+{
+    return m_replicaCount.loadAcquire();
+}
+
+int ReplicationPublisher::senderCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_senders.size();
+}
+
+void ReplicationPublisher::reapSenders()
+{
+    QVector<QThread*> finished;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (qsizetype i = m_senders.size() - 1; i >= 0; --i) {
+            if (m_senders[i]->isFinished()) {
+                finished.append(m_senders.takeAt(i));
+            }
+        }
+    }
+    for (QThread* sender : finished) {
+        sender->wait();
+        delete sender;
+    }
+}
+
+#ifdef Q_OS_UNIX
+
+bool ReplicationPublisher::listen(const QString& socketPath, QString* error)
+{
+    if (m_listenFd >= 0) {
+        if (error) {
+            *error = "Already listening";
+        }
+        return false;
+    }
+
+    sockaddr_un address;
+    if (!makeAddress(socketPath, address, error)) {
+        return false;
+    }
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        if (error) {
+            *error = QString("socket failed: %1").arg(strerror(errno));
+        }
+        return false;
+    }
+
+    // A leftover socket file from a crashed primary would make bind() fail
+    ::unlink(address.sun_path);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || ::listen(fd, 16) != 0) {
+        const int savedErrno = errno;
+        ::close(fd);
+        if (error) {
+            *error = QString("Cannot listen on %1: %2").arg(socketPath, strerror(savedErrno));
+        }
+        return false;
+    }
+
+    m_listenFd = fd;
+    m_socketPath = socketPath;
+    m_closing.storeRelease(0);
+    m_acceptThread = QThread::create([this] { acceptLoop(); });
+    m_acceptThread->start();
+    return true;
+}
+
+void ReplicationPublisher::close()
+{
+    if (!m_acceptThread) {
+        return;
+    }
+
+    m_closing.storeRelease(1);
+    {
+        QMutexLocker locker(&m_mutex);
+        m_logGrown.wakeAll();
+    }
+
+    // No sender is started once the accept thread is gone
+    m_acceptThread->wait();
+    delete m_acceptThread;
+    m_acceptThread = nullptr;
+
+    QVector<QThread*> senders;
+    {
+        QMutexLocker locker(&m_mutex);
+        senders.swap(m_senders);
+    }
+    for (QThread* sender : senders) {
+        sender->wait();
+        delete sender;
+    }
+
+    ::close(m_listenFd);
+    ::unlink(m_socketPath.toUtf8().constData());
+    m_listenFd = -1;
+}
+
+void ReplicationPublisher::acceptLoop()
+{
+    pollfd entry{m_listenFd, POLLIN, 0};
+    while (m_closing.loadAcquire() == 0) {
+        // Wakes up every poll interval, so senders of replicas that
+        // disconnected are joined shortly after they finish
+        reapSenders();
+
+        const int result = poll(&entry, 1, POLL_INTERVAL_MS);
+        if (result < 0 && errno != EINTR) {
+            break;
+        }
+        if (result <= 0) {
+            continue;
+        }
+
+        const int fd = accept(m_listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+
+        QThread* sender = QThread::create([this, fd] { serveReplica(fd); });
+        {
+            QMutexLocker locker(&m_mutex);
+            m_senders.append(sender);
+        }
+        sender->start();
+    }
+}
+
+void ReplicationPublisher::serveReplica(int socketFd)
+{
+    m_replicaCount.fetchAndAddOrdered(1);
+
+    // Handshake: the replica names the first sequence it still needs
+    QByteArray handshake(8, '\0');
+    if (readFully(socketFd, handshake.data(), handshake.size(), m_closing)) {
+        quint64 next = qMax<quint64>(1, decodeSequence(handshake));
+
+        QVector<QByteArray> frames;
+        frames.reserve(SEND_BATCH_FRAMES);
+        for (;;) {
+            quint64 head = 0;
+            frames.clear();
+            {
+                // publish() waits on this lock under the booking lock, so a
+                // replica catching up takes a bounded batch of shared frames
+                // per hold and never copies frame bytes here
+                QMutexLocker locker(&m_mutex);
+                if (m_firstSequence + m_frames.size() <= next && m_closing.loadAcquire() == 0) {
+                    m_logGrown.wait(&m_mutex, HEARTBEAT_INTERVAL_MS);
+                }
+                if (m_closing.loadAcquire() != 0) {
+                    break;
+                }
+                if (next < m_firstSequence) {
+                    // The frames the replica needs were dropped; it must resync
+                    break;
+                }
+                head = m_firstSequence + m_frames.size() - 1;
+                const quint64 last = qMin(head, next + SEND_BATCH_FRAMES - 1);
+                for (quint64 sequence = next; sequence <= last; ++sequence) {
+                    frames.append(m_frames[sequence - m_firstSequence]);
+                }
+            }
+
+            // Build and send outside the lock so a slow replica never blocks publish()
+            QByteArray batch;
+            if (frames.isEmpty()) {
+                batch = makeFrame(HeartbeatFrame, encodeSequence(head));
+            } else {
+                for (const QByteArray& frame : std::as_const(frames)) {
+                    batch.append(frame);
+                }
+                next += frames.size();
+            }
+            if (!writeFully(socketFd, batch, m_closing)) {
+                break;
+            }
+        }
+    }
+
+    ::close(socketFd);
+    m_replicaCount.fetchAndSubOrdered(1);
+}
+
+ReplicationSubscriber::~ReplicationSubscriber()
+{
+    disconnect();
+}
+
+bool ReplicationSubscriber::connectTo(const QString& socketPath, quint64 fromSequence,
+                                      RecordHandler handler, QString* error)
+{
+    if (m_thread) {
+        if (error) {
+            *error = "Already connected";
+        }
+        return false;
+    }
+
+    sockaddr_un address;
+    if (!makeAddress(socketPath, address, error)) {
+        return false;
+    }
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        const int savedErrno = errno;
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        if (error) {
+            *error = QString("Cannot connect to %1: %2").arg(socketPath, strerror(savedErrno));
+        }
+        return false;
+    }
+
+    m_stopping.storeRelease(0);
+    if (!writeFully(fd, encodeSequence(fromSequence), m_stopping)) {
+        ::close(fd);
+        if (error) {
+            *error = "Primary closed the connection";
+        }
+        return false;
+    }
+
+    m_socketFd = fd;
+    m_handler = std::move(handler);
+    m_nextSequence = qMax<quint64>(1, fromSequence);
+    m_primarySequence.storeRelease(fromSequence > 0 ? fromSequence - 1 : 0);
+    m_connected.storeRelease(1);
+    m_thread = QThread::create([this] { receiveLoop(); });
+    m_thread->start();
+    return true;
+}
+
+void ReplicationSubscriber::disconnect()
+{
+    if (!m_thread) {
+        return;
+    }
+
+    m_stopping.storeRelease(1);
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+
+    ::close(m_socketFd);
+    m_socketFd = -1;
+    m_connected.storeRelease(0);
+}
+
+void ReplicationSubscriber::receiveLoop()
+{
+    for (;;) {
+        QByteArray header(4, '\0');
+        if (!readFully(m_socketFd, header.data(), header.size(), m_stopping)) {
+            break;
+        }
+
+        QDataStream lengthStream(header);
+        quint32 length = 0;
+        lengthStream >> length;
+        if (length == 0 || length > MAX_FRAME_SIZE) {
+            break;
+        }
+
+        QByteArray frame(length, '\0');
+        if (!readFully(m_socketFd, frame.data(), frame.size(), m_stopping)) {
+            break;
+        }
+
+        const quint8 type = quint8(frame[0]);
+        const QByteArray payload = frame.mid(1);
+
+        if (type == HeartbeatFrame) {
+            m_primarySequence.storeRelease(decodeSequence(payload));
+            continue;
+        }
+
+        ReplicationRecord record;
+        if (type != RecordFrame || !ReplicationRecord::decode(payload, record)) {
+            break;
+        }
+        if (record.sequence != m_nextSequence) {
+            // Applying past a gap would silently diverge from the primary
+            qWarning() << "Replication stream expected sequence" << m_nextSequence
+                       << "but got" << record.sequence << "- disconnecting";
+            break;
+        }
+        ++m_nextSequence;
+        if (record.sequence > m_primarySequence.loadAcquire()) {
+            m_primarySequence.storeRelease(record.sequence);
+        }
+        if (!m_handler(record)) {
+            // Later records would land at the wrong positions, like after a gap
+            qWarning() << "Replication record" << record.sequence
+                       << "could not be applied - disconnecting";
+            break;
+        }
+    }
+
+    m_connected.storeRelease(0);
+}
+
+#else // !Q_OS_UNIX
+
+bool ReplicationPublisher::listen(const QString&, QString* error)
+{
+    if (error) {
+        *error = "Replication requires Unix domain sockets";
+    }
+    return false;
+}
+
+void ReplicationPublisher::close() {}
+void ReplicationPublisher::acceptLoop() {}
+void ReplicationPublisher::serveReplica(int) {}
+
+ReplicationSubscriber::~ReplicationSubscriber() = default;
+
+bool ReplicationSubscriber::connectTo(const QString&, quint64, RecordHandler, QString* error)
+{
+    if (error) {
+        *error = "Replication requires Unix domain sockets";
+    }
+    return false;
+}
+
+void ReplicationSubscriber::disconnect() {}
+void ReplicationSubscriber::receiveLoop() {}
+
+#endif // Q_OS_UNIX
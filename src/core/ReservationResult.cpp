@@ -0,0 +1,99 @@
+#include "core/ReservationResult.h"
+
+namespace {
+
+/**
+ * @brief Names the stored offending seats, e.g. "A4, A5"
+ */
+QString seatList(const ReservationResult& result, const QStringList& requestedSeatIds)
+{
+    QStringList names;
+    const int stored = qMin(result.seatCount, int(ReservationResult::MAX_SEATS));
+    for (int i = 0; i < stored; ++i) {
+        const int seat = result.seats[i];
+        if (result.code == ReservationResult::Code::SeatNotFound) {
+            names.append(seat < requestedSeatIds.size() ? requestedSeatIds[seat]
+                                                        : QString("#%1").arg(seat + 1));
+        } else {
+            // Seats are named "A1" to "A<capacity>" in index order
+            names.append(QString("A%1").arg(seat + 1));
+        }
+    }
+    if (result.seatCount > stored) {
+        names.append(QString("%1 more").arg(result.seatCount - stored));
+    }
+    return names.join(", ");
+}
+
+} // namespace
+
+QString ReservationResult::describe(const QStringList& requestedSeatIds) const
+{
+    const bool several = seatCount > 1;
+
+    switch (code) {
+    case Code::Ok:
+        return QString("Booking %1 confirmed").arg(bookingId);
+    case Code::TheaterNotFound:
+        return QString("Theater %1 not found").arg(theaterId);
+    case Code::ShowingNotFound:
+        return QString("Movie %1 not showing in theater %2").arg(movieId).arg(theaterId);
+    case Code::NoSeatsRequested:
+        return "No seats requested";
+    case Code::SeatNotFound:
+        return QString(several ? "Seats %1 not found" : "Seat %1 not found")
+            .arg(seatList(*this, requestedSeatIds));
+    case Code::SeatTaken:
+        return QString(several ? "Seats %1 are not available" : "Seat %1 is not available")
+            .arg(seatList(*this, requestedSeatIds));
+    case Code::DuplicateSeat:
+        return QString(several ? "Seats %1 requested more than once"
+                               : "Seat %1 requested more than once")
+            .arg(seatList(*this, requestedSeatIds));
+    case Code::NotEnoughSeats:
+        return QString("Only %1 seats left").arg(freeCount);
+    case Code::SoldOut:
+        return "Showing is sold out";
+    case Code::QueueFull:
+        return QString("Waiting room is full (%1 ahead, about %2 ms wait)")
+            .arg(queueAhead).arg(estimatedWaitMs);
+    case Code::SharedInventoryUnavailable:
+        return "Shared inventory is unavailable";
+    case Code::ReadOnlyReplica:
+        return "Replica is read-only";
+    case Code::IdempotencyMismatch:
+        return "Idempotency key was already used for a different request";
+    case Code::RateLimited:
+        return QString("Too many requests, retry in %1 ms").arg(estimatedWaitMs);
+    case Code::QuotaExceeded:
+        return QString("Seat limit per customer reached (%1 more allowed)").arg(quotaLeft);
+    case Code::BookingCancelled:
+        return QString("Booking %1 made with this idempotency key was cancelled").arg(bookingId);
+    }
+
+    return "Reservation failed";
+}
+
+const char* ReservationResult::codeName(Code code)
+{
+    switch (code) {
+    case Code::Ok: return "Ok";
+    case Code::TheaterNotFound: return "TheaterNotFound";
+    case Code::ShowingNotFound: return "ShowingNotFound";
+    case Code::NoSeatsRequested: return "NoSeatsRequested";
+    case Code::SeatNotFound: return "SeatNotFound";
+    case Code::SeatTaken: return "SeatTaken";
+    case Code::DuplicateSeat: return "DuplicateSeat";
+    case Code::NotEnoughSeats: return "NotEnoughSeats";
+    case Code::SoldOut: return "SoldOut";
+    case Code::QueueFull: return "QueueFull";
+    case Code::SharedInventoryUnavailable: return "SharedInventoryUnavailable";
+    case Code::ReadOnlyReplica: return "ReadOnlyReplica";
+    case Code::IdempotencyMismatch: return "IdempotencyMismatch";
+    case Code::RateLimited: return "RateLimited";
+    case Code::QuotaExceeded: return "QuotaExceeded";
+    case Code::BookingCancelled: return "BookingCancelled";
+    }
+
+    return "Unknown";
+}
@@ -0,0 +1,53 @@
+#include "core/SeatChangeLog.h"
+#include <algorithm>
+
+SeatChangeLog::SeatChangeLog(int capacity)
+    : m_entries(qMax(1, capacity))
+    , m_next(0)
+    , m_count(0)
+    , m_evictedVersion(0)
+{
+}
+
+void SeatChangeLog::record(quint64 version, int seatIndex)
+{
+    if (m_count == m_entries.size()) {
+        // Overwriting the oldest entry; remember how far back we still reach
+        m_evictedVersion = qMax(m_evictedVersion, m_entries[m_next].version);
+    } else {
+        ++m_count;
+    }
+
+    m_entries[m_next] = {version, seatIndex};
+    m_next = (m_next + 1) % m_entries.size();
+}
+
+bool SeatChangeLog::changesSince(quint64 version, QVector<int>& seatIndices) const
+{
+    seatIndices.clear();
+
+    // Changes newer than the caller's version may already have been evicted
+    if (version < m_evictedVersion) {
+        return false;
+    }
+
+    const int capacity = m_entries.size();
+    const int oldest = (m_next - m_count + capacity) % capacity;
+    for (int i = 0; i < m_count; ++i) {
+        const Entry& entry = m_entries[(oldest + i) % capacity];
+        if (entry.version > version) {
+            seatIndices.append(entry.seatIndex);
+        }
+    }
+
+    std::sort(seatIndices.begin(), seatIndices.end());
+    seatIndices.erase(std::unique(seatIndices.begin(), seatIndices.end()), seatIndices.end());
+    return true;
+}
+
+void SeatChangeLog::reset(quint64 version)
+{
+    m_next = 0;
+    m_count = 0;
+    m_evictedVersion = version;
+}
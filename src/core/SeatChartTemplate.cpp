@@ -0,0 +1,60 @@
+#include "core/SeatChartTemplate.h"
+#include <cstring>
+
+SeatChartTemplate::SeatChartTemplate(const SeatMap& layout)
+{
+    const int capacity = layout.capacity();
+    const int width = layout.seatId(capacity - 1).size();    // IDs grow with the index
+
+    m_textOffsets.reserve(capacity);
+    m_jsonOffsets.reserve(capacity);
+    m_text.reserve(capacity * (width + 1));
+    m_json.reserve(capacity * (width + 8) + 32);
+
+    m_json += "{\"capacity\":";
+    m_json += QByteArray::number(capacity);
+    m_json += ",\"seats\":[";
+
+    for (int i = 0; i < capacity; ++i) {
+        const QByteArray id = layout.seatId(i).toLatin1();
+
+        m_textOffsets.append(m_text.size());
+        m_text += id;
+        if ((i + 1) % SEATS_PER_ROW == 0 || i + 1 == capacity) {
+            m_text += '\n';
+        } else {
+            m_text += QByteArray(width - id.size() + 1, ' ');
+        }
+
+        if (i > 0) {
+            m_json += ',';
+        }
+        m_json += "[\"";
+        m_json += id;
+        m_json += "\",";
+        m_jsonOffsets.append(m_json.size());
+        m_json += "1]";
+    }
+
+    m_json += "]}";
+}
+
+void SeatChartTemplate::setTaken(QByteArray& chart, Format format, int seatIndex, bool taken) const
+{
+    char* data = chart.data();
+
+    if (format == Format::Json) {
+        data[m_jsonOffsets[seatIndex]] = taken ? '0' : '1';
+        return;
+    }
+
+    // IDs are "A" plus digits, so the ID ends at the next space or newline
+    const int offset = m_textOffsets[seatIndex];
+    const char* blankId = m_text.constData() + offset;
+    const int length = int(std::strcspn(blankId, " \n"));
+    if (taken) {
+        std::memset(data + offset, '-', length);
+    } else {
+        std::memcpy(data + offset, blankId, length);
+    }
+}
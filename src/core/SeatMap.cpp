@@ -0,0 +1,122 @@
+#include "core/SeatMap.h"
+#include "core/NumaMemory.h"
+#include <algorithm>
+#include <new>
+
+DynamicSeatMap::DynamicSeatMap(int capacity)
+    : m_capacity(qMax(0, capacity))
+    , m_takenCount(0)
+{
+    std::fill_n(taken(), m_capacity, false);
+}
+
+int DynamicSeatMap::indexOf(QStringView seatId) const
+{
+    return parseSeatId(seatId, m_capacity);
+}
+
+QString DynamicSeatMap::seatId(int index) const
+{
+    return QString("A%1").arg(index + 1);
+}
+
+bool DynamicSeatMap::anyTaken(const QVector<int>& indices) const
+{
+    for (int index : indices) {
+        if (taken()[index]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void DynamicSeatMap::take(const QVector<int>& indices)
+{
+    for (int index : indices) {
+        if (!taken()[index]) {
+            taken()[index] = true;
+            ++m_takenCount;
+        }
+    }
+}
+
+void DynamicSeatMap::release(const QVector<int>& indices)
+{
+    for (int index : indices) {
+        if (taken()[index]) {
+            taken()[index] = false;
+            --m_takenCount;
+        }
+    }
+}
+
+QVector<int> DynamicSeatMap::freeSeats() const
+{
+    QVector<int> free;
+    free.reserve(freeCount());
+    for (int i = 0; i < m_capacity; ++i) {
+        if (!taken()[i]) {
+            free.append(i);
+        }
+    }
+    return free;
+}
+
+int DynamicSeatMap::freeSeatsFrom(int from, int* indices, int maxCount) const
+{
+    int count = 0;
+    for (int i = qMax(from, 0); i < m_capacity && count < maxCount; ++i) {
+        if (!taken()[i]) {
+            indices[count++] = i;
+        }
+    }
+    return count;
+}
+
+void SeatMapDeleter::operator()(SeatMap* seatMap) const
+{
+    seatMap->~SeatMap();
+    if (ownsBlock) {
+        NumaMemory::release(seatMap, NumaMemory::CACHE_LINE_SIZE, numaNode);
+    }
+}
+
+std::size_t seatMapSize(int capacity)
+{
+    switch (capacity) {
+    case 20:
+        return sizeof(FixedSeatMap<20>);
+    case 120:
+        return sizeof(FixedSeatMap<120>);
+    case 250:
+        return sizeof(FixedSeatMap<250>);
+    case 400:
+        return sizeof(FixedSeatMap<400>);
+    default:
+        return sizeof(DynamicSeatMap) + std::size_t(qMax(0, capacity)) * sizeof(bool);
+    }
+}
+
+SeatMap* placeSeatMap(void* memory, int capacity)
+{
+    switch (capacity) {
+    case 20:
+        return new (memory) FixedSeatMap<20>();
+    case 120:
+        return new (memory) FixedSeatMap<120>();
+    case 250:
+        return new (memory) FixedSeatMap<250>();
+    case 400:
+        return new (memory) FixedSeatMap<400>();
+    default:
+        return new (memory) DynamicSeatMap(capacity);
+    }
+}
+
+SeatMapPtr createSeatMap(int capacity, int numaNode)
+{
+    // Construction cannot throw once the block is there
+    void* memory = NumaMemory::allocate(seatMapSize(capacity), NumaMemory::CACHE_LINE_SIZE,
+                                        numaNode);
+    return SeatMapPtr(placeSeatMap(memory, capacity), SeatMapDeleter{numaNode});
+}
@@ -0,0 +1,387 @@
+#include "core/SharedInventory.h"
+
+#ifdef Q_OS_LINUX
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr quint32 SEGMENT_MAGIC = 0x54424b31;      // "TBK1"
+constexpr quint32 LAYOUT_VERSION = 2;
+
+enum InitState : quint32 {
+    Uninitialized = 0,
+    Initializing = 1,
+    Ready = 2
+};
+
+/// Segment names must start with a slash for shm_open()
+QByteArray segmentName(const QString& name)
+{
+    return (name.startsWith('/') ? name : "/" + name).toUtf8();
+}
+
+qint64 alignUp(qint64 value, qint64 alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+struct SharedInventory::Header {
+    std::atomic<quint32> initState;     ///< InitState, set to Ready last
+    quint32 magic;                      ///< SEGMENT_MAGIC
+    quint32 layoutVersion;              ///< LAYOUT_VERSION
+    qint32 showingCount;                ///< Showing slots in the segment
+    qint32 capacity;                    ///< Seats of the largest showing slot
+    qint32 words;                       ///< 64-bit words per seat bitmap, sized for the largest slot
+    std::atomic<qint32> nextBookingId;  ///< Next booking ID to hand out
+    std::atomic<qint32> recoveredClaims; ///< Intents rolled back after a crash
+};
+
+struct SharedInventory::ShowingBlock {
+    pthread_mutex_t mutex;              ///< Robust, process-shared
+    qint32 capacity;                    ///< Seats of this showing slot
+    std::atomic<qint32> freeCount;      ///< Free seats, readable without the mutex
+    qint32 intentPending;               ///< 1 while a claim is not yet committed
+    // Followed by: std::atomic<quint64> taken[words], quint64 intent[words]
+
+    std::atomic<quint64>* taken() { return reinterpret_cast<std::atomic<quint64>*>(this + 1); }
+    quint64* intent(int words) { return reinterpret_cast<quint64*>(taken() + words); }
+};
+
+static_assert(std::atomic<quint64>::is_always_lock_free, "shared seat bits need lock-free atomics");
+static_assert(std::atomic<qint32>::is_always_lock_free, "shared counters need lock-free atomics");
+
+SharedInventory::~SharedInventory()
+{
+    if (m_base) {
+        munmap(m_base, m_size);
+    }
+}
+
+bool SharedInventory::open(const QString& name, const QVector<int>& capacities, QString* error)
+{
+    auto fail = [error](const QString& reason) {
+        if (error) {
+            *error = reason;
+        }
+        return false;
+    };
+
+    if (m_base) {
+        return fail("Shared inventory is already open");
+    }
+    const int showingCount = capacities.size();
+    if (showingCount == 0 || *std::min_element(capacities.cbegin(), capacities.cend()) <= 0) {
+        return fail("Invalid shared inventory dimensions");
+    }
+    const int capacity = *std::max_element(capacities.cbegin(), capacities.cend());
+
+    const int words = (capacity + 63) / 64;
+    m_blockSize = alignUp(sizeof(ShowingBlock) + 2 * words * sizeof(quint64), 64);
+    m_size = alignUp(sizeof(Header), 64) + showingCount * m_blockSize;
+
+    const QByteArray shmName = segmentName(name);
+    bool created = true;
+    int fd = shm_open(shmName.constData(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0 && errno == EEXIST) {
+        created = false;
+        fd = shm_open(shmName.constData(), O_RDWR, 0600);
+    }
+    if (fd < 0) {
+        return fail(QString("shm_open failed: %1").arg(strerror(errno)));
+    }
+
+    if (created && ftruncate(fd, m_size) != 0) {
+        const int savedErrno = errno;
+        ::close(fd);
+        shm_unlink(shmName.constData());
+        return fail(QString("ftruncate failed: %1").arg(strerror(savedErrno)));
+    }
+
+    if (!created) {
+        // The creator may not have sized the segment yet
+        struct stat info;
+        for (int attempt = 0; fstat(fd, &info) == 0 && info.st_size < m_size; ++attempt) {
+            if (attempt == 1000) {
+                ::close(fd);
+                return fail("Shared inventory segment has an unexpected size");
+            }
+            QThread::msleep(1);
+        }
+    }
+
+    void* base = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED) {
+        return fail(QString("mmap failed: %1").arg(strerror(errno)));
+    }
+    m_base = base;
+
+    Header* header = static_cast<Header*>(m_base);
+
+    if (created) {
+        // A fresh segment is zero-filled; publish it only once fully set up
+        header->initState.store(Initializing);
+        header->magic = SEGMENT_MAGIC;
+        header->layoutVersion = LAYOUT_VERSION;
+        header->showingCount = showingCount;
+        header->capacity = capacity;
+        header->words = words;
+        header->nextBookingId.store(1);
+        header->recoveredClaims.store(0);
+
+        pthread_mutexattr_t attributes;
+        pthread_mutexattr_init(&attributes);
+        pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+        pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+        for (int showing = 0; showing < showingCount; ++showing) {
+            ShowingBlock* showingBlock = block(showing);
+            pthread_mutex_init(&showingBlock->mutex, &attributes);
+            showingBlock->capacity = capacities[showing];
+            showingBlock->freeCount.store(capacities[showing]);
+            showingBlock->intentPending = 0;
+        }
+        pthread_mutexattr_destroy(&attributes);
+
+        header->initState.store(Ready, std::memory_order_release);
+        return true;
+    }
+
+    for (int attempt = 0; header->initState.load(std::memory_order_acquire) != Ready; ++attempt) {
+        if (attempt == 1000) {
+            munmap(m_base, m_size);
+            m_base = nullptr;
+            return fail("Shared inventory segment was never initialized");
+        }
+        QThread::msleep(1);
+    }
+
+    if (header->magic != SEGMENT_MAGIC || header->layoutVersion != LAYOUT_VERSION
+        || header->showingCount != showingCount || header->capacity != capacity) {
+        munmap(m_base, m_size);
+        m_base = nullptr;
+        return fail("Shared inventory segment has a different layout");
+    }
+    for (int showing = 0; showing < showingCount; ++showing) {
+        if (block(showing)->capacity != capacities[showing]) {
+            munmap(m_base, m_size);
+            m_base = nullptr;
+            return fail(QString("Shared inventory slot %1 has a different capacity").arg(showing));
+        }
+    }
+
+    return true;
+}
+
+bool SharedInventory::remove(const QString& name)
+{
+    return shm_unlink(segmentName(name).constData()) == 0;
+}
+
+int SharedInventory::showingCount() const
+{
+    return m_base ? static_cast<const Header*>(m_base)->showingCount : 0;
+}
+
+int SharedInventory::capacity(int showing) const
+{
+    return m_base ? block(showing)->capacity : 0;
+}
+
+bool SharedInventory::isTaken(int showing, int seatIndex) const
+{
+    const quint64 word = block(showing)->taken()[seatIndex / 64].load(std::memory_order_acquire);
+    return word & (quint64(1) << (seatIndex % 64));
+}
+
+int SharedInventory::freeCount(int showing) const
+{
+    return block(showing)->freeCount.load(std::memory_order_acquire);
+}
+
+int SharedInventory::nextBookingId()
+{
+    return static_cast<Header*>(m_base)->nextBookingId.fetch_add(1);
+}
+
+bool SharedInventory::beginClaim(int showing, const QVector<int>& seatIndices, int* conflictingSeat)
+{
+    ShowingBlock* showingBlock = block(showing);
+    if (!lockShowing(showingBlock)) {
+        return false;
+    }
+
+    const int words = static_cast<const Header*>(m_base)->words;
+    std::atomic<quint64>* taken = showingBlock->taken();
+
+    for (int seatIndex : seatIndices) {
+        if (taken[seatIndex / 64].load(std::memory_order_relaxed) & (quint64(1) << (seatIndex % 64))) {
+            if (conflictingSeat) {
+                *conflictingSeat = seatIndex;
+            }
+            pthread_mutex_unlock(&showingBlock->mutex);
+            return false;
+        }
+    }
+
+    // Record the intent before touching any seat so a crash can be undone
+    quint64* intent = showingBlock->intent(words);
+    std::memset(intent, 0, words * sizeof(quint64));
+    for (int seatIndex : seatIndices) {
+        intent[seatIndex / 64] |= quint64(1) << (seatIndex % 64);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    showingBlock->intentPending = 1;
+
+    for (int word = 0; word < words; ++word) {
+        if (intent[word]) {
+            taken[word].fetch_or(intent[word], std::memory_order_release);
+        }
+    }
+    showingBlock->freeCount.fetch_sub(seatIndices.size(), std::memory_order_release);
+
+    return true;
+}
+
+void SharedInventory::commitClaim(int showing)
+{
+    ShowingBlock* showingBlock = block(showing);
+    showingBlock->intentPending = 0;
+    pthread_mutex_unlock(&showingBlock->mutex);
+}
+
+void SharedInventory::abortClaim(int showing)
+{
+    ShowingBlock* showingBlock = block(showing);
+    rollBackIntent(showingBlock);
+    pthread_mutex_unlock(&showingBlock->mutex);
+}
+
+bool SharedInventory::release(int showing, const QVector<int>& seatIndices)
+{
+    ShowingBlock* showingBlock = block(showing);
+    if (!lockShowing(showingBlock)) {
+        return false;
+    }
+
+    std::atomic<quint64>* taken = showingBlock->taken();
+    int released = 0;
+    for (int seatIndex : seatIndices) {
+        const quint64 bit = quint64(1) << (seatIndex % 64);
+        if (taken[seatIndex / 64].fetch_and(~bit, std::memory_order_release) & bit) {
+            ++released;
+        }
+    }
+    // A crash before this line is repaired by the next lockShowing()
+    showingBlock->freeCount.fetch_add(released, std::memory_order_release);
+
+    pthread_mutex_unlock(&showingBlock->mutex);
+    return true;
+}
+
+int SharedInventory::recoveredClaims() const
+{
+    return static_cast<const Header*>(m_base)->recoveredClaims.load();
+}
+
+SharedInventory::ShowingBlock* SharedInventory::block(int showing) const
+{
+    char* blocks = static_cast<char*>(m_base) + alignUp(sizeof(Header), 64);
+    return reinterpret_cast<ShowingBlock*>(blocks + showing * m_blockSize);
+}
+
+bool SharedInventory::lockShowing(ShowingBlock* showingBlock)
+{
+    const int result = pthread_mutex_lock(&showingBlock->mutex);
+    if (result == EOWNERDEAD) {
+        // Previous owner died holding the lock; undo its unfinished claim
+        if (showingBlock->intentPending) {
+            rollBackIntent(showingBlock);
+            static_cast<Header*>(m_base)->recoveredClaims.fetch_add(1);
+        } else {
+            // It may have died in release(), between the bits and the counter
+            recountFree(showingBlock);
+        }
+        pthread_mutex_consistent(&showingBlock->mutex);
+        return true;
+    }
+    return result == 0;
+}
+
+void SharedInventory::rollBackIntent(ShowingBlock* showingBlock)
+{
+    if (!showingBlock->intentPending) {
+        return;
+    }
+
+    const Header* header = static_cast<const Header*>(m_base);
+    const int words = header->words;
+    std::atomic<quint64>* taken = showingBlock->taken();
+    const quint64* intent = showingBlock->intent(words);
+
+    for (int word = 0; word < words; ++word) {
+        if (intent[word]) {
+            taken[word].fetch_and(~intent[word], std::memory_order_release);
+        }
+    }
+
+    // Recount instead of adjusting: the owner may have died between
+    // setting bits and updating the counter
+    recountFree(showingBlock);
+    showingBlock->intentPending = 0;
+}
+
+void SharedInventory::recountFree(ShowingBlock* showingBlock)
+{
+    const Header* header = static_cast<const Header*>(m_base);
+    const std::atomic<quint64>* taken = showingBlock->taken();
+
+    int takenCount = 0;
+    for (int word = 0; word < header->words; ++word) {
+        takenCount += __builtin_popcountll(taken[word].load(std::memory_order_relaxed));
+    }
+    showingBlock->freeCount.store(showingBlock->capacity - takenCount, std::memory_order_release);
+}
+
+#else // !Q_OS_LINUX
+
+struct SharedInventory::Header {};
+struct SharedInventory::ShowingBlock {};
+
+SharedInventory::~SharedInventory() = default;
+
+bool SharedInventory::open(const QString&, const QVector<int>&, QString* error)
+{
+    if (error) {
+        *error = "Shared inventory requires Linux";
+    }
+    return false;
+}
+
+bool SharedInventory::remove(const QString&) { return false; }
+int SharedInventory::showingCount() const { return 0; }
+int SharedInventory::capacity(int) const { return 0; }
+bool SharedInventory::isTaken(int, int) const { return false; }
+int SharedInventory::freeCount(int) const { return 0; }
+int SharedInventory::nextBookingId() { return -1; }
+bool SharedInventory::beginClaim(int, const QVector<int>&, int*) { return false; }
+void SharedInventory::commitClaim(int) {}
+void SharedInventory::abortClaim(int) {}
+bool SharedInventory::release(int, const QVector<int>&) { return false; }
+int SharedInventory::recoveredClaims() const { return 0; }
+SharedInventory::ShowingBlock* SharedInventory::block(int) const { return nullptr; }
+bool SharedInventory::lockShowing(ShowingBlock*) { return false; }
+void SharedInventory::rollBackIntent(ShowingBlock*) {}
+void SharedInventory::recountFree(ShowingBlock*) {}
+
+#endif // Q_OS_LINUX
@@ -0,0 +1,201 @@
+#include "core/Tracing.h"
+#include "core/JsonText.h"
+#include <QAtomicInteger>
+#include <QAtomicPointer>
+#include <QCoreApplication>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+#include <chrono>
+#include <limits>
+
+namespace {
+
+static_assert((TraceRecorder::EVENTS_PER_THREAD & (TraceRecorder::EVENTS_PER_THREAD - 1)) == 0,
+              "EVENTS_PER_THREAD must be a power of two");
+
+/**
+ * @brief One recorded span; fields are atomic so exports may read them
+ */
+struct TraceEvent {
+    QAtomicPointer<const char> name;
+    QAtomicInteger<qint64> startNs;
+    QAtomicInteger<qint64> durationNs;
+};
+
+/**
+ * @brief Ring buffer written only by its owning thread
+ */
+struct ThreadBuffer {
+    int tid = 0;                    ///< Trace thread ID, in registration order
+    QString name;                   ///< Thread name for the trace viewer
+    QAtomicInteger<quint64> head;   ///< Spans ever recorded
+    TraceEvent events[TraceRecorder::EVENTS_PER_THREAD];
+};
+
+/**
+ * @brief Every thread's buffer; lives for the whole process
+ */
+struct Registry {
+    QMutex mutex;
+    QVector<ThreadBuffer*> buffers;
+};
+
+Registry& registry()
+{
+    // Never destroyed: pool threads may still record during shutdown
+    static Registry* instance = new Registry;
+    return *instance;
+}
+
+ThreadBuffer& threadBuffer()
+{
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        buffer = new ThreadBuffer;
+        const QString threadName = QThread::currentThread()->objectName();
+
+        Registry& all = registry();
+        QMutexLocker locker(&all.mutex);
+        buffer->tid = all.buffers.size() + 1;
+        buffer->name = threadName.isEmpty() ? QString("thread %1").arg(buffer->tid) : threadName;
+        all.buffers.append(buffer);
+    }
+    return *buffer;
+}
+
+/**
+ * @brief Appends nanoseconds as microseconds with three decimals
+ */
+void appendMicros(QByteArray& out, qint64 ns)
+{
+    out += QByteArray::number(ns / 1000);
+    out += '.';
+    const QByteArray fraction = QByteArray::number(ns % 1000);
+    out += QByteArray(3 - fraction.size(), '0');
+    out += fraction;
+}
+
+} // namespace
+
+qint64 TraceRecorder::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void TraceRecorder::record(const char* name, qint64 startNs, qint64 endNs)
+{
+    ThreadBuffer& buffer = threadBuffer();
+    const quint64 head = buffer.head.loadRelaxed();
+    TraceEvent& event = buffer.events[head & (EVENTS_PER_THREAD - 1)];
+
+    event.name.storeRelaxed(name);
+    event.startNs.storeRelaxed(startNs);
+    event.durationNs.storeRelaxed(endNs - startNs);
+    buffer.head.storeRelease(head + 1);
+}
+
+QByteArray TraceRecorder::exportChromeTrace()
+{
+    struct Span {
+        const char* name;
+        qint64 startNs;
+        qint64 durationNs;
+    };
+
+    QVector<ThreadBuffer*> buffers;
+    {
+        Registry& all = registry();
+        QMutexLocker locker(&all.mutex);
+        buffers = all.buffers;
+    }
+
+    // Copy first so timestamps can be made relative to the earliest span
+    QVector<QVector<Span>> spans(buffers.size());
+    qint64 originNs = std::numeric_limits<qint64>::max();
+    for (int i = 0; i < buffers.size(); ++i) {
+        ThreadBuffer& buffer = *buffers[i];
+        const quint64 head = buffer.head.loadAcquire();
+        const quint64 first = head > quint64(EVENTS_PER_THREAD) ? head - EVENTS_PER_THREAD : 0;
+
+        QVector<Span>& copied = spans[i];
+        copied.reserve(int(head - first));
+        for (quint64 index = first; index < head; ++index) {
+            const TraceEvent& event = buffer.events[index & (EVENTS_PER_THREAD - 1)];
+            copied.append({event.name.loadRelaxed(), event.startNs.loadRelaxed(),
+                           event.durationNs.loadRelaxed()});
+        }
+
+        // The owner kept recording meanwhile: drop the slots it reused
+        const quint64 after = buffer.head.loadAcquire();
+        const quint64 overwritten = after > quint64(EVENTS_PER_THREAD)
+                                        ? qMin(after - EVENTS_PER_THREAD, head) : 0;
+        if (overwritten > first) {
+            copied.remove(0, int(overwritten - first));
+        }
+
+        for (const Span& span : std::as_const(copied)) {
+            originNs = qMin(originNs, span.startNs);
+        }
+    }
+
+    const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+    QByteArray out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool firstEvent = true;
+    auto separate = [&out, &firstEvent]() {
+        if (!firstEvent) {
+            out += ",\n";
+        }
+        firstEvent = false;
+    };
+
+    for (int i = 0; i < buffers.size(); ++i) {
+        const QByteArray tid = QByteArray::number(buffers[i]->tid);
+
+        separate();
+        // Thread names come from QThread::objectName() and may hold anything
+        out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + pid + ",\"tid\":" + tid
+               + ",\"args\":{\"name\":";
+        appendJsonString(out, buffers[i]->name);
+        out += "}}";
+
+        // Span names are string literals chosen by the code, so no escaping
+        for (const Span& span : std::as_const(spans[i])) {
+            separate();
+            out += "{\"name\":\"";
+            out += span.name;
+            out += "\",\"cat\":\"booking\",\"ph\":\"X\",\"ts\":";
+            appendMicros(out, span.startNs - originNs);
+            out += ",\"dur\":";
+            appendMicros(out, span.durationNs);
+            out += ",\"pid\":" + pid + ",\"tid\":" + tid + "}";
+        }
+    }
+
+    out += "]}\n";
+    return out;
+}
+
+bool TraceRecorder::writeChromeTrace(const QString& path, QString* error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) {
+            *error = QString("Cannot open %1: %2").arg(path, file.errorString());
+        }
+        return false;
+    }
+
+    const QByteArray trace = exportChromeTrace();
+    if (file.write(trace) != trace.size()) {
+        if (error) {
+            *error = QString("Cannot write %1: %2").arg(path, file.errorString());
+        }
+        return false;
+    }
+    return true;
+}
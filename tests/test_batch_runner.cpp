@@ -0,0 +1,236 @@
+#include <QtTest/QtTest>
+#include <QBuffer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include "cli/BatchRunner.h"
+#include "core/BookingService.h"
+
+/**
+ * @brief Test suite for scripted command runs
+ */
+class TestBatchRunner : public QObject {
+    Q_OBJECT
+
+private:
+    /**
+     * @brief Runs a script and parses every output line
+     * @param runner Runner to drive
+     * @param script Input lines
+     * @param summary Receives the run's totals
+     * @return One JSON object per output line
+     */
+    static QVector<QJsonObject> run(BatchRunner& runner, const QByteArray& script,
+                                    BatchRunner::Summary* summary = nullptr) {
+        QByteArray scriptData = script;
+        QBuffer input(&scriptData);
+        input.open(QIODevice::ReadOnly);
+
+        QByteArray outputData;
+        QBuffer output(&outputData);
+        output.open(QIODevice::WriteOnly);
+
+        const BatchRunner::Summary totals = runner.run(input, output);
+        if (summary) {
+            *summary = totals;
+        }
+
+        QVector<QJsonObject> lines;
+        for (const QByteArray& line : outputData.split('\n')) {
+            if (line.isEmpty()) {
+                continue;
+            }
+            QJsonParseError error;
+            const QJsonDocument document = QJsonDocument::fromJson(line, &error);
+            if (error.error != QJsonParseError::NoError || !document.isObject()) {
+                qWarning() << "Output line is not a JSON object:" << line;
+                return {};
+            }
+            lines.append(document.object());
+        }
+        return lines;
+    }
+
+private slots:
+    /**
+     * @brief Test that words and JSON lines can be mixed, with comments skipped
+     */
+    void testMixedWordsAndJson() {
+        BookingService service;
+        BatchRunner runner(service);
+
+        BatchRunner::Summary summary;
+        const QVector<QJsonObject> lines = run(runner,
+            "movies\n"
+            "# a comment\n"
+            "\n"
+            "{\"command\": \"seats\", \"theaterId\": 1, \"movieId\": 1}\n"
+            "reserve 1 1 A1,A2 Jane Doe\n"
+            "{\"command\": \"bookings\", \"customer\": \"Jane Doe\"}\n"
+            "seats 1 1", &summary);
+
+        QCOMPARE(lines.size(), 5);
+        QCOMPARE(summary.commands, 5);
+        QCOMPARE(summary.failed, 0);
+
+        QCOMPARE(lines[0].value("line").toInt(), 1);
+        QCOMPARE(lines[0].value("command").toString(), QString("movies"));
+        QCOMPARE(lines[0].value("movies").toArray().size(), 4);
+
+        QCOMPARE(lines[1].value("line").toInt(), 4);
+        QCOMPARE(lines[1].value("available").toInt(), Theater::TOTAL_SEATS);
+
+        QCOMPARE(lines[2].value("line").toInt(), 5);
+        QVERIFY(lines[2].value("ok").toBool());
+        const int bookingId = lines[2].value("bookingId").toInt();
+        QVERIFY(bookingId > 0);
+
+        const QJsonArray bookings = lines[3].value("bookings").toArray();
+        QCOMPARE(bookings.size(), 1);
+        QCOMPARE(bookings[0].toObject().value("id").toInt(), bookingId);
+        QCOMPARE(bookings[0].toObject().value("seats").toArray(), QJsonArray({"A1", "A2"}));
+
+        // The last line has no newline and still runs
+        QCOMPARE(lines[4].value("line").toInt(), 7);
+        QCOMPARE(lines[4].value("available").toInt(), Theater::TOTAL_SEATS - 2);
+    }
+
+    /**
+     * @brief Test that malformed lines fail on their own and the run goes on
+     */
+    void testMalformedLines() {
+        BookingService service;
+        BatchRunner runner(service);
+
+        BatchRunner::Summary summary;
+        const QVector<QJsonObject> lines = run(runner,
+            "reserve 1 x A1 Bob\n"
+            "{not json\n"
+            "{\"command\": \"seats\", \"theaterId\": 1}\n"
+            "{\"theaterId\": 1}\n"
+            "fly 1\n"
+            "cancel 999\n"
+            "reserve 1 1 A1 Bob\n"
+            "reserve 1 1 A1 Eve\n", &summary);
+
+        QCOMPARE(lines.size(), 8);
+        QCOMPARE(summary.commands, 8);
+        QCOMPARE(summary.failed, 7);
+
+        for (int i = 0; i < 5; ++i) {
+            QVERIFY(!lines[i].value("ok").toBool());
+            QCOMPARE(lines[i].value("code").toString(), QString("InvalidCommand"));
+            QCOMPARE(lines[i].value("line").toInt(), i + 1);
+            QVERIFY(!lines[i].value("error").toString().isEmpty());
+        }
+        QCOMPARE(lines[2].value("error").toString(), QString("Invalid arguments for seats"));
+        QCOMPARE(lines[3].value("error").toString(), QString("Missing command"));
+        QCOMPARE(lines[4].value("command").toString(), QString("fly"));
+
+        QCOMPARE(lines[5].value("code").toString(), QString("CancelRejected"));
+        QVERIFY(lines[6].value("ok").toBool());
+        QCOMPARE(lines[7].value("code").toString(), QString("SeatTaken"));
+        QCOMPARE(lines[7].value("free").toInt(), Theater::TOTAL_SEATS - 1);
+    }
+
+    /**
+     * @brief Test that quotes and control characters in echoed text stay valid JSON
+     */
+    void testEscapesCustomerNamesAndCommands() {
+        BookingService service;
+        BatchRunner runner(service);
+
+        const QString customer = QString("Jane \"JD\" Doe\\\n\t\x01");
+        QJsonObject waitlist{{"command", "waitlist"}, {"theaterId", 1}, {"movieId", 1},
+                             {"seatCount", 2}, {"customer", customer}};
+        QJsonObject odd{{"command", "dr\"op\x02"}};
+        const QByteArray script = QJsonDocument(waitlist).toJson(QJsonDocument::Compact) + "\n"
+                                  + QJsonDocument(odd).toJson(QJsonDocument::Compact) + "\n";
+
+        BatchRunner::Summary summary;
+        const QVector<QJsonObject> lines = run(runner, script, &summary);
+
+        // The party fits at once: its promotion follows the waitlist result
+        QCOMPARE(lines.size(), 3);
+        QVERIFY(lines[0].value("ok").toBool());
+        QCOMPARE(lines[1].value("event").toString(), QString("waitlistPromoted"));
+        QCOMPARE(lines[1].value("waitlistId").toInt(), lines[0].value("waitlistId").toInt());
+        QCOMPARE(lines[1].value("customer").toString(), customer);
+
+        QCOMPARE(lines[2].value("command").toString(), QString("dr\"op\x02"));
+        QCOMPARE(lines[2].value("error").toString(), QString("Invalid arguments for dr\"op\x02"));
+        QCOMPARE(summary.commands, 2);
+        QCOMPARE(summary.failed, 1);
+    }
+
+    /**
+     * @brief Test that a reserve key replays the original booking
+     */
+    void testReserveKeyReplays() {
+        BookingService service;
+        BatchRunner runner(service);
+
+        BatchRunner::Summary summary;
+        const QVector<QJsonObject> lines = run(runner,
+            "{\"command\": \"reserve\", \"theaterId\": 2, \"movieId\": 3, \"seats\": [\"A5\"],"
+            " \"customer\": \"Kim\", \"key\": \"order-17\"}\n"
+            "{\"command\": \"reserve\", \"theaterId\": 2, \"movieId\": 3, \"seats\": \"A5\","
+            " \"customer\": \"Kim\", \"key\": \"order-17\"}\n"
+            "{\"command\": \"reserve\", \"theaterId\": 2, \"movieId\": 3, \"seats\": [\"A6\"],"
+            " \"customer\": \"Kim\", \"key\": \"order-17\"}\n"
+            "seats 2 3\n", &summary);
+
+        QCOMPARE(lines.size(), 4);
+        QVERIFY(lines[0].value("ok").toBool());
+        QVERIFY(lines[1].value("ok").toBool());
+        QCOMPARE(lines[1].value("bookingId").toInt(), lines[0].value("bookingId").toInt());
+        QCOMPARE(lines[2].value("code").toString(), QString("IdempotencyMismatch"));
+        QCOMPARE(lines[3].value("available").toInt(), Theater::TOTAL_SEATS - 1);
+        QCOMPARE(service.getBookingData("Kim").size(), 1);
+        QCOMPARE(summary.commands, 4);
+        QCOMPARE(summary.failed, 1);
+    }
+
+    /**
+     * @brief Test that a waitlist promotion is reported right after the cancel that caused it
+     */
+    void testPromotionFollowsCancelResult() {
+        BookingService service;
+        CatalogData catalog;
+        catalog.movies = {{1, "Epic", 200, "Drama"}};
+        catalog.theaters = {{1, "Tiny Hall", 2}};
+        catalog.showings = {{1, 1}};
+        QString error;
+        QVERIFY2(service.loadCatalog(catalog, &error), qPrintable(error));
+
+        BatchRunner runner(service);
+        QVector<QJsonObject> lines = run(runner,
+            "reserve 1 1 A1,A2 Ann\n"
+            "waitlist 1 1 2 Bob Roe\n");
+        QCOMPARE(lines.size(), 2);
+        const int bookingId = lines[0].value("bookingId").toInt();
+        const int waitlistId = lines[1].value("waitlistId").toInt();
+        QVERIFY(waitlistId > 0);
+
+        BatchRunner::Summary summary;
+        lines = run(runner, QString("cancel %1\nbookings Bob Roe\n").arg(bookingId).toUtf8(),
+                    &summary);
+
+        QCOMPARE(lines.size(), 3);
+        QCOMPARE(lines[0].value("command").toString(), QString("cancel"));
+        QVERIFY(lines[0].value("ok").toBool());
+        QCOMPARE(lines[1].value("event").toString(), QString("waitlistPromoted"));
+        QCOMPARE(lines[1].value("waitlistId").toInt(), waitlistId);
+        QCOMPARE(lines[1].value("customer").toString(), QString("Bob Roe"));
+        const QJsonArray bookings = lines[2].value("bookings").toArray();
+        QCOMPARE(bookings.size(), 1);
+        QCOMPARE(bookings[0].toObject().value("id").toInt(), lines[1].value("bookingId").toInt());
+
+        // Events are not commands
+        QCOMPARE(summary.commands, 2);
+        QCOMPARE(summary.failed, 0);
+    }
+};
+
+QTEST_MAIN(TestBatchRunner)
+#include "test_batch_runner.moc"
@@ -1,5 +1,6 @@
 #include <QtTest/QtTest>
 #include "core/BookingService.h"
+#include <QJsonDocument>
 
 /**
  * @brief Test suite for BookingService functionality
@@ -62,7 +63,7 @@ private slots:
         
         QStringList seatIds = {"A1"};
         bool result = m_service->reserveSeats(theaters[0]->getId(), movies[0]->getId(),
-                                             seatIds, "John Doe");
+                                             seatIds, "John Doe").ok();
         
         QVERIFY(result);
         
@@ -81,7 +82,7 @@ private slots:
         
         QStringList seatIds = {"A1", "A2", "A3"};
         bool result = service->reserveSeats(theaters[0]->getId(), movies[0]->getId(),
-                                           seatIds, "Jane Doe");
+                                           seatIds, "Jane Doe").ok();
         
         QVERIFY(result);
         
@@ -101,12 +102,12 @@ private slots:
         
         // First reservation
         bool result1 = service->reserveSeats(theaters[0]->getId(), movies[0]->getId(),
-                                            seatIds, "Customer1");
+                                            seatIds, "Customer1").ok();
         QVERIFY(result1);
         
         // Second reservation of same seat
         bool result2 = service->reserveSeats(theaters[0]->getId(), movies[0]->getId(),
-                                            seatIds, "Customer2");
+                                            seatIds, "Customer2").ok();
         QVERIFY(!result2);
     }
     
@@ -130,6 +131,1201 @@ private slots:
         QCOMPARE(bookings[0].seatIds.size(), 2);
     }
 
+    /**
+     * @brief Test that booking details carry movie and hall names
+     */
+    void testBookingDetailsResolveNames() {
+        auto service = std::make_unique<BookingService>();
+        QVERIFY(service->reserveSeats(2, 3, {"A4", "A5"}, "Details Customer"));
+        QVERIFY(service->reserveSeats(1, 4, {"A1"}, "Details Customer"));
+        QVERIFY(service->getBookingDetails("Nobody").isEmpty());
+
+        auto details = service->getBookingDetails("Details Customer");
+        QCOMPARE(details.size(), 2);
+        QCOMPARE(details[0].movieTitle, QString("Oppenheimer"));
+        QCOMPARE(details[0].theaterName, QString("VIP Hall"));
+        QCOMPARE(details[0].seatIds, QStringList({"A4", "A5"}));
+        QCOMPARE(details[0].totalPrice, details[0].seatPrices[0] + details[0].seatPrices[1]);
+        QCOMPARE(details[1].movieTitle, QString("Barbie"));
+
+        // Sparse IDs; movies dropped by a reload keep their booking, not their name
+        CatalogData catalog;
+        catalog.movies = {{3, "Oppenheimer", 180, "Drama"}, {900000, "Late Show", 95, "Horror"}};
+        catalog.theaters = {{1, "IMAX Hall", 20}, {2, "VIP Hall", 20}};
+        catalog.showings = {{2, 3}, {1, 900000}};
+        QVERIFY(service->loadCatalog(catalog));
+        QVERIFY(service->reserveSeats(1, 900000, {"A2"}, "Details Customer"));
+
+        details = service->getBookingDetails("Details Customer");
+        QCOMPARE(details.size(), 3);
+        QCOMPARE(details[0].movieTitle, QString("Oppenheimer"));
+        QVERIFY(details[1].movieTitle.isEmpty());
+        QCOMPARE(details[1].theaterName, QString("IMAX Hall"));
+        QCOMPARE(details[2].movieTitle, QString("Late Show"));
+    }
+
+    /**
+     * @brief Test that indexed movie queries follow the published catalog
+     */
+    void testMovieSearchIndexes() {
+        auto service = std::make_unique<BookingService>();
+
+        QCOMPARE(service->getMovie(2)->getTitle(), QString("Dune: Part Two"));
+        QVERIFY(!service->getMovie(99));
+
+        auto sciFi = service->findMoviesByGenre("sci-fi");
+        QCOMPARE(sciFi.size(), 2);
+        QCOMPARE(sciFi[0]->getId(), 1);
+        QCOMPARE(sciFi[1]->getId(), 2);
+        QVERIFY(service->findMoviesByGenre("Horror").isEmpty());
+
+        // Prefixes are case-insensitive; results come in title order
+        QCOMPARE(service->findMoviesByTitlePrefix("THE M").size(), 1);
+        QCOMPARE(service->findMoviesByTitlePrefix("d").first()->getId(), 2);
+        QVERIFY(service->findMoviesByTitlePrefix("x").isEmpty());
+        auto all = service->findMoviesByTitlePrefix("");
+        QCOMPARE(all.size(), 4);
+        QCOMPARE(all.first()->getTitle(), QString("Barbie"));
+        QCOMPARE(service->findMoviesByTitlePrefix("", 2).size(), 2);
+
+        auto midLength = service->findMoviesByDuration(140, 170);
+        QCOMPARE(midLength.size(), 2);
+        QCOMPARE(midLength[0]->getDuration(), 148);
+        QCOMPARE(midLength[1]->getDuration(), 166);
+        QCOMPARE(service->findMoviesByDuration(180, 180).first()->getId(), 3);
+
+        // A reload publishes new indexes with the new catalog
+        CatalogData catalog;
+        catalog.movies = {{1, "The Matrix Resurrections", 148, "Sci-Fi"},
+                          {7, "The Mummy", 124, "Horror"}};
+        catalog.theaters = {{1, "IMAX Hall", 20}};
+        catalog.showings = {{1, 1}, {1, 7}};
+        QString error;
+        QVERIFY2(service->loadCatalog(catalog, &error), qPrintable(error));
+
+        QVERIFY(!service->getMovie(2));
+        QCOMPARE(service->getMovie(7)->getTitle(), QString("The Mummy"));
+        QCOMPARE(service->findMoviesByGenre("horror").size(), 1);
+        QCOMPARE(service->findMoviesByTitlePrefix("the m").size(), 2);
+        QCOMPARE(service->findMoviesByTitlePrefix("the mu").first()->getId(), 7);
+        QVERIFY(service->findMoviesByDuration(160, 200).isEmpty());
+    }
+
+    /**
+     * @brief Test that pages and visitors cover listings without gaps
+     */
+    void testPagingAndStreamingListings() {
+        auto service = std::make_unique<BookingService>();
+        QVERIFY(service->reserveSeats(1, 1, {"A2", "A6"}, "Pager"));
+
+        // Movies: 4 in pages of 3
+        auto movies = service->getMoviesPage(0, 3);
+        QCOMPARE(movies.items.size(), 3);
+        QCOMPARE(movies.nextCursor, 3);
+        movies = service->getMoviesPage(movies.nextCursor, 3);
+        QCOMPARE(movies.items.size(), 1);
+        QCOMPARE(movies.nextCursor, -1);
+        QCOMPARE(service->getTheatersPage(1, 0, 2).nextCursor, 2);
+
+        // Seats: cursors are seat indices, so taken seats are skipped, not shifted
+        auto seats = service->getAvailableSeatsPage(1, 1, 0, 5);
+        QCOMPARE(seats.items.first()->getId(), QString("A1"));
+        QCOMPARE(seats.items.last()->getId(), QString("A7"));
+        QCOMPARE(seats.nextCursor, 7);
+        int paged = seats.items.size();
+        while (seats.nextCursor >= 0) {
+            seats = service->getAvailableSeatsPage(1, 1, seats.nextCursor, 5);
+            paged += seats.items.size();
+        }
+        QCOMPARE(paged, 18);
+
+        QStringList streamed;
+        QCOMPARE(service->forEachAvailableSeat(1, 1, [&streamed](Seat* seat) {
+                     streamed.append(seat->getId());
+                     return true;
+                 }), 18);
+        QCOMPARE(streamed.mid(0, 3), QStringList({"A1", "A3", "A4"}));
+        QCOMPARE(service->forEachAvailableSeat(1, 1, [](Seat*) { return false; }), 1);
+
+        // Bookings: more than one streaming chunk; the visitor may book too
+        for (int i = 0; i < 70; ++i) {
+            QVERIFY(service->reserveSeats(2 + i % 2, 1 + i / 2 % 4, {QString("A%1").arg(i / 8 + 1)},
+                                          "Pager"));
+        }
+        QVector<int> ids;
+        QCOMPARE(service->forEachBooking("Pager", [&](const BookingService::BookingData& booking) {
+                     ids.append(booking.id);
+                     if (ids.size() == 1) {
+                         service->reserveSeats(1, 4, {"A20"}, "Pager");
+                     }
+                     return true;
+                 }), 72);
+        QVERIFY(std::is_sorted(ids.cbegin(), ids.cend()));
+
+        auto bookings = service->getBookingDataPage("Pager", 0, 50);
+        QCOMPARE(bookings.items.size(), 50);
+        bookings = service->getBookingDataPage("Pager", bookings.nextCursor, 50);
+        QCOMPARE(bookings.items.size(), 22);
+        QCOMPARE(bookings.nextCursor, -1);
+        QCOMPARE(bookings.items.last().id, ids.last());
+        QCOMPARE(service->getBookingDataPage("Nobody", 0, 10).items.size(), 0);
+
+        // Cancelling between pages or chunks skips nothing that is still live
+        bookings = service->getBookingDataPage("Pager", 0, 10);
+        QVERIFY(service->cancelBooking(bookings.items[0].id));
+        bookings = service->getBookingDataPage("Pager", bookings.nextCursor, 10);
+        QCOMPARE(bookings.items.first().id, ids[10]);
+
+        QVector<int> visitedIds;
+        service->forEachBooking("Pager", [&](const BookingService::BookingData& booking) {
+            visitedIds.append(booking.id);
+            if (visitedIds.size() == 1) {
+                service->cancelBooking(ids[2]);
+            }
+            return true;
+        });
+        QCOMPARE(visitedIds, ids.mid(1));
+    }
+
+    /**
+     * @brief Test that seat charts are cached and patched per change
+     */
+    void testSeatChartPatchesChangedSeats() {
+        auto service = std::make_unique<BookingService>();
+        using Format = SeatChartTemplate::Format;
+
+        auto text = service->getSeatChart(1, 1, Format::Text);
+        QCOMPARE(text.freeCount, 20);
+        QCOMPARE(text.data, QByteArray("A1  A2  A3  A4  A5  A6  A7  A8  A9  A10\n"
+                                       "A11 A12 A13 A14 A15 A16 A17 A18 A19 A20\n"));
+
+        // Unchanged showing: served from the cache
+        auto cached = service->getSeatChart(1, 1, Format::Text);
+        QCOMPARE(cached.version, text.version);
+        QCOMPARE(cached.data, text.data);
+
+        QVERIFY(service->reserveSeats(1, 1, {"A2", "A10", "A11"}, "Chart Customer"));
+        auto patched = service->getSeatChart(1, 1, Format::Text);
+        QCOMPARE(patched.version, service->getSeatMapVersion(1, 1));
+        QCOMPARE(patched.freeCount, 17);
+        QCOMPARE(patched.data, QByteArray("A1  --  A3  A4  A5  A6  A7  A8  A9  ---\n"
+                                          "--- A12 A13 A14 A15 A16 A17 A18 A19 A20\n"));
+        QCOMPARE(text.data.left(4), QByteArray("A1  "));  // Earlier copies are unaffected
+
+        auto json = service->getSeatChart(1, 1, Format::Json);
+        QVERIFY(json.data.startsWith("{\"capacity\":20,\"seats\":[[\"A1\",1],[\"A2\",0],"));
+        QVERIFY(json.data.endsWith("[\"A19\",1],[\"A20\",1]]}"));
+        QVERIFY(QJsonDocument::fromJson(json.data).isObject());
+
+        // Unknown showing
+        QVERIFY(service->getSeatChart(99, 1, Format::Text).data.isEmpty());
+    }
+
+    /**
+     * @brief Test request rate limits and per-showing seat quotas
+     */
+    void testRateLimitsAndSeatQuotas() {
+        auto service = std::make_unique<BookingService>();
+        using Code = ReservationResult::Code;
+
+        // Customer bucket of 3 requests that effectively never refills
+        service->setRateLimits({0.001, 3, 0, 0, 0});
+        QCOMPARE(service->getRateLimits().customerBurst, 3);
+        QVERIFY(service->reserveSeats(1, 1, {"A1"}, "Bot"));
+        QCOMPARE(service->reserveSeats(1, 1, {"A1"}, "Bot").code, Code::SeatTaken);  // Still counted
+        QVERIFY(service->reserveSeats(1, 2, {"A1"}, "Bot"));
+        auto result = service->reserveSeats(1, 3, {"A1"}, "Bot");
+        QCOMPARE(result.code, Code::RateLimited);
+        QVERIFY(result.estimatedWaitMs > 0);
+        QVERIFY(service->reserveSeats(1, 3, {"A1"}, "Human"));
+
+        // Showing bucket: shared by every customer
+        service->setRateLimits({0, 0, 0.001, 2, 0});
+        QVERIFY(service->reserveSeats(2, 1, {"A1"}, "First"));
+        QVERIFY(service->reserveSeats(2, 1, {"A2"}, "Second"));
+        QCOMPARE(service->reserveSeats(2, 1, {"A3"}, "Third").code, Code::RateLimited);
+        QVERIFY(service->reserveSeats(2, 2, {"A3"}, "Third"));
+
+        // Seat quota: failed requests give their seats back
+        service->setRateLimits({0, 0, 0, 0, 4});
+        QVERIFY(service->reserveSeats(3, 1, {"A1", "A2", "A3"}, "Scalper"));
+        result = service->reserveSeats(3, 1, {"A4", "A5"}, "Scalper");
+        QCOMPARE(result.code, Code::QuotaExceeded);
+        QCOMPARE(result.quotaLeft, 1);
+        QCOMPARE(service->reserveSeats(3, 1, {"A1"}, "Scalper").code, Code::SeatTaken);
+        QVERIFY(service->reserveSeats(3, 1, {"A4"}, "Scalper"));
+        QVERIFY(service->reserveSeats(3, 2, {"A1", "A2", "A3", "A4"}, "Scalper"));
+
+        // Groups are checked per showing; a rejected part undoes the others
+        QCOMPARE(service->reserveGroup({{2, 4, {"A1"}}, {3, 2, {"A5"}}}, "Scalper").code,
+                 Code::QuotaExceeded);
+        QVERIFY(service->reserveGroup({{2, 4, {"A1", "A2", "A3", "A4"}}, {3, 3, {"A1"}}},
+                                      "Scalper"));
+
+        // Limits off: nothing is checked
+        service->setRateLimits({});
+        QVERIFY(service->reserveSeats(3, 1, {"A5", "A6"}, "Scalper"));
+    }
+
+    /**
+     * @brief Test that cancelling bookings the quota never counted leaves later holds alone
+     */
+    void testSeatQuotaEnabledAfterBookings() {
+        auto service = std::make_unique<BookingService>();
+        using Code = ReservationResult::Code;
+
+        const int uncounted = service->reserveSeats(1, 1, {"A1", "A2", "A3"}, "Alice").bookingId;
+        QVERIFY(uncounted > 0);
+
+        service->setRateLimits({0, 0, 0, 0, 4});
+        QVERIFY(service->reserveSeats(1, 1, {"A4", "A5"}, "Alice"));
+        QVERIFY(service->cancelBooking(uncounted));
+
+        // Still two seats held: the cancelled booking was admitted without a quota
+        auto result = service->reserveSeats(1, 1, {"A6", "A7", "A8"}, "Alice");
+        QCOMPARE(result.code, Code::QuotaExceeded);
+        QCOMPARE(result.quotaLeft, 2);
+
+        // Holds from before the quota was turned off are not given back to the new one
+        const int earlier = service->reserveSeats(1, 2, {"A1", "A2"}, "Alice").bookingId;
+        QVERIFY(earlier > 0);
+        service->setRateLimits({});
+        service->setRateLimits({0, 0, 0, 0, 4});
+        QVERIFY(service->reserveSeats(1, 2, {"A3", "A4", "A5"}, "Alice"));
+        QVERIFY(service->cancelBooking(earlier));
+        result = service->reserveSeats(1, 2, {"A6", "A7"}, "Alice");
+        QCOMPARE(result.code, Code::QuotaExceeded);
+        QCOMPARE(result.quotaLeft, 1);
+    }
+
+    /**
+     * @brief Test that seat map deltas contain only the changed seats
+     */
+    void testSeatChangesSinceReturnsOnlyChangedSeats() {
+        auto service = std::make_unique<BookingService>();
+        auto movies = service->getMovies();
+        auto theaters = service->getTheaters(movies[0]->getId());
+        int theaterId = theaters[0]->getId();
+        int movieId = movies[0]->getId();
+        
+        quint64 initialVersion = service->getSeatMapVersion(theaterId, movieId);
+        QCOMPARE(initialVersion, quint64(0));
+        
+        QVERIFY(service->reserveSeats(theaterId, movieId, {"A3", "A7"}, "Delta Customer"));
+        
+        auto changeSet = service->getSeatChangesSince(theaterId, movieId, initialVersion);
+        QVERIFY(!changeSet.isFullSnapshot);
+        QCOMPARE(changeSet.version, service->getSeatMapVersion(theaterId, movieId));
+        QCOMPARE(changeSet.changes.size(), 2);
+        QCOMPARE(changeSet.changes[0].seatIndex, 2);
+        QVERIFY(!changeSet.changes[0].available);
+        QCOMPARE(changeSet.changes[1].seatIndex, 6);
+        
+        // An up-to-date client gets nothing
+        auto upToDate = service->getSeatChangesSince(theaterId, movieId, changeSet.version);
+        QVERIFY(!upToDate.isFullSnapshot);
+        QVERIFY(upToDate.changes.isEmpty());
+    }
+    
+    /**
+     * @brief Test that clients too far behind receive a full snapshot
+     */
+    void testSeatChangesSinceFallsBackToSnapshot() {
+        auto service = std::make_unique<BookingService>();
+        auto movies = service->getMovies();
+        auto theaters = service->getTheaters(movies[0]->getId());
+        int theaterId = theaters[0]->getId();
+        int movieId = movies[0]->getId();
+        
+        // Stale version from the future (e.g. client survived a restart)
+        auto fromFuture = service->getSeatChangesSince(theaterId, movieId, 42);
+        QVERIFY(fromFuture.isFullSnapshot);
+        QCOMPARE(fromFuture.changes.size(), 20);
+        
+        SeatChangeLog log(4);
+        for (int i = 0; i < 6; ++i) {
+            log.record(quint64(i + 1), i);
+        }
+        QVector<int> changed;
+        QVERIFY(!log.changesSince(0, changed));
+        QVERIFY(log.changesSince(4, changed));
+        QCOMPARE(changed, QVector<int>({4, 5}));
+    }
+
+    /**
+     * @brief Test that a group booking spanning two halls reserves all seats
+     */
+    void testReserveGroupAcrossHallsSuccess() {
+        auto service = std::make_unique<BookingService>();
+
+        QVector<BookingService::ShowingRequest> requests = {
+            {1, 2, {"A1", "A2", "A3"}},
+            {2, 2, {"A1", "A2"}}
+        };
+        QVERIFY(service->reserveGroup(requests, "School Trip"));
+
+        QCOMPARE(service->getAvailableSeats(1, 2).size(), 17);
+        QCOMPARE(service->getAvailableSeats(2, 2).size(), 18);
+        QCOMPARE(service->getBookingData("School Trip").size(), 2);
+    }
+
+    /**
+     * @brief Test that a group booking with one taken seat reserves nothing
+     */
+    void testReserveGroupIsAllOrNothing() {
+        auto service = std::make_unique<BookingService>();
+        QVERIFY(service->reserveSeats(2, 2, {"A2"}, "Early Bird"));
+
+        QVector<BookingService::ShowingRequest> requests = {
+            {1, 2, {"A1", "A2", "A3"}},
+            {2, 2, {"A1", "A2"}}
+        };
+        QVERIFY(!service->reserveGroup(requests, "School Trip"));
+
+        QCOMPARE(service->getAvailableSeats(1, 2).size(), 20);
+        QCOMPARE(service->getAvailableSeats(2, 2).size(), 19);
+        QCOMPARE(service->getSeatMapVersion(1, 2), quint64(0));
+        QVERIFY(service->getBookingData("School Trip").isEmpty());
+    }
+
+    /**
+     * @brief Test that a sold-out showing rejects callers up front
+     */
+    void testSoldOutShowingFailsFast() {
+        auto service = std::make_unique<BookingService>();
+
+        QStringList allSeats;
+        for (int i = 1; i <= 20; ++i) {
+            allSeats.append(QString("A%1").arg(i));
+        }
+        QCOMPARE(service->getAdmissionPosition(1, 1).status, AdmissionQueue::Status::Admitted);
+        QVERIFY(service->reserveSeats(1, 1, allSeats, "Fan Club"));
+
+        QSignalSpy failedSpy(service.get(), &BookingService::reservationFailed);
+        QVERIFY(!service->reserveSeats(1, 1, {"A1"}, "Late Fan"));
+        QCOMPARE(failedSpy.count(), 1);
+        QCOMPARE(failedSpy.at(0).at(0).toString(), QString("Showing is sold out"));
+        QCOMPARE(service->getAdmissionPosition(1, 1).status, AdmissionQueue::Status::SoldOut);
+    }
+
+    /**
+     * @brief Test that hopeless requests are rejected before reaching the seats
+     */
+    void testUnavailableSeatsRejectedEarly() {
+        auto service = std::make_unique<BookingService>();
+        QVERIFY(service->reserveSeats(1, 1, {"A5"}, "First"));
+        quint64 version = service->getSeatMapVersion(1, 1);
+
+        QSignalSpy failedSpy(service.get(), &BookingService::reservationFailed);
+        QVERIFY(!service->reserveSeats(1, 1, {"A4", "A5"}, "Second"));
+        QVERIFY(!service->reserveSeats(1, 1, {"B1"}, "Second"));
+
+        QStringList tooMany;
+        for (int i = 1; i <= 20; ++i) {
+            tooMany.append(QString("A%1").arg(i));
+        }
+        QVERIFY(!service->reserveSeats(1, 1, tooMany, "Second"));
+
+        QCOMPARE(failedSpy.count(), 3);
+        QCOMPARE(failedSpy.at(0).at(0).toString(), QString("Seat A5 is not available"));
+        QCOMPARE(failedSpy.at(1).at(0).toString(), QString("Seat B1 not found"));
+        QCOMPARE(failedSpy.at(2).at(0).toString(), QString("Only 19 seats left"));
+        QCOMPARE(service->getSeatMapVersion(1, 1), version);
+        QCOMPARE(service->getAvailableSeats(1, 1).size(), 19);
+    }
+
+    /**
+     * @brief Test that failures come back as codes with the offending seats
+     */
+    void testReservationResultReportsDetails() {
+        auto service = std::make_unique<BookingService>();
+        using Code = ReservationResult::Code;
+
+        ReservationResult result = service->reserveSeats(1, 1, {"A5"}, "First");
+        QVERIFY(result.ok());
+        QVERIFY(result.bookingId > 0);
+        QCOMPARE(result.freeCount, 19);
+
+        const QStringList unknown = {"A4", "B1", "A5", "Z9"};
+        result = service->reserveSeats(1, 1, unknown, "Second");
+        QCOMPARE(result.code, Code::SeatNotFound);
+        QCOMPARE(result.seatCount, 2);
+        QCOMPARE(int(result.seats[0]), 1);
+        QCOMPARE(int(result.seats[1]), 3);
+        QCOMPARE(result.describe(unknown), QString("Seats B1, Z9 not found"));
+
+        result = service->reserveSeats(1, 1, {"A4", "A5"}, "Second");
+        QCOMPARE(result.code, Code::SeatTaken);
+        QCOMPARE(result.seatCount, 1);
+        QCOMPARE(int(result.seats[0]), 4);
+        QCOMPARE(result.freeCount, 19);
+        QCOMPARE(result.describe(), QString("Seat A5 is not available"));
+
+        result = service->reserveSeats(1, 1, {"A7", "A7"}, "Second");
+        QCOMPARE(result.code, Code::DuplicateSeat);
+        QCOMPARE(result.describe(), QString("Seat A7 requested more than once"));
+
+        QCOMPARE(service->reserveSeats(99, 1, {"A1"}, "Second").code, Code::TheaterNotFound);
+        result = service->reserveSeats(1, 99, {"A1"}, "Second");
+        QCOMPARE(result.code, Code::ShowingNotFound);
+        QCOMPARE(result.describe(), QString("Movie 99 not showing in theater 1"));
+
+        // Group failures name the part that could not be served
+        result = service->reserveGroup({{1, 2, {"A1"}}, {2, 9, {"A1"}}}, "Group");
+        QCOMPARE(result.code, Code::ShowingNotFound);
+        QCOMPARE(result.theaterId, 2);
+        QCOMPARE(result.movieId, 9);
+        QCOMPARE(service->getAvailableSeats(1, 2).size(), 20);
+    }
+
+    /**
+     * @brief Test that fixed and dynamic seat maps behave the same
+     */
+    void testSeatMapFixedAndDynamicAgree() {
+        for (int capacity : {120, 37}) {
+            auto seatMap = createSeatMap(capacity);
+            QCOMPARE(seatMap->capacity(), capacity);
+            QCOMPARE(seatMap->indexOf(QString("A1")), 0);
+            QCOMPARE(seatMap->indexOf(QString("A%1").arg(capacity)), capacity - 1);
+            QCOMPARE(seatMap->indexOf(QString("A%1").arg(capacity + 1)), -1);
+            QCOMPARE(seatMap->indexOf(QString("A01")), -1);
+            QCOMPARE(seatMap->indexOf(QString("B1")), -1);
+            QCOMPARE(seatMap->seatId(capacity - 1), QString("A%1").arg(capacity));
+
+            seatMap->take({0, 5});
+            QVERIFY(seatMap->isTaken(5));
+            QVERIFY(seatMap->anyTaken({3, 5}));
+            QCOMPARE(seatMap->freeCount(), capacity - 2);
+            QCOMPARE(seatMap->freeSeats().first(), 1);
+
+            seatMap->release({5});
+            QVERIFY(!seatMap->isTaken(5));
+            QCOMPARE(seatMap->freeCount(), capacity - 1);
+        }
+        QVERIFY(dynamic_cast<FixedSeatMap<120>*>(createSeatMap(120).get()));
+        QVERIFY(dynamic_cast<DynamicSeatMap*>(createSeatMap(37).get()));
+
+        // Node-bound maps keep their flags in the same block
+        auto bound = createSeatMap(1500, 0);
+        QCOMPARE(seatMapSize(1500), sizeof(DynamicSeatMap) + 1500);
+        bound->take({1499});
+        QVERIFY(bound->isTaken(1499));
+        QCOMPARE(bound->freeSeats().last(), 1498);
+        QCOMPARE(bound->freeCount(), 1499);
+    }
+
+    /**
+     * @brief Test that compiled prices follow seat class, occupancy and hour rules
+     */
+    void testPricingEngineAppliesRules() {
+        PricingEngine pricing({{"Standard", 0, 1000}, {"Premium", 70, 2000}},
+                              {{-1, 0, 18, 24, 20}, {1, 50, 0, 24, 10}, {0, 75, 0, 24, 50}});
+
+        // Classes scale with the hall
+        QCOMPARE(pricing.seatClassOf(13, 20), 0);
+        QCOMPARE(pricing.seatClassOf(14, 20), 1);
+        QCOMPARE(pricing.seatClassOf(279, 400), 0);
+        QCOMPARE(pricing.seatClassOf(280, 400), 1);
+        QCOMPARE(pricing.priceAll(400, 0, 12).count(2000), 120);
+
+        QCOMPARE(pricing.priceOf(0, 20, 0, 12), 1000);
+        QCOMPARE(pricing.priceOf(0, 20, 0, 20), 1200);
+        QCOMPARE(pricing.priceOf(14, 20, 40, 12), 2000);
+        QCOMPARE(pricing.priceOf(14, 20, 55, 12), 2200);
+        QCOMPARE(pricing.priceOf(14, 20, 55, 20), 2640);
+
+        // Thresholds apply from the exact percentage, not the next decile
+        QCOMPARE(pricing.priceOf(0, 20, 74, 12), 1000);
+        QCOMPARE(pricing.priceOf(0, 20, 75, 12), 1500);
+        QCOMPARE(pricing.priceOf(14, 20, 49, 12), 2000);
+
+        QVector<int> prices = pricing.priceAll(20, 55, 12);
+        QCOMPARE(prices.size(), 20);
+        QCOMPARE(prices[13], 1000);
+        QCOMPARE(prices[14], 2200);
+    }
+
+    /**
+     * @brief Test that bookings keep the price computed when they were made
+     */
+    void testBookingSnapshotsSeatPrices() {
+        auto service = std::make_unique<BookingService>();
+        service->setPricing(PricingEngine({{"Standard", 0, 1000}}, {{-1, 50, 0, 24, 50}}));
+
+        QStringList firstHalf;
+        for (int i = 1; i <= 10; ++i) {
+            firstHalf.append(QString("A%1").arg(i));
+        }
+        QVERIFY(service->reserveSeats(1, 1, firstHalf, "Early"));
+        QCOMPARE(service->getSeatPrices(1, 1)[10], 1500);
+
+        QVERIFY(service->reserveSeats(1, 1, {"A11", "A12"}, "Late"));
+
+        auto early = service->getBookingData("Early");
+        QCOMPARE(early[0].totalPrice, 10000);
+        auto late = service->getBookingData("Late");
+        QCOMPARE(late[0].seatPrices, QVector<int>({1500, 1500}));
+        QCOMPARE(late[0].totalPrice, 3000);
+    }
+
+    /**
+     * @brief Test aggregate queries over the columnar booking history
+     */
+    void testBookingHistoryAggregates() {
+        CustomerRegistry customers;
+        BookingHistory history(&customers);
+        history.append(1, 1, 10, customers.intern("Alice"), {0, 1}, 2000, 7200);
+        history.append(2, 2, 10, customers.intern("Bob"), {4}, 1500, 7300);
+        history.append(3, 1, 20, customers.intern("Alice"), {2, 3, 5}, 3600, 11000);
+
+        auto byMovie = history.totalsBy(BookingHistory::Dimension::Movie);
+        QCOMPARE(byMovie.size(), 2);
+        QCOMPARE(byMovie[10].bookings, 2);
+        QCOMPARE(byMovie[10].seats, qint64(3));
+        QCOMPARE(byMovie[20].revenue, qint64(3600));
+
+        auto byTheater = history.totalsBy(BookingHistory::Dimension::Theater, 0, 10000);
+        QCOMPARE(byTheater[1].revenue, qint64(2000));
+        QCOMPARE(byTheater[2].seats, qint64(1));
+
+        auto byHour = history.totalsBy(BookingHistory::Dimension::TimeBucket);
+        QCOMPARE(byHour.keys(), QList<qint64>({7200, 10800}));
+        QCOMPARE(byHour[7200].bookings, 2);
+
+        auto byCustomer = history.totalsBy(BookingHistory::Dimension::Customer);
+        QCOMPARE(byCustomer.size(), 2);
+        const qint64 aliceKey = byCustomer.firstKey();
+        QCOMPARE(history.customerName(aliceKey), QString("Alice"));
+        QCOMPARE(byCustomer[aliceKey].seats, qint64(5));
+        QCOMPARE(history.seatIndices(2), QVector<int>({2, 3, 5}));
+    }
+
+    /**
+     * @brief Test that history snapshots keep their rows while the original grows
+     */
+    void testBookingHistorySnapshotSharesChunks() {
+        // More rows than one chunk, with the tail chunk partly filled
+        BookingHistory live;
+        for (int i = 0; i < 5000; ++i) {
+            live.append(i + 1, 1, i % 2 + 1, 0, {i % 20}, 1000, i);
+        }
+        const BookingHistory snapshot = live;
+
+        live.append(5001, 2, 1, 1, {7, 8}, 2000, 5000);
+        live.cancel(0);
+        live.cancel(4999);
+        QCOMPARE(live.size(), 5001);
+        QVERIFY(live.isCancelled(4999));
+
+        QCOMPARE(snapshot.size(), 5000);
+        QVERIFY(!snapshot.isCancelled(0));
+        QVERIFY(!snapshot.isCancelled(4999));
+        QCOMPARE(snapshot.totalsBy(BookingHistory::Dimension::Movie)[1].bookings, 2500);
+        QCOMPARE(snapshot.totalsBy(BookingHistory::Dimension::Theater).size(), 1);
+
+        // A snapshot that appends gets its own tail; the original keeps its rows
+        BookingHistory branch = snapshot;
+        branch.append(6000, 3, 1, 2, {3}, 500, 5000);
+        QCOMPARE(branch.seatIndices(5000), QVector<int>({3}));
+        QCOMPARE(live.seatIndices(5000), QVector<int>({7, 8}));
+        QCOMPARE(snapshot.size(), 5000);
+        QCOMPARE(live.totalsBy(BookingHistory::Dimension::Theater)[2].revenue, qint64(2000));
+    }
+
+    /**
+     * @brief Test that the service records every booking in its history
+     */
+    void testServiceBookingHistorySnapshot() {
+        auto service = std::make_unique<BookingService>();
+        QVERIFY(service->reserveSeats(1, 1, {"A1", "A2"}, "Alice"));
+        QVERIFY(service->reserveSeats(2, 1, {"A3"}, "Bob"));
+
+        BookingHistory history = service->getBookingHistory();
+        QVERIFY(service->reserveSeats(3, 1, {"A4"}, "Carol"));
+
+        // The snapshot is unaffected by later bookings
+        QCOMPARE(history.size(), 2);
+        QCOMPARE(history.totalsBy(BookingHistory::Dimension::Movie)[1].seats, qint64(3));
+        QCOMPARE(service->getBookingHistory().size(), 3);
+    }
+
+    /**
+     * @brief Test that customers map to stable dense handles
+     */
+    void testCustomerRegistryInterning() {
+        CustomerRegistry registry;
+        QCOMPARE(registry.intern("Alice"), 0u);
+        QCOMPARE(registry.intern("Bob"), 1u);
+        QCOMPARE(registry.intern("Alice"), 0u);
+        QCOMPARE(registry.find("Bob"), 1u);
+        QCOMPARE(registry.find("Carol"), CustomerRegistry::INVALID_HANDLE);
+        QCOMPARE(registry.name(1), QString("Bob"));
+        QVERIFY(registry.name(7).isEmpty());
+        QCOMPARE(registry.size(), 2);
+
+        // Bookings carry the handle of their customer
+        auto service = std::make_unique<BookingService>();
+        QVERIFY(service->reserveSeats(1, 1, {"A1"}, "Alice"));
+        QVERIFY(service->reserveSeats(1, 2, {"A1"}, "Bob"));
+        QVERIFY(service->reserveSeats(1, 3, {"A1"}, "Alice"));
+        auto bookings = service->getBookingData("Alice");
+        QCOMPARE(bookings.size(), 2);
+        QCOMPARE(bookings[0].customerHandle, bookings[1].customerHandle);
+        QVERIFY(service->getBookingData("Nobody").isEmpty());
+    }
+
+    /**
+     * @brief Test that the waiting room reports callers ahead and rejects once sold out
+     */
+    void testAdmissionQueueReportsPosition() {
+        AdmissionQueue queue(1, 1);
+
+        AdmissionQueue::Position position;
+        QCOMPARE(queue.enter(position), AdmissionQueue::Status::Admitted);
+        QCOMPARE(position.ahead, 0);
+
+        // One caller admitted, nobody waiting yet
+        QCOMPARE(queue.position().ahead, 1);
+        queue.leave(8000);
+        QCOMPARE(queue.position().ahead, 0);
+
+        queue.setSoldOut(true);
+        QCOMPARE(queue.enter(position), AdmissionQueue::Status::SoldOut);
+    }
+
+    /**
+     * @brief Test that a retried reservation returns the original booking
+     */
+    void testIdempotentReservationReplays() {
+        auto service = std::make_unique<BookingService>();
+
+        int firstId = 0;
+        QVERIFY(service->reserveSeats(1, 1, {"A3"}, "Alice", "req-1", &firstId));
+        QVERIFY(firstId > 0);
+
+        // Gateway retry: same key, same request
+        QSignalSpy reservedSpy(service.get(), &BookingService::seatsReserved);
+        int retryId = 0;
+        QVERIFY(service->reserveSeats(1, 1, {"A3"}, "Alice", "req-1", &retryId));
+        QCOMPARE(retryId, firstId);
+        QCOMPARE(reservedSpy.count(), 0);
+        QCOMPARE(service->getBookingData("Alice").size(), 1);
+
+        // Same key for a different request is refused
+        QVERIFY(!service->reserveSeats(1, 1, {"A4"}, "Alice", "req-1"));
+
+        // Failures are not remembered: the retry runs (and fails) again
+        QSignalSpy failedSpy(service.get(), &BookingService::reservationFailed);
+        QVERIFY(!service->reserveSeats(1, 1, {"A3"}, "Bob", "req-2"));
+        QVERIFY(!service->reserveSeats(1, 1, {"A3"}, "Bob", "req-2"));
+        QCOMPARE(failedSpy.count(), 2);
+        QCOMPARE(failedSpy.last().at(0).toString(), QString("Seat A3 is not available"));
+
+        // A retry after the booking was cancelled says so instead of replaying Ok
+        QVERIFY(service->cancelBooking(firstId));
+        retryId = 0;
+        const ReservationResult cancelled =
+            service->reserveSeats(1, 1, {"A3"}, "Alice", "req-1", &retryId);
+        QCOMPARE(cancelled.code, ReservationResult::Code::BookingCancelled);
+        QCOMPARE(retryId, firstId);
+        QCOMPARE(failedSpy.count(), 3);
+        QVERIFY(service->getBookingData("Alice").isEmpty());
+        QCOMPARE(service->getAvailableSeats(1, 1).size(), Theater::TOTAL_SEATS);
+    }
+
+    /**
+     * @brief Test that idempotency keys expire and the table stays bounded
+     */
+    void testIdempotencyTableExpiresAndEvicts() {
+        IdempotencyTable expiring(64, 0);
+        int bookingId = 0;
+        QCOMPARE(expiring.begin("k", "f", bookingId), IdempotencyTable::Status::Started);
+        expiring.finish("k", 5);
+        QCOMPARE(expiring.begin("k", "f", bookingId), IdempotencyTable::Status::Started);
+
+        const int CAPACITY = IdempotencyTable::SHARD_COUNT * 4;
+        IdempotencyTable bounded(CAPACITY);
+        for (int i = 0; i < 10 * CAPACITY; ++i) {
+            const QString key = QString("key-%1").arg(i);
+            QCOMPARE(bounded.begin(key, "f", bookingId), IdempotencyTable::Status::Started);
+            bounded.finish(key, i);
+        }
+        QVERIFY(bounded.size() <= CAPACITY);
+
+        // The newest key is still remembered
+        const QString newest = QString("key-%1").arg(10 * CAPACITY - 1);
+        QCOMPARE(bounded.begin(newest, "f", bookingId), IdempotencyTable::Status::Replayed);
+        QCOMPARE(bookingId, 10 * CAPACITY - 1);
+    }
+
+    /**
+     * @brief Test that a key begun again after abandon() is evicted by its new age
+     */
+    void testIdempotencyTableSkipsStaleSlots() {
+        // Three keys sharing a shard of two entries
+        QStringList keys;
+        for (int i = 0; keys.size() < 3; ++i) {
+            const QString key = QString("key-%1").arg(i);
+            if (keys.isEmpty() || qHash(key) % IdempotencyTable::SHARD_COUNT
+                                      == qHash(keys.first()) % IdempotencyTable::SHARD_COUNT) {
+                keys.append(key);
+            }
+        }
+
+        IdempotencyTable table(IdempotencyTable::SHARD_COUNT * 2);
+        int bookingId = 0;
+        QCOMPARE(table.begin(keys[0], "f", bookingId), IdempotencyTable::Status::Started);
+        table.abandon(keys[0]);
+        QCOMPARE(table.begin(keys[1], "f", bookingId), IdempotencyTable::Status::Started);
+        table.finish(keys[1], 1);
+        QCOMPARE(table.begin(keys[0], "f", bookingId), IdempotencyTable::Status::Started);
+        table.finish(keys[0], 2);
+
+        // keys[1] is now the oldest entry; the abandoned slot must not count
+        QCOMPARE(table.begin(keys[2], "f", bookingId), IdempotencyTable::Status::Started);
+        table.finish(keys[2], 3);
+        QCOMPARE(table.begin(keys[0], "f", bookingId), IdempotencyTable::Status::Replayed);
+        QCOMPARE(bookingId, 2);
+        QCOMPARE(table.begin(keys[1], "f", bookingId), IdempotencyTable::Status::Started);
+    }
+
+    /**
+     * @brief Test that CSV and JSON catalogs parse to the same data
+     */
+    void testCatalogLoaderParsesCsvAndJson() {
+        const QByteArray csv =
+            "# movies, halls, showings\n"
+            "movie,10,\"Alien, Director's Cut\",117,Horror\n"
+            "theater,5,Hall 5,120\n"
+            "showing,5,10\n";
+        const QByteArray json = R"({
+            "movies": [{"id": 10, "title": "Alien, Director's Cut", "duration": 117, "genre": "Horror"}],
+            "theaters": [{"id": 5, "name": "Hall 5", "capacity": 120}],
+            "showings": [{"theaterId": 5, "movieId": 10}]
+        })";
+
+        CatalogData fromCsv;
+        CatalogData fromJson;
+        QString error;
+        QVERIFY2(CatalogLoader::parseCsv(csv, fromCsv, &error), qPrintable(error));
+        QVERIFY2(CatalogLoader::parseJson(json, fromJson, &error), qPrintable(error));
+
+        for (const CatalogData* catalog : {&fromCsv, &fromJson}) {
+            QCOMPARE(catalog->movies.size(), 1);
+            QCOMPARE(catalog->movies[0].title, QString("Alien, Director's Cut"));
+            QCOMPARE(catalog->theaters[0].capacity, 120);
+            QCOMPARE(catalog->showings[0].movieId, 10);
+            QVERIFY(catalog->validate());
+        }
+
+        // Malformed lines and dangling references are rejected
+        CatalogData broken;
+        QVERIFY(!CatalogLoader::parseCsv("theater,5,Hall 5,lots\n", broken, &error));
+        QVERIFY(CatalogLoader::parseCsv("movie,1,A,90,Drama\nshowing,9,1\n", broken));
+        QVERIFY(!broken.validate(&error));
+        QCOMPARE(error, QString("Showing refers to unknown theater 9"));
+    }
+
+    /**
+     * @brief Test that a loaded catalog replaces the running one
+     */
+    void testLoadCatalogPublishesShowings() {
+        auto service = std::make_unique<BookingService>();
+        QVERIFY(service->reserveSeats(1, 1, {"A1"}, "Alice"));
+
+        // Enough showings to take the parallel build path
+        CatalogData catalog;
+        for (int id = 1; id <= 10; ++id) {
+            catalog.movies.append({id, QString("Movie %1").arg(id), 90, "Drama"});
+            catalog.theaters.append({100 + id, QString("Hall %1").arg(id), id * 40});
+        }
+        for (int theater = 101; theater <= 110; ++theater) {
+            for (int movie = 1; movie <= 10; ++movie) {
+                if (movie != 10 || theater == 110) {
+                    catalog.showings.append({theater, movie});
+                }
+            }
+        }
+
+        QString error;
+        QVERIFY2(service->loadCatalog(catalog, &error), qPrintable(error));
+
+        QCOMPARE(service->getMovies().size(), 10);
+        QCOMPARE(service->getTheaters(1).size(), 10);
+        QCOMPARE(service->getTheaters(10).size(), 1);
+        QCOMPARE(service->getAvailableSeats(104, 3).size(), 160);
+        QVERIFY(service->getAvailableSeats(1, 1).isEmpty());
+
+        QVERIFY(service->reserveSeats(110, 10, {"A400"}, "Alice"));
+        QVERIFY(!service->reserveSeats(1, 1, {"A2"}, "Alice"));
+
+        // Bookings made against the old catalog are kept
+        QCOMPARE(service->getBookingData("Alice").size(), 2);
+
+        // Invalid catalogs leave the running one untouched
+        catalog.showings.append({999, 1});
+        QVERIFY(!service->loadCatalog(catalog, &error));
+        QCOMPARE(service->getTheaters(1).size(), 10);
+    }
+
+    /**
+     * @brief Test that a reload keeps the seat state of surviving showings
+     */
+    void testCatalogReloadCarriesSeatState() {
+        auto service = std::make_unique<BookingService>();
+        QVERIFY(service->reserveSeats(1, 1, {"A1"}, "Alice"));
+        QVERIFY(service->reserveSeats(2, 1, {"A3"}, "Alice"));
+        QVERIFY(service->reserveSeats(3, 4, {"A2"}, "Alice"));
+
+        Movie* matrix = service->getMovies().first();
+        const quint64 hallTwoVersion = service->getSeatMapVersion(2, 1);
+        const BookingService::CatalogStatus before = service->getCatalogStatus();
+
+        // Hall 2 grows, movie 4 leaves hall 3, movie 5 opens in hall 1
+        CatalogData catalog;
+        catalog.movies = {{1, "The Matrix Resurrections", 148, "Sci-Fi"},
+                          {5, "Premiere", 120, "Drama"}};
+        catalog.theaters = {{1, "IMAX Hall", 20}, {2, "VIP Hall", 120}, {3, "Standard Hall A", 20}};
+        catalog.showings = {{1, 1}, {1, 5}, {2, 1}, {3, 1}};
+
+        QString error;
+        QVERIFY2(service->loadCatalog(catalog, &error), qPrintable(error));
+
+        const BookingService::CatalogStatus after = service->getCatalogStatus();
+        QCOMPARE(after.version, before.version + 1);
+        QCOMPARE(after.liveVersions, 1);
+        QCOMPARE(after.showingCount, 4);
+
+        // Unchanged movies keep their objects
+        QCOMPARE(service->getMovies().first(), matrix);
+
+        // Same-size hall: seat state kept as is
+        QCOMPARE(service->getAvailableSeats(1, 1).size(), 19);
+        QVERIFY(!service->reserveSeats(1, 1, {"A1"}, "Bob"));
+
+        // Resized hall: booked seats carried over, clients get a full snapshot
+        QCOMPARE(service->getAvailableSeats(2, 1).size(), 119);
+        QVERIFY(!service->reserveSeats(2, 1, {"A3"}, "Bob"));
+        QVERIFY(service->reserveSeats(2, 1, {"A100"}, "Bob"));
+        QVERIFY(service->getSeatChangesSince(2, 1, hallTwoVersion).isFullSnapshot);
+
+        // New and dropped showings
+        QCOMPARE(service->getAvailableSeats(1, 5).size(), 20);
+        QVERIFY(!service->reserveSeats(3, 4, {"A3"}, "Bob"));
+        QCOMPARE(service->getBookingData("Alice").size(), 3);
+
+        // Shrinking a hall below a booked seat is refused
+        catalog.theaters[1].capacity = 50;
+        QVERIFY(!service->loadCatalog(catalog, &error));
+        QCOMPARE(error, QString("Theater 2 is too small for the seats booked for movie 1"));
+        QCOMPARE(service->getCatalogStatus().version, after.version);
+        QCOMPARE(service->getAvailableSeats(2, 1).size(), 118);
+    }
+
+    /**
+     * @brief Test that returned pointers outlive a reload that drops their objects
+     */
+    void testPinnedResultsSurviveReload() {
+        auto service = std::make_unique<BookingService>();
+        auto seats = service->getAvailableSeats(3, 4);
+        auto halls = service->getTheaters(4);
+        auto barbie = service->getMovie(4);
+        QVERIFY(barbie);
+        QPointer<Movie> guard(barbie.get());
+
+        // Movie 4, hall 3 and all their showings leave
+        CatalogData catalog;
+        catalog.movies = {{1, "The Matrix Resurrections", 148, "Sci-Fi"}};
+        catalog.theaters = {{1, "IMAX Hall", 20}, {2, "VIP Hall", 20}};
+        catalog.showings = {{1, 1}, {2, 1}};
+        QString error;
+        QVERIFY2(service->loadCatalog(catalog, &error), qPrintable(error));
+        QVERIFY(!service->getMovie(4));
+        QCOMPARE(service->getCatalogStatus().liveVersions, 2);
+
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+        QCOMPARE(seats.size(), 20);
+        QCOMPARE(seats.first()->getId(), QString("A1"));
+        QCOMPARE(halls.last()->getName(), QString("Standard Hall A"));
+        QCOMPARE(barbie->getTitle(), QString("Barbie"));
+
+        // Letting go frees the old version and its dropped objects
+        seats = {};
+        halls = {};
+        barbie = {};
+        QCOMPARE(service->getCatalogStatus().liveVersions, 1);
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+        QVERIFY(guard.isNull());
+    }
+
+    /**
+     * @brief Test that seats of a showing released on another thread are deleted on theirs
+     */
+    void testShowingReleasedOffThreadDefersSeatDeletion() {
+        auto service = std::make_unique<BookingService>();
+        auto seats = service->getAvailableSeats(3, 4);
+        QPointer<Seat> guard(seats.first());
+
+        CatalogData catalog;
+        catalog.movies = {{1, "The Matrix Resurrections", 148, "Sci-Fi"}};
+        catalog.theaters = {{1, "IMAX Hall", 20}};
+        catalog.showings = {{1, 1}};
+        QString error;
+        QVERIFY2(service->loadCatalog(catalog, &error), qPrintable(error));
+
+        // The worker drops the last reference to the retired showing
+        QThread* worker = QThread::create([&seats] { seats = {}; });
+        worker->start();
+        QVERIFY(worker->wait(5000));
+        delete worker;
+        QVERIFY(!guard.isNull());
+
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+        QVERIFY(guard.isNull());
+    }
+
+    /**
+     * @brief Test that seats owned by a finished thread are deleted at once
+     */
+    void testShowingReleasedAfterOwnerThreadExitsDeletesSeats() {
+        // The seats are created on a worker that is gone by the reload
+        std::unique_ptr<BookingService> service;
+        BookingService::PinnedList<Seat> seats;
+        QThread* mainThread = QThread::currentThread();
+        QThread* worker = QThread::create([&] {
+            service = std::make_unique<BookingService>();
+            seats = service->getAvailableSeats(3, 4);
+            service->moveToThread(mainThread);
+        });
+        worker->start();
+        QVERIFY(worker->wait(5000));
+        QPointer<Seat> guard(seats.first());
+        QVERIFY(guard->thread() == worker);
+
+        CatalogData catalog;
+        catalog.movies = {{1, "The Matrix Resurrections", 148, "Sci-Fi"}};
+        catalog.theaters = {{1, "IMAX Hall", 20}};
+        catalog.showings = {{1, 1}};
+        QString error;
+        QVERIFY2(service->loadCatalog(catalog, &error), qPrintable(error));
+
+        // No event loop will ever run on the worker again
+        seats = {};
+        QVERIFY(guard.isNull());
+        delete worker;
+    }
+
+    /**
+     * @brief Test that moving a hall to a NUMA node keeps its seat state
+     */
+    void testNumaPlacedHallKeepsSeatState() {
+        CatalogData catalog;
+        QString error;
+        QVERIFY2(CatalogLoader::parseCsv("movie,1,Epic,200,Drama\n"
+                                         "theater,1,Arena,1500\n"
+                                         "theater,2,Arena Annex,1500,0\n"
+                                         "showing,1,1\n"
+                                         "showing,2,1\n", catalog, &error),
+                 qPrintable(error));
+        QCOMPARE(catalog.theaters[0].numaNode, -1);
+        QCOMPARE(catalog.theaters[1].numaNode, 0);
+        CatalogData broken;
+        QVERIFY(!CatalogLoader::parseCsv("theater,3,Hall,20,near\n", broken));
+
+        auto service = std::make_unique<BookingService>();
+        QVERIFY2(service->loadCatalog(catalog, &error), qPrintable(error));
+
+        // Seats in different cache lines of taken bits
+        QVERIFY(service->reserveSeats(1, 1, {"A1", "A513", "A1500"}, "Alice"));
+        QVERIFY(service->reserveSeats(2, 1, {"A600"}, "Alice"));
+        QVERIFY(!service->reserveSeats(1, 1, {"A513"}, "Bob"));
+
+        // Placing hall 1 on a node rebuilds its showing with the same seats
+        const quint64 version = service->getSeatMapVersion(1, 1);
+        catalog.theaters[0].numaNode = 0;
+        QVERIFY2(service->loadCatalog(catalog, &error), qPrintable(error));
+        QVERIFY(service->getSeatMapVersion(1, 1) > version);
+
+        const ReservationResult result = service->reserveSeats(1, 1, {"A1500", "A1499"}, "Bob");
+        QCOMPARE(result.code, ReservationResult::Code::SeatTaken);
+        QCOMPARE(result.seatCount, 1);
+        QCOMPARE(int(result.seats[0]), 1499);
+        QCOMPARE(service->getAvailableSeats(1, 1).size(), 1497);
+        QCOMPARE(service->getAvailableSeats(2, 1).size(), 1499);
+    }
+
+    /**
+     * @brief Test that showings sharing a load's block stay apart and outlive their siblings
+     */
+    void testShowingsOfOneLoadShareABlock() {
+        CatalogData catalog;
+        catalog.movies = {{1, "Epic", 200, "Drama"}};
+        const QVector<int> capacities = {20, 37, 400, 1500, 121};
+        for (int i = 0; i < capacities.size(); ++i) {
+            catalog.theaters.append({i + 1, QString("Hall %1").arg(i + 1), capacities[i]});
+            catalog.showings.append({i + 1, 1});
+        }
+        auto service = std::make_unique<BookingService>();
+        QString error;
+        QVERIFY2(service->loadCatalog(catalog, &error), qPrintable(error));
+
+        // Neighbours in the block do not see each other's seats
+        for (int i = 0; i < capacities.size(); ++i) {
+            const QString last = QString("A%1").arg(capacities[i]);
+            QVERIFY(service->reserveSeats(i + 1, 1, {"A1", last}, "Alice"));
+        }
+        for (int i = 0; i < capacities.size(); ++i) {
+            QCOMPARE(service->getAvailableSeats(i + 1, 1).size(), capacities[i] - 2);
+        }
+
+        // Survivors keep the block alive after the others are dropped
+        catalog.theaters.remove(0, 3);
+        catalog.showings.remove(0, 3);
+        QVERIFY2(service->loadCatalog(catalog, &error), qPrintable(error));
+        QCOMPARE(service->getCatalogStatus().liveVersions, 1);
+        QVERIFY(!service->reserveSeats(4, 1, {"A1500"}, "Bob"));
+        QVERIFY(service->reserveSeats(5, 1, {"A120"}, "Bob"));
+        QCOMPARE(service->getAvailableSeats(5, 1).size(), 118);
+        QVERIFY(service->verifyInvariants(&error));
+    }
+
+    /**
+     * @brief Test that cancelling a booking frees its seats and keeps its record
+     */
+    void testCancelBookingReleasesSeats() {
+        auto service = std::make_unique<BookingService>();
+        QVERIFY(service->reserveSeats(1, 1, {"A1", "A2"}, "Alice"));
+        QVERIFY(service->reserveSeats(1, 1, {"A3"}, "Bob"));
+        const int bookingId = service->getBookingData("Alice")[0].id;
+        const quint64 version = service->getSeatMapVersion(1, 1);
+
+        QSignalSpy releasedSpy(service.get(), &BookingService::seatsReleased);
+        QVERIFY(service->cancelBooking(bookingId));
+        QCOMPARE(releasedSpy.count(), 1);
+        QCOMPARE(releasedSpy[0][2].toStringList(), QStringList({"A1", "A2"}));
+        QVERIFY(service->getSeatMapVersion(1, 1) > version);
+        QCOMPARE(service->getAvailableSeats(1, 1).size(), Theater::TOTAL_SEATS - 1);
+        QVERIFY(service->getBookingData("Alice").isEmpty());
+        QVERIFY(service->getBookings("Alice").isEmpty());
+
+        // The history keeps the row but leaves it out of the totals
+        const BookingHistory history = service->getBookingHistory();
+        QCOMPARE(history.size(), 2);
+        QVERIFY(history.isCancelled(0));
+        QCOMPARE(history.totalsBy(BookingHistory::Dimension::Movie)[1].seats, qint64(1));
+
+        QString error;
+        QVERIFY(!service->cancelBooking(bookingId, &error));
+        QVERIFY(error.contains("already cancelled"));
+        QVERIFY(!service->cancelBooking(999));
+        QVERIFY(service->reserveSeats(1, 1, {"A1"}, "Carol"));
+
+        // A sold-out showing takes reservations again
+        QStringList allSeats;
+        for (int i = 1; i <= Theater::TOTAL_SEATS; ++i) {
+            allSeats.append(QString("A%1").arg(i));
+        }
+        QVERIFY(service->reserveSeats(2, 1, allSeats, "Dan"));
+        QCOMPARE(service->reserveSeats(2, 1, {"A5"}, "Erin").code,
+                 ReservationResult::Code::SoldOut);
+        QVERIFY(service->cancelBooking(service->getBookingData("Dan")[0].id));
+        QVERIFY(service->reserveSeats(2, 1, {"A5"}, "Erin"));
+
+        QVERIFY2(service->verifyInvariants(&error), qPrintable(error));
+    }
+
+    /**
+     * @brief Test that cancelling a booking of a showing that was dropped and added back frees nothing
+     */
+    void testCancelAfterShowingReturns() {
+        auto service = std::make_unique<BookingService>();
+        QVERIFY(service->reserveSeats(1, 1, {"A1", "A2"}, "Alice"));
+        const int bookingId = service->getBookingData("Alice")[0].id;
+
+        CatalogData catalog;
+        catalog.movies = {{1, "The Matrix Resurrections", 148, "Sci-Fi"}};
+        catalog.theaters = {{1, "IMAX Hall", 20}, {2, "VIP Hall", 20}};
+        catalog.showings = {{2, 1}};
+        QString error;
+        QVERIFY2(service->loadCatalog(catalog, &error), qPrintable(error));
+
+        // The showing comes back empty and Bob buys Alice's old seats
+        catalog.showings = {{1, 1}, {2, 1}};
+        QVERIFY2(service->loadCatalog(catalog, &error), qPrintable(error));
+        QVERIFY(service->reserveSeats(1, 1, {"A1", "A2"}, "Bob"));
+        QVERIFY2(service->verifyInvariants(&error), qPrintable(error));
+
+        const quint64 version = service->getSeatMapVersion(1, 1);
+        QVERIFY(service->cancelBooking(bookingId));
+        QCOMPARE(service->getSeatMapVersion(1, 1), version);
+        QCOMPARE(service->getAvailableSeats(1, 1).size(), Theater::TOTAL_SEATS - 2);
+        QVERIFY(!service->reserveSeats(1, 1, {"A1"}, "Carol"));
+        QVERIFY2(service->verifyInvariants(&error), qPrintable(error));
+    }
+
+    /**
+     * @brief Test that released seats go to waiting parties in order, best fit first
+     */
+    void testWaitlistPromotesOnRelease() {
+        auto service = std::make_unique<BookingService>();
+        QStringList rest;
+        for (int i = 8; i <= Theater::TOTAL_SEATS; ++i) {
+            rest.append(QString("A%1").arg(i));
+        }
+        QVERIFY(service->reserveSeats(1, 2, {"A1", "A2", "A3", "A4", "A5"}, "Owner"));
+        QVERIFY(service->reserveSeats(1, 2, {"A6", "A7"}, "Owner"));
+        QVERIFY(service->reserveSeats(1, 2, rest, "Owner"));
+        const QVector<BookingService::BookingData> owned = service->getBookingData("Owner");
+
+        QSignalSpy promotedSpy(service.get(), &BookingService::waitlistPromoted);
+        const int ann = service->joinWaitlist(1, 2, 4, "Ann");
+        const int ben = service->joinWaitlist(1, 2, 2, "Ben");
+        const int cid = service->joinWaitlist(1, 2, 1, "Cid");
+        QVERIFY(ann > 0 && ben > ann && cid > ben);
+        QCOMPARE(promotedSpy.count(), 0);
+        QCOMPARE(service->getWaitlist(1, 2).size(), 3);
+
+        QString error;
+        QVERIFY(service->joinWaitlist(1, 2, 0, "Ann", &error) == 0);
+        QVERIFY(service->joinWaitlist(1, 2, Theater::TOTAL_SEATS + 1, "Ann") == 0);
+        QVERIFY(service->joinWaitlist(9, 2, 1, "Ann") == 0);
+
+        // Two seats: too few for Ann, who lets Ben (next in line) have them
+        QVERIFY(service->cancelBooking(owned[1].id));
+        QCOMPARE(promotedSpy.count(), 1);
+        QCOMPARE(promotedSpy[0][0].toInt(), ben);
+        QCOMPARE(promotedSpy[0][2].toString(), QString("Ben"));
+        QCOMPARE(service->getBookingData("Ben")[0].id, promotedSpy[0][1].toInt());
+        QCOMPARE(service->getBookingData("Ben")[0].seatIds, QStringList({"A6", "A7"}));
+
+        // Five seats: Ann first, then Cid
+        QVERIFY(service->cancelBooking(owned[0].id));
+        QCOMPARE(promotedSpy.count(), 3);
+        QCOMPARE(promotedSpy[1][0].toInt(), ann);
+        QCOMPARE(promotedSpy[2][0].toInt(), cid);
+        QCOMPARE(service->getBookingData("Ann")[0].seatIds, QStringList({"A1", "A2", "A3", "A4"}));
+        QCOMPARE(service->getBookingData("Cid")[0].seatIds, QStringList({"A5"}));
+        QVERIFY(service->getWaitlist(1, 2).isEmpty());
+        QVERIFY(service->getAvailableSeats(1, 2).isEmpty());
+
+        // A party that fits joins and is booked at once, in the tightest gap
+        QVERIFY(service->cancelBooking(service->getBookingData("Ann")[0].id));
+        QVERIFY(service->cancelBooking(service->getBookingData("Ben")[0].id));
+        const int dee = service->joinWaitlist(1, 2, 2, "Dee");
+        QCOMPARE(promotedSpy.count(), 4);
+        QCOMPARE(promotedSpy[3][0].toInt(), dee);
+        QCOMPARE(service->getBookingData("Dee")[0].seatIds, QStringList({"A6", "A7"}));
+
+        // Leaving gives the place up
+        const int eve = service->joinWaitlist(1, 2, 5, "Eve");
+        QVERIFY(eve > 0);
+        QVERIFY(service->leaveWaitlist(1, 2, eve));
+        QVERIFY(!service->leaveWaitlist(1, 2, eve));
+        QVERIFY(service->getWaitlist(1, 2).isEmpty());
+
+        QVERIFY2(service->verifyInvariants(&error), qPrintable(error));
+    }
+
 private:
     std::unique_ptr<BookingService> m_service;
 };
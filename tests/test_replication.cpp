@@ -0,0 +1,386 @@
+#include <QtTest/QtTest>
+#include <QTemporaryDir>
+#include "core/BookingService.h"
+#include "core/ReplicationStream.h"
+
+#ifdef Q_OS_UNIX
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Test suite for primary/replica booking replication
+ */
+class TestReplication : public QObject {
+    Q_OBJECT
+
+private:
+    QTemporaryDir m_dir;
+
+    QString socketPath(const char* name) const {
+        return m_dir.filePath(QString(name) + ".sock");
+    }
+
+private slots:
+    void initTestCase() {
+#ifndef Q_OS_UNIX
+        QSKIP("Replication requires Unix domain sockets");
+#endif
+        QVERIFY(m_dir.isValid());
+    }
+
+    /**
+     * @brief Test that records survive encoding unchanged
+     */
+    void testRecordRoundTrip() {
+        ReplicationRecord record;
+        record.sequence = 42;
+        record.committedAtMs = 1700000000123;
+        record.bookingId = 7;
+        record.theaterId = 2;
+        record.movieId = 3;
+        record.customerId = "alice";
+        record.seatIds = {"A1", "B4"};
+        record.seatPrices = {1200, 1800};
+        record.bookedAtMs = 1700000000000;
+
+        ReplicationRecord decoded;
+        QVERIFY(ReplicationRecord::decode(record.encode(), decoded));
+        QCOMPARE(decoded.sequence, record.sequence);
+        QCOMPARE(decoded.committedAtMs, record.committedAtMs);
+        QCOMPARE(decoded.bookingId, record.bookingId);
+        QCOMPARE(decoded.customerId, record.customerId);
+        QCOMPARE(decoded.seatIds, record.seatIds);
+        QCOMPARE(decoded.seatPrices, record.seatPrices);
+        QCOMPARE(decoded.bookedAtMs, record.bookedAtMs);
+        QVERIFY(decoded.kind == ReplicationRecord::Kind::Booking);
+
+        record.kind = ReplicationRecord::Kind::Cancellation;
+        record.seatPrices.clear();
+        QVERIFY(ReplicationRecord::decode(record.encode(), decoded));
+        QVERIFY(decoded.kind == ReplicationRecord::Kind::Cancellation);
+
+        QVERIFY(!ReplicationRecord::decode(record.encode().left(10), decoded));
+    }
+
+    /**
+     * @brief Test that a replica mirrors earlier and later primary bookings
+     */
+    void testReplicaFollowsPrimary() {
+        BookingService primary;
+        BookingService replica;
+        const QString path = socketPath("follow");
+
+        // Booked before replication starts: shipped as backlog
+        QVERIFY(primary.reserveSeats(1, 1, {"A1", "A2"}, "alice"));
+
+        QString error;
+        QVERIFY2(primary.startReplication(path, &error), qPrintable(error));
+        QVERIFY2(replica.replicateFrom(path, &error), qPrintable(error));
+
+        QVERIFY(primary.reserveSeats(1, 1, {"A3"}, "bob"));
+
+        QTRY_COMPARE(replica.getReplicationStatus().appliedSequence, quint64(2));
+        QCOMPARE(replica.getAvailableSeats(1, 1).size(), primary.getAvailableSeats(1, 1).size());
+        QCOMPARE(replica.getBookingData("bob").size(), 1);
+        QCOMPARE(replica.getBookingData("bob")[0].id, primary.getBookingData("bob")[0].id);
+        QCOMPARE(replica.getBookingData("alice")[0].totalPrice,
+                 primary.getBookingData("alice")[0].totalPrice);
+
+        const BookingService::ReplicationStatus status = replica.getReplicationStatus();
+        QVERIFY(status.role == BookingService::ReplicationRole::Replica);
+        QVERIFY(status.connected);
+        QVERIFY(status.lagMs >= 0);
+        QTRY_COMPARE(primary.getReplicationStatus().replicaCount, 1);
+
+        // Replicas are read-only
+        QVERIFY(!replica.reserveSeats(1, 1, {"B1"}, "carol"));
+    }
+
+    /**
+     * @brief Test that cancellations replicate in log order
+     */
+    void testReplicaAppliesCancellations() {
+        BookingService primary;
+        BookingService replica;
+        const QString path = socketPath("cancel");
+
+        // A cancellation before replication starts is part of the backlog
+        QVERIFY(primary.reserveSeats(2, 1, {"A1"}, "carol"));
+        QVERIFY(primary.reserveSeats(2, 1, {"A2"}, "dave"));
+        QVERIFY(primary.cancelBooking(primary.getBookingData("carol")[0].id));
+
+        QVERIFY(primary.startReplication(path));
+        QVERIFY(replica.replicateFrom(path));
+        QVERIFY(primary.cancelBooking(primary.getBookingData("dave")[0].id));
+        QVERIFY(primary.reserveSeats(2, 1, {"A1"}, "erin"));
+
+        QTRY_COMPARE(replica.getReplicationStatus().appliedSequence, quint64(5));
+        QCOMPARE(primary.getReplicationStatus().appliedSequence, quint64(5));
+        QVERIFY(replica.getBookingData("carol").isEmpty());
+        QVERIFY(replica.getBookingData("dave").isEmpty());
+        QCOMPARE(replica.getBookingData("erin").size(), 1);
+        QCOMPARE(replica.getAvailableSeats(2, 1).size(), primary.getAvailableSeats(2, 1).size());
+        QVERIFY(!replica.cancelBooking(replica.getBookingData("erin")[0].id));
+
+        QString error;
+        QVERIFY2(replica.verifyInvariants(&error), qPrintable(error));
+    }
+
+    /**
+     * @brief Test that a replica stops at a booking it cannot apply instead of drifting
+     */
+    void testReplicaStopsAtUnapplicableBooking() {
+        BookingService primary;
+        BookingService replica;
+        const QString path = socketPath("diverged");
+
+        // The replica's catalog lacks a showing the primary sells
+        CatalogData catalog;
+        catalog.movies = {{1, "The Matrix Resurrections", 148, "Sci-Fi"}};
+        catalog.theaters = {{1, "IMAX Hall", 20}};
+        catalog.showings = {{1, 1}};
+        QString error;
+        QVERIFY2(replica.loadCatalog(catalog, &error), qPrintable(error));
+
+        QVERIFY(primary.startReplication(path));
+        QVERIFY(replica.replicateFrom(path));
+        QVERIFY(primary.reserveSeats(1, 1, {"A1"}, "alice"));
+        QVERIFY(primary.reserveSeats(2, 1, {"A1"}, "bob"));
+        QVERIFY(primary.reserveSeats(1, 1, {"A2"}, "carol"));
+
+        QTRY_VERIFY(!replica.getReplicationStatus().connected);
+        QCOMPARE(replica.getReplicationStatus().appliedSequence, quint64(1));
+        QCOMPARE(replica.getBookingData("alice").size(), 1);
+        QVERIFY(replica.getBookingData("carol").isEmpty());
+    }
+
+    /**
+     * @brief Test that a promoted replica takes over the booking sequence
+     */
+    void testPromoteToPrimary() {
+        auto primary = std::make_unique<BookingService>();
+        BookingService replica;
+        const QString path = socketPath("promote");
+
+        QVERIFY(primary->startReplication(path));
+        QVERIFY(replica.replicateFrom(path));
+        QVERIFY(primary->reserveSeats(3, 2, {"A5"}, "frank"));
+        QTRY_COMPARE(replica.getReplicationStatus().appliedSequence, quint64(1));
+
+        // Primary fails
+        primary.reset();
+        QTRY_VERIFY(!replica.getReplicationStatus().connected);
+
+        QVERIFY(replica.promoteToPrimary());
+        QVERIFY(!replica.promoteToPrimary());
+        QVERIFY(replica.getReplicationStatus().role == BookingService::ReplicationRole::Primary);
+
+        QVERIFY(!replica.reserveSeats(3, 2, {"A5"}, "grace"));
+        QVERIFY(replica.reserveSeats(3, 2, {"A6"}, "grace"));
+        QCOMPARE(replica.getBookingData("grace")[0].id, replica.getBookingData("frank")[0].id + 1);
+    }
+
+    /**
+     * @brief Test that senders of disconnected replicas are joined
+     */
+    void testReconnectingReplicasReapSenders() {
+        const QString path = socketPath("reap");
+
+        ReplicationPublisher publisher;
+        QVERIFY(publisher.listen(path));
+
+        for (int attempt = 0; attempt < 20; ++attempt) {
+            ReplicationSubscriber subscriber;
+            QVERIFY(subscriber.connectTo(path, 1, [](const ReplicationRecord&) { return true; }));
+            QTRY_COMPARE(publisher.replicaCount(), 1);
+            subscriber.disconnect();
+            QTRY_COMPARE(publisher.replicaCount(), 0);
+        }
+
+        QTRY_COMPARE(publisher.senderCount(), 0);
+    }
+
+    /**
+     * @brief Test that the log keeps only the newest frames
+     */
+    void testBoundedLogDisconnectsStaleReplica() {
+        const QString path = socketPath("bounded");
+
+        ReplicationPublisher publisher(4);
+        QVERIFY(publisher.listen(path));
+        for (int i = 1; i <= 10; ++i) {
+            ReplicationRecord record;
+            record.bookingId = i;
+            QCOMPARE(publisher.publish(record), quint64(i));
+        }
+        QCOMPARE(publisher.headSequence(), quint64(10));
+        QCOMPARE(publisher.oldestSequence(), quint64(7));
+
+        // Sequence 1 was dropped: the replica is told nothing and cut off
+        QAtomicInt staleRecords;
+        ReplicationSubscriber stale;
+        QVERIFY(stale.connectTo(path, 1, [&](const ReplicationRecord&) {
+            staleRecords.fetchAndAddOrdered(1);
+            return true;
+        }));
+        QTRY_VERIFY(!stale.isConnected());
+        QCOMPARE(staleRecords.loadAcquire(), 0);
+
+        QMutex mutex;
+        QVector<int> received;
+        ReplicationSubscriber current;
+        QVERIFY(current.connectTo(path, 7, [&](const ReplicationRecord& record) {
+            QMutexLocker locker(&mutex);
+            received.append(record.bookingId);
+            return true;
+        }));
+        QTRY_COMPARE(current.primarySequence(), quint64(10));
+        QMutexLocker locker(&mutex);
+        QCOMPARE(received, QVector<int>({7, 8, 9, 10}));
+    }
+
+    /**
+     * @brief Test that a replica catches up across many send batches while the log grows
+     */
+    void testCatchUpSpansBatches() {
+        const QString path = socketPath("batches");
+
+        ReplicationPublisher publisher;
+        QVERIFY(publisher.listen(path));
+        for (int i = 1; i <= 2000; ++i) {
+            ReplicationRecord record;
+            record.bookingId = i;
+            publisher.publish(record);
+        }
+
+        QMutex mutex;
+        QVector<int> received;
+        QAtomicInt receivedCount;
+        ReplicationSubscriber subscriber;
+        QVERIFY(subscriber.connectTo(path, 1, [&](const ReplicationRecord& record) {
+            QMutexLocker locker(&mutex);
+            received.append(record.bookingId);
+            receivedCount.storeRelease(received.size());
+            return true;
+        }));
+
+        // Publishing keeps going while the backlog is sent
+        for (int i = 2001; i <= 2500; ++i) {
+            ReplicationRecord record;
+            record.bookingId = i;
+            publisher.publish(record);
+        }
+
+        QTRY_COMPARE(receivedCount.loadAcquire(), 2500);
+        QMutexLocker locker(&mutex);
+        for (int i = 0; i < received.size(); ++i) {
+            QCOMPARE(received[i], i + 1);
+        }
+        QVERIFY(subscriber.isConnected());
+    }
+
+#ifdef Q_OS_UNIX
+    /**
+     * @brief Test that a subscriber stops at a gap in the sequence
+     */
+    void testSubscriberDisconnectsOnGap() {
+        const QByteArray path = socketPath("gap").toUtf8();
+
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path.constData(), path.size());
+
+        const int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        QVERIFY(listenFd >= 0);
+        ::unlink(address.sun_path);
+        QCOMPARE(bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+        QCOMPARE(::listen(listenFd, 1), 0);
+
+        QMutex mutex;
+        QVector<quint64> received;
+        ReplicationSubscriber subscriber;
+        QVERIFY(subscriber.connectTo(QString::fromUtf8(path), 1,
+                                     [&](const ReplicationRecord& record) {
+                                         QMutexLocker locker(&mutex);
+                                         received.append(record.sequence);
+                                         return true;
+                                     }));
+
+        // Play a primary that skips sequence 2
+        const int fd = accept(listenFd, nullptr, nullptr);
+        QVERIFY(fd >= 0);
+        char handshake[8];
+        QCOMPARE(recv(fd, handshake, sizeof(handshake), MSG_WAITALL), ssize_t(sizeof(handshake)));
+
+        QByteArray stream;
+        for (const quint64 sequence : {1, 3, 4}) {
+            ReplicationRecord record;
+            record.sequence = sequence;
+            const QByteArray payload = record.encode();
+            QByteArray frame;
+            QDataStream out(&frame, QIODevice::WriteOnly);
+            out << quint32(payload.size() + 1) << quint8(1);   // Record frame
+            stream.append(frame).append(payload);
+        }
+        QCOMPARE(send(fd, stream.constData(), stream.size(), 0), ssize_t(stream.size()));
+
+        QTRY_VERIFY(!subscriber.isConnected());
+        {
+            QMutexLocker locker(&mutex);
+            QCOMPARE(received, QVector<quint64>({1}));
+        }
+
+        subscriber.disconnect();
+        ::close(fd);
+        ::close(listenFd);
+        ::unlink(address.sun_path);
+    }
+
+    /**
+     * @brief Test replication to a replica running in another process
+     */
+    void testReplicaInSeparateProcess() {
+        const QString path = socketPath("process");
+
+        BookingService primary;
+        QVERIFY(primary.startReplication(path));
+
+        const pid_t pid = fork();
+        QVERIFY(pid >= 0);
+        if (pid == 0) {
+            BookingService replica;
+            if (!replica.replicateFrom(path)) {
+                _exit(1);
+            }
+            // Wait for the three bookings the parent makes
+            for (int attempt = 0; attempt < 500; ++attempt) {
+                if (replica.getReplicationStatus().appliedSequence == 3) {
+                    const bool seatsMatch = replica.getAvailableSeats(2, 1).size()
+                                            == Theater::TOTAL_SEATS - 4;
+                    _exit(seatsMatch && replica.getBookingData("dave").size() == 2 ? 0 : 2);
+                }
+                QThread::msleep(10);
+            }
+            _exit(3);
+        }
+
+        QTRY_COMPARE(primary.getReplicationStatus().replicaCount, 1);
+        QVERIFY(primary.reserveSeats(2, 1, {"A1"}, "dave"));
+        QVERIFY(primary.reserveSeats(2, 1, {"A2", "A3"}, "erin"));
+        QVERIFY(primary.reserveSeats(2, 1, {"A4"}, "dave"));
+
+        int status = 0;
+        QCOMPARE(waitpid(pid, &status, 0), pid);
+        QVERIFY(WIFEXITED(status));
+        QCOMPARE(WEXITSTATUS(status), 0);
+    }
+#endif
+};
+
+QTEST_MAIN(TestReplication)
+#include "test_replication.moc"
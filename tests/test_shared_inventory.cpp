@@ -0,0 +1,234 @@
+#include <QtTest/QtTest>
+#include "core/SharedInventory.h"
+#include "core/BookingService.h"
+
+#ifdef Q_OS_LINUX
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Test suite for the cross-process SharedInventory
+ *
+ * Worker processes are simulated with fork(); every test uses its own
+ * segment name and removes it afterwards.
+ */
+class TestSharedInventory : public QObject {
+    Q_OBJECT
+
+private:
+    QString segmentName(const char* test) const {
+        return QString("ticket-booking-test-%1-%2").arg(QCoreApplication::applicationPid()).arg(test);
+    }
+
+private slots:
+    void initTestCase() {
+#ifndef Q_OS_LINUX
+        QSKIP("Shared inventory requires Linux");
+#endif
+    }
+
+#ifdef Q_OS_LINUX
+    /**
+     * @brief Test that a second open attaches to the same seats
+     */
+    void testAttachSharesSeats() {
+        const QString name = segmentName("attach");
+        SharedInventory::remove(name);
+
+        SharedInventory first;
+        SharedInventory second;
+        QString error;
+        QVERIFY2(first.open(name, 2, 20, &error), qPrintable(error));
+        QVERIFY2(second.open(name, 2, 20, &error), qPrintable(error));
+
+        QVERIFY(first.beginClaim(1, {0, 5}));
+        first.commitClaim(1);
+
+        QVERIFY(second.isTaken(1, 5));
+        QVERIFY(!second.isTaken(0, 5));
+        QCOMPARE(second.freeCount(1), 18);
+
+        int conflictingSeat = -1;
+        QVERIFY(!second.beginClaim(1, {3, 5}, &conflictingSeat));
+        QCOMPARE(conflictingSeat, 5);
+        QVERIFY(!second.isTaken(1, 3));
+
+        // Mismatched layouts are rejected
+        SharedInventory third;
+        QVERIFY(!third.open(name, 3, 20, &error));
+
+        SharedInventory::remove(name);
+    }
+
+    /**
+     * @brief Test that every slot counts free seats against its own capacity
+     */
+    void testSlotsHaveOwnCapacity() {
+        const QString name = segmentName("capacity");
+        SharedInventory::remove(name);
+
+        SharedInventory first;
+        SharedInventory second;
+        QString error;
+        QVERIFY2(first.open(name, {10, 120}, &error), qPrintable(error));
+        QVERIFY2(second.open(name, {10, 120}, &error), qPrintable(error));
+        QCOMPARE(second.capacity(0), 10);
+        QCOMPARE(second.capacity(1), 120);
+        QCOMPARE(second.freeCount(0), 10);
+        QCOMPARE(second.freeCount(1), 120);
+
+        QVERIFY(first.beginClaim(0, {0, 1, 2}));
+        first.commitClaim(0);
+        QVERIFY(first.release(0, {2}));
+        QCOMPARE(second.freeCount(0), 8);
+
+        // Same slot count and largest hall, different small hall
+        SharedInventory third;
+        QVERIFY(!third.open(name, {20, 120}, &error));
+        QVERIFY(error.contains("capacity"));
+
+        SharedInventory::remove(name);
+
+        // A service's small hall sells out in the shared count too
+        BookingService service;
+        CatalogData catalog;
+        catalog.movies = {{1, "Epic", 200, "Drama"}};
+        catalog.theaters = {{1, "Tiny Hall", 2}, {2, "Big Hall", 120}};
+        catalog.showings = {{1, 1}, {2, 1}};
+        QVERIFY2(service.loadCatalog(catalog, &error), qPrintable(error));
+        QVERIFY2(service.attachSharedInventory(name, &error), qPrintable(error));
+        QVERIFY(service.reserveSeats(1, 1, {"A1"}, "alice"));
+        QCOMPARE(service.reserveSeats(1, 1, {"A2", "A1"}, "bob").code,
+                 ReservationResult::Code::NotEnoughSeats);
+        QVERIFY(service.reserveSeats(1, 1, {"A2"}, "bob"));
+        QCOMPARE(service.reserveSeats(1, 1, {"A1"}, "carol").code,
+                 ReservationResult::Code::SoldOut);
+
+        SharedInventory::remove(name);
+    }
+
+    /**
+     * @brief Test that concurrent processes never claim the same seat
+     */
+    void testProcessesDoNotOverbook() {
+        const QString name = segmentName("overbook");
+        SharedInventory::remove(name);
+
+        const int CAPACITY = 20;
+        const int PROCESSES = 4;
+        SharedInventory inventory;
+        QVERIFY(inventory.open(name, 1, CAPACITY));
+
+        // Every process tries to claim every seat, one at a time
+        QVector<pid_t> children;
+        for (int p = 0; p < PROCESSES; ++p) {
+            const pid_t pid = fork();
+            QVERIFY(pid >= 0);
+            if (pid == 0) {
+                SharedInventory child;
+                if (!child.open(name, 1, CAPACITY)) {
+                    _exit(255);
+                }
+                int claimed = 0;
+                for (int seat = 0; seat < CAPACITY; ++seat) {
+                    if (child.beginClaim(0, {seat})) {
+                        child.commitClaim(0);
+                        ++claimed;
+                    }
+                }
+                _exit(claimed);
+            }
+            children.append(pid);
+        }
+
+        int totalClaimed = 0;
+        for (pid_t pid : children) {
+            int status = 0;
+            QCOMPARE(waitpid(pid, &status, 0), pid);
+            QVERIFY(WIFEXITED(status));
+            QVERIFY(WEXITSTATUS(status) != 255);
+            totalClaimed += WEXITSTATUS(status);
+        }
+
+        QCOMPARE(totalClaimed, CAPACITY);
+        QCOMPARE(inventory.freeCount(0), 0);
+
+        SharedInventory::remove(name);
+    }
+
+    /**
+     * @brief Test that a claim left by a crashed process is rolled back
+     */
+    void testCrashedClaimIsRecovered() {
+        const QString name = segmentName("crash");
+        SharedInventory::remove(name);
+
+        SharedInventory inventory;
+        QVERIFY(inventory.open(name, 1, 20));
+
+        const pid_t pid = fork();
+        QVERIFY(pid >= 0);
+        if (pid == 0) {
+            SharedInventory child;
+            if (child.open(name, 1, 20) && child.beginClaim(0, {1, 2, 3})) {
+                _exit(0);   // Die holding the lock, claim uncommitted
+            }
+            _exit(1);
+        }
+
+        int status = 0;
+        QCOMPARE(waitpid(pid, &status, 0), pid);
+        QCOMPARE(WEXITSTATUS(status), 0);
+
+        // The half-finished claim is visible until someone takes the lock
+        QVERIFY(inventory.isTaken(0, 2));
+
+        QVERIFY(inventory.beginClaim(0, {2}));
+        inventory.commitClaim(0);
+
+        QCOMPARE(inventory.recoveredClaims(), 1);
+        QVERIFY(!inventory.isTaken(0, 1));
+        QVERIFY(inventory.isTaken(0, 2));
+        QVERIFY(!inventory.isTaken(0, 3));
+        QCOMPARE(inventory.freeCount(0), 19);
+
+        SharedInventory::remove(name);
+    }
+
+    /**
+     * @brief Test that two services attached to one inventory share seats and IDs
+     */
+    void testServicesShareInventory() {
+        const QString name = segmentName("service");
+        SharedInventory::remove(name);
+
+        BookingService first;
+        BookingService second;
+        QString error;
+        QVERIFY2(first.attachSharedInventory(name, &error), qPrintable(error));
+        QVERIFY2(second.attachSharedInventory(name, &error), qPrintable(error));
+
+        const int movieId = first.getMovies()[0]->getId();
+        const int theaterId = first.getTheaters(movieId)[0]->getId();
+        const int seatsBefore = second.getAvailableSeats(theaterId, movieId).size();
+
+        QVERIFY(first.reserveSeats(theaterId, movieId, {"A1", "A2"}, "alice"));
+        QVERIFY(!second.reserveSeats(theaterId, movieId, {"A2"}, "bob"));
+        QVERIFY(second.reserveSeats(theaterId, movieId, {"A3"}, "bob"));
+
+        QCOMPARE(second.getAvailableSeats(theaterId, movieId).size(), seatsBefore - 3);
+        QVERIFY(first.getBookingData("alice")[0].id != second.getBookingData("bob")[0].id);
+
+        // A cancellation frees the seats for every attached service
+        QVERIFY(first.cancelBooking(first.getBookingData("alice")[0].id));
+        QCOMPARE(second.getAvailableSeats(theaterId, movieId).size(), seatsBefore - 1);
+        QVERIFY(second.reserveSeats(theaterId, movieId, {"A2"}, "bob"));
+
+        SharedInventory::remove(name);
+    }
+#endif
+};
+
+QTEST_MAIN(TestSharedInventory)
+#include "test_shared_inventory.moc"
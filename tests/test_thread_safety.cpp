@@ -1,6 +1,10 @@
 #include <QtTest/QtTest>
 #include <QtConcurrent/QtConcurrent>
 #include "core/BookingService.h"
+#include "core/Tracing.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 
 /**
  * @brief Test suite for thread-safety of BookingService
@@ -33,7 +37,7 @@ private slots:
         auto reservationTask = [&service, theaterId, movieId, &successCount, &failCount](int threadId) {
             QStringList seatIds = {"A1"};
             bool result = service->reserveSeats(theaterId, movieId, seatIds,
-                                               QString("Customer%1").arg(threadId));
+                                               QString("Customer%1").arg(threadId)).ok();
             if (result) {
                 successCount.fetchAndAddOrdered(1);
             } else {
@@ -80,7 +84,7 @@ private slots:
         auto reservationTask = [&service, theaterId, movieId, &successCount](int threadId) {
             QStringList seatIds = {QString("A%1").arg(threadId + 1)};
             bool result = service->reserveSeats(theaterId, movieId, seatIds,
-                                               QString("Customer%1").arg(threadId));
+                                               QString("Customer%1").arg(threadId)).ok();
             if (result) {
                 successCount.fetchAndAddOrdered(1);
             }
@@ -128,7 +132,7 @@ private slots:
             }
             
             bool result = service->reserveSeats(theaterId, movieId, seatIds,
-                                               QString("Customer%1").arg(threadId));
+                                               QString("Customer%1").arg(threadId)).ok();
             if (result) {
                 successCount.fetchAndAddOrdered(1);
             }
@@ -149,6 +153,340 @@ private slots:
         auto availableSeats = service->getAvailableSeats(theaterId, movieId);
         QCOMPARE(availableSeats.size(), 20 - (NUM_THREADS * 3));
     }
+
+    /**
+     * @brief Test overlapping group bookings listed in opposite order
+     *
+     * Half the threads list the halls ascending, half descending; with
+     * ordered locking this must neither deadlock nor partially book.
+     */
+    void testConcurrentGroupBookingsNoDeadlock() {
+        auto service = std::make_unique<BookingService>();
+
+        QAtomicInt successCount = 0;
+
+        const int NUM_THREADS = 20;
+
+        // Every thread wants the same seat in all three halls
+        auto groupTask = [&service, &successCount](int threadId) {
+            QStringList seatIds = {QString("A%1").arg(threadId % 4 + 1)};
+            QVector<BookingService::ShowingRequest> requests = {
+                {1, 2, seatIds}, {2, 2, seatIds}, {3, 2, seatIds}
+            };
+            if (threadId % 2) {
+                std::reverse(requests.begin(), requests.end());
+            }
+
+            if (service->reserveGroup(requests, QString("Group%1").arg(threadId))) {
+                successCount.fetchAndAddOrdered(1);
+            }
+        };
+
+        QVector<QFuture<void>> futures;
+        for (int i = 0; i < NUM_THREADS; ++i) {
+            futures.append(QtConcurrent::run(groupTask, i));
+        }
+
+        for (auto& future : futures) {
+            future.waitForFinished();
+        }
+
+        // One winner per distinct seat, and every hall saw exactly the same winners
+        QCOMPARE(successCount.loadAcquire(), 4);
+        for (int theaterId = 1; theaterId <= 3; ++theaterId) {
+            QCOMPARE(service->getAvailableSeats(theaterId, 2).size(), 16);
+        }
+    }
+
+    /**
+     * @brief Test a rush of callers on one showing through the waiting room
+     */
+    void testHotShowingSellsOutWithoutOverbooking() {
+        auto service = std::make_unique<BookingService>();
+        QVERIFY(service->setAdmissionLimit(1, 1, 2));
+
+        QAtomicInt successCount = 0;
+
+        const int NUM_THREADS = 60;
+
+        // Three callers compete for each seat
+        auto reservationTask = [&service, &successCount](int threadId) {
+            QStringList seatIds = {QString("A%1").arg(threadId % 20 + 1)};
+            if (service->reserveSeats(1, 1, seatIds, QString("Fan%1").arg(threadId))) {
+                successCount.fetchAndAddOrdered(1);
+            }
+        };
+
+        QVector<QFuture<void>> futures;
+        for (int i = 0; i < NUM_THREADS; ++i) {
+            futures.append(QtConcurrent::run(reservationTask, i));
+        }
+
+        for (auto& future : futures) {
+            future.waitForFinished();
+        }
+
+        QCOMPARE(successCount.loadAcquire(), 20);
+        QVERIFY(service->getAvailableSeats(1, 1).isEmpty());
+        QCOMPARE(service->getAdmissionPosition(1, 1).status, AdmissionQueue::Status::SoldOut);
+    }
+
+    /**
+     * @brief Test concurrent interning hands out one handle per customer
+     */
+    void testConcurrentCustomerInterning() {
+        CustomerRegistry registry;
+
+        const int NUM_THREADS = 8;
+        const int NUM_CUSTOMERS = 200;
+
+        // Every thread interns the same customers in a different order
+        auto internTask = [&registry](int threadId) {
+            QVector<quint32> handles(NUM_CUSTOMERS);
+            for (int i = 0; i < NUM_CUSTOMERS; ++i) {
+                int customer = (i * 7 + threadId * 13) % NUM_CUSTOMERS;
+                handles[customer] = registry.intern(QString("Customer%1").arg(customer));
+            }
+            return handles;
+        };
+
+        QVector<QFuture<QVector<quint32>>> futures;
+        for (int i = 0; i < NUM_THREADS; ++i) {
+            futures.append(QtConcurrent::run(internTask, i));
+        }
+
+        QVector<quint32> expected = futures[0].result();
+        for (auto& future : futures) {
+            QCOMPARE(future.result(), expected);
+        }
+
+        QCOMPARE(registry.size(), NUM_CUSTOMERS);
+        for (int i = 0; i < NUM_CUSTOMERS; ++i) {
+            QVERIFY(expected[i] < quint32(NUM_CUSTOMERS));
+            QCOMPARE(registry.name(expected[i]), QString("Customer%1").arg(i));
+        }
+    }
+
+    /**
+     * @brief Test that concurrent retries of one keyed request book exactly once
+     */
+    void testConcurrentRetriesBookOnce() {
+        auto service = std::make_unique<BookingService>();
+
+        const int NUM_THREADS = 16;
+
+        // Every thread sends the same request with the same key
+        auto retryTask = [&service](int) {
+            int bookingId = 0;
+            bool ok = service->reserveSeats(2, 3, {"A5", "A6"}, "Retrier", "retry-key",
+                                            &bookingId).ok();
+            return ok ? bookingId : -1;
+        };
+
+        QVector<QFuture<int>> futures;
+        for (int i = 0; i < NUM_THREADS; ++i) {
+            futures.append(QtConcurrent::run(retryTask, i));
+        }
+
+        const int bookingId = futures[0].result();
+        QVERIFY(bookingId > 0);
+        for (auto& future : futures) {
+            QCOMPARE(future.result(), bookingId);
+        }
+
+        QCOMPARE(service->getBookingData("Retrier").size(), 1);
+    }
+
+    /**
+     * @brief Test that concurrent requests never exceed a customer's seat quota
+     */
+    void testConcurrentRequestsRespectSeatQuota() {
+        auto service = std::make_unique<BookingService>();
+        service->setRateLimits({0, 0, 0, 0, 4});
+
+        const int NUM_THREADS = 20;
+
+        // One scalper asks for every seat at once; only 4 may be granted
+        auto scalpTask = [&service](int seat) {
+            return service->reserveSeats(1, 2, {QString("A%1").arg(seat + 1)}, "Scalper").ok();
+        };
+
+        QVector<QFuture<bool>> futures;
+        for (int i = 0; i < NUM_THREADS; ++i) {
+            futures.append(QtConcurrent::run(scalpTask, i));
+        }
+
+        int granted = 0;
+        for (auto& future : futures) {
+            granted += future.result() ? 1 : 0;
+        }
+
+        QCOMPARE(granted, 4);
+        QCOMPARE(service->getAvailableSeats(1, 2).size(), 16);
+    }
+
+    /**
+     * @brief Test that spans from many threads export as Chrome trace events
+     */
+    void testTraceSpansExportPerThread() {
+        auto service = std::make_unique<BookingService>();
+
+        const int NUM_THREADS = 4;
+        const int SPANS_PER_THREAD = 100;
+
+        auto traceTask = [&service](int thread) {
+            for (int i = 0; i < SPANS_PER_THREAD; ++i) {
+                TraceSpan span("testOuterSpan");
+                TraceSpan inner("testInnerSpan");
+            }
+            service->reserveSeats(3, 4, {QString("A%1").arg(thread + 1)}, "Tracer");
+        };
+
+        QVector<QFuture<void>> futures;
+        for (int i = 0; i < NUM_THREADS; ++i) {
+            futures.append(QtConcurrent::run(traceTask, i));
+        }
+        for (auto& future : futures) {
+            future.waitForFinished();
+        }
+
+        const QJsonDocument trace = QJsonDocument::fromJson(TraceRecorder::exportChromeTrace());
+        QVERIFY(trace.isObject());
+
+        QHash<QString, int> counts;
+        QSet<int> threadNames;
+        for (const QJsonValue& value : trace.object().value("traceEvents").toArray()) {
+            const QJsonObject event = value.toObject();
+            if (event.value("ph").toString() == "M") {
+                threadNames.insert(event.value("tid").toInt());
+                continue;
+            }
+            QCOMPARE(event.value("ph").toString(), QString("X"));
+            QVERIFY(event.value("dur").toDouble() >= 0);
+            QVERIFY(threadNames.contains(event.value("tid").toInt()));
+            ++counts[event.value("name").toString()];
+        }
+
+        QCOMPARE(counts.value("testOuterSpan"), NUM_THREADS * SPANS_PER_THREAD);
+        QCOMPARE(counts.value("testInnerSpan"), NUM_THREADS * SPANS_PER_THREAD);
+        if (TraceRecorder::isCompiledIn()) {
+            QVERIFY(counts.value("reserveSeats") >= NUM_THREADS);
+            QVERIFY(counts.value("showingLockWait") >= NUM_THREADS);
+            QVERIFY(counts.value("bookingData") >= NUM_THREADS);
+        } else {
+            QCOMPARE(counts.value("reserveSeats"), 0);
+        }
+
+        // A full ring keeps only the newest spans
+        for (int i = 0; i < TraceRecorder::EVENTS_PER_THREAD + 100; ++i) {
+            TraceRecorder::record("testOverflowSpan", i, i + 1);
+        }
+        const QByteArray overflowed = TraceRecorder::exportChromeTrace();
+        QCOMPARE(int(overflowed.count("\"testOverflowSpan\"")), int(TraceRecorder::EVENTS_PER_THREAD));
+
+        // Thread names are user text: quotes and control characters stay valid JSON
+        const QString oddName = QString("worker \"7\"\\\n\x01");
+        QThread* named = QThread::create([] { TraceRecorder::record("testNamedSpan", 0, 1); });
+        named->setObjectName(oddName);
+        named->start();
+        QVERIFY(named->wait(5000));
+        delete named;
+
+        QJsonParseError parseError;
+        const QJsonDocument escaped = QJsonDocument::fromJson(TraceRecorder::exportChromeTrace(),
+                                                              &parseError);
+        QCOMPARE(parseError.error, QJsonParseError::NoError);
+        bool found = false;
+        for (const QJsonValue& value : escaped.object().value("traceEvents").toArray()) {
+            const QJsonObject event = value.toObject();
+            if (event.value("ph").toString() == "M"
+                && event.value("args").toObject().value("name").toString() == oddName) {
+                found = true;
+            }
+        }
+        QVERIFY(found);
+    }
+
+    /**
+     * @brief Test catalog reloads every second under full booking load
+     */
+    void testHotReloadUnderBookingLoad() {
+        auto service = std::make_unique<BookingService>();
+
+        const int HALL_SIZE = 30000;
+        const int NUM_THREADS = 8;
+        const int NUM_RELOADS = 3;
+
+        // Hall 1 keeps its size; hall 2 grows on every reload, and hall 1
+        // alternates between showing movie 2 and movie 3
+        auto makeCatalog = [&](int reload) {
+            CatalogData catalog;
+            catalog.movies = {{1, "Steady", 100, "Drama"}, {2, "Even", 100, "Drama"},
+                              {3, "Odd", 100, "Drama"}};
+            catalog.theaters = {{1, "Hall 1", HALL_SIZE},
+                                {2, "Hall 2", HALL_SIZE + reload * 1000}};
+            catalog.showings = {{1, 1}, {1, reload % 2 ? 3 : 2}, {2, 1}};
+            return catalog;
+        };
+
+        QString error;
+        QVERIFY2(service->loadCatalog(makeCatalog(0), &error), qPrintable(error));
+        const quint64 firstVersion = service->getCatalogStatus().version;
+
+        // Seat sales per hall showing movie 1, which survives every reload
+        QVector<QAtomicInt> sold[2] = {QVector<QAtomicInt>(HALL_SIZE),
+                                       QVector<QAtomicInt>(HALL_SIZE)};
+        QAtomicInt stop = 0;
+
+        auto bookingTask = [&](int threadId) {
+            QRandomGenerator random(threadId + 1);
+            while (!stop.loadAcquire()) {
+                const int seat = random.bounded(HALL_SIZE);
+                const int hall = random.bounded(3);
+                if (hall == 2) {
+                    // Showing that comes and goes; any outcome is fine
+                    service->reserveSeats(1, 2 + seat % 2, {QString("A%1").arg(seat + 1)},
+                                          "Drifter");
+                } else if (service->reserveSeats(hall + 1, 1, {QString("A%1").arg(seat + 1)},
+                                                 QString("Fan%1").arg(threadId))) {
+                    sold[hall][seat].fetchAndAddOrdered(1);
+                }
+            }
+        };
+
+        QVector<QFuture<void>> futures;
+        for (int i = 0; i < NUM_THREADS; ++i) {
+            futures.append(QtConcurrent::run(bookingTask, i));
+        }
+
+        for (int reload = 1; reload <= NUM_RELOADS; ++reload) {
+            QThread::msleep(1000);
+            QVERIFY2(service->loadCatalog(makeCatalog(reload), &error), qPrintable(error));
+        }
+
+        stop.storeRelease(1);
+        for (auto& future : futures) {
+            future.waitForFinished();
+        }
+
+        // No seat was sold twice, and every sale survived the reloads
+        for (int hall = 0; hall < 2; ++hall) {
+            int soldCount = 0;
+            for (const QAtomicInt& count : sold[hall]) {
+                QVERIFY(count.loadAcquire() <= 1);
+                soldCount += count.loadAcquire();
+            }
+            QVERIFY(soldCount > 0);
+
+            const int capacity = HALL_SIZE + (hall == 1 ? NUM_RELOADS * 1000 : 0);
+            QCOMPARE(service->getAvailableSeats(hall + 1, 1).size(), capacity - soldCount);
+        }
+
+        const BookingService::CatalogStatus status = service->getCatalogStatus();
+        QCOMPARE(status.version, firstVersion + NUM_RELOADS);
+        QCOMPARE(status.liveVersions, 1);
+        QCOMPARE(status.showingCount, 3);
+    }
 };
 
 QTEST_MAIN(TestThreadSafety)